@@ -0,0 +1,136 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DFU_STATUS_CLIENT_H__
+#define DFU_STATUS_CLIENT_H__
+
+#include <stdint.h>
+#include "access.h"
+#include "dfu_status_common.h"
+
+/**
+ * @defgroup DFU_STATUS_CLIENT DFU Status Client
+ * @ingroup DFU_STATUS_MODEL
+ * This module implements a vendor specific DFU Status Client.
+ * @{
+ */
+
+/** Forward declaration. */
+typedef struct __dfu_status_client dfu_status_client_t;
+
+/**
+ * Status callback type.
+ *
+ * @param[in] p_self   Pointer to the DFU Status Client context structure.
+ * @param[in] src      Unicast address of the server that sent the status.
+ * @param[in] p_status Received status. Only the first @c missing_count missing ranges are valid.
+ */
+typedef void (*dfu_status_cb_t)(const dfu_status_client_t * p_self, uint16_t src, const dfu_status_msg_status_t * p_status);
+
+/**
+ * Policy status callback type.
+ *
+ * @param[in] p_self   Pointer to the DFU Status Client context structure.
+ * @param[in] src      Unicast address of the server that sent the status.
+ * @param[in] p_status Received policy status.
+ */
+typedef void (*dfu_status_policy_status_cb_t)(const dfu_status_client_t * p_self,
+                                              uint16_t src,
+                                              const dfu_status_msg_policy_status_t * p_status);
+
+/** DFU Status Client state structure. */
+struct __dfu_status_client
+{
+    /** Model handle assigned to the client. */
+    access_model_handle_t model_handle;
+    /** Status callback, required. Called for published statuses and for replies to a Get. */
+    dfu_status_cb_t status_cb;
+    /** Policy status callback, optional. Called for replies to a Policy Set. */
+    dfu_status_policy_status_cb_t policy_status_cb;
+};
+
+/**
+ * Initializes the DFU Status client.
+ *
+ * @note This function should only be called _once_.
+ * @note The client handles the model allocation and adding.
+ *
+ * @param[in] p_client      DFU Status Client structure pointer.
+ * @param[in] element_index Element index to add the client model.
+ *
+ * @retval NRF_SUCCESS         Successfully added client.
+ * @retval NRF_ERROR_NULL      NULL pointer supplied to function, or no status callback set.
+ * @retval NRF_ERROR_NO_MEM    No more memory available to allocate model.
+ * @retval NRF_ERROR_FORBIDDEN Multiple model instances per element is not allowed.
+ * @retval NRF_ERROR_NOT_FOUND Invalid element index.
+ */
+uint32_t dfu_status_client_init(dfu_status_client_t * p_client, uint16_t element_index);
+
+/**
+ * Publishes a DFU Status Get to the client's publish address. Every server at the address replies.
+ *
+ * @param[in] p_client DFU Status Client structure pointer.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t dfu_status_client_get(dfu_status_client_t * p_client);
+
+/**
+ * Publishes a DFU Policy Set to the client's publish address. Only servers addressed by their
+ * unicast address reply.
+ *
+ * @param[in] p_client DFU Status Client structure pointer.
+ * @param[in] p_policy Policy to set. Only the first @c blocked_count blocked versions are sent.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_INVALID_LENGTH More than @ref DFU_STATUS_POLICY_BLOCKED_MAX blocked versions.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t dfu_status_client_policy_set(dfu_status_client_t * p_client, const dfu_status_msg_policy_set_t * p_policy);
+
+/** @} end of DFU_STATUS_CLIENT */
+
+#endif /* DFU_STATUS_CLIENT_H__ */
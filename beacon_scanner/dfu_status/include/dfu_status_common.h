@@ -0,0 +1,190 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DFU_STATUS_COMMON_H__
+#define DFU_STATUS_COMMON_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "access.h"
+
+/**
+ * @defgroup DFU_STATUS_MODEL DFU Status model
+ * This model reports the progress of a mesh DFU transfer on a node, so a gateway can follow the
+ * transfer across the fleet.
+ *
+ * The server publishes its status when a transfer starts or ends, and periodically while it runs.
+ * The client collects the statuses published to its subscription address, and can request them
+ * with a Get.
+ *
+ * The client also pushes the DFU policy, which decides the transfers a node accepts: the share of
+ * the fleet taking part in a staged rollout, the window of accepted versions, and the versions
+ * that must never be installed. A Policy Set sent to a unicast address is answered with a Policy
+ * Status. A Policy Set sent to a group address is not answered, to not flood the gateway, and the
+ * policy in use is reported in every DFU Status instead.
+ *
+ * Model Identification
+ * @par
+ * Company ID: @ref DFU_STATUS_COMPANY_ID
+ * @par
+ * DFU Status Client Model ID: @ref DFU_STATUS_CLIENT_MODEL_ID
+ * @par
+ * DFU Status Server Model ID: @ref DFU_STATUS_SERVER_MODEL_ID
+ *
+ * List of supported messages:
+ * @par
+ * @copydoc DFU_STATUS_OPCODE_GET
+ * @par
+ * @copydoc DFU_STATUS_OPCODE_STATUS
+ * @par
+ * @copydoc DFU_STATUS_OPCODE_POLICY_SET
+ * @par
+ * @copydoc DFU_STATUS_OPCODE_POLICY_STATUS
+ *
+ * @ingroup MESH_API_GROUP_VENDOR_MODELS
+ * @{
+ * @defgroup DFU_STATUS_COMMON Common DFU Status definitions
+ * Types and definitions shared between the two DFU Status models.
+ * @{
+ */
+/*lint -align_max(push) -align_max(1) */
+
+/** Vendor specific company ID for the DFU Status model. */
+#define DFU_STATUS_COMPANY_ID       (ACCESS_COMPANY_ID_NORDIC)
+
+/** DFU Status Server model ID. */
+#define DFU_STATUS_SERVER_MODEL_ID  (0x0010)
+
+/** DFU Status Client model ID. */
+#define DFU_STATUS_CLIENT_MODEL_ID  (0x0011)
+
+/** Highest number of missing segment ranges in a DFU Status message. */
+#define DFU_STATUS_MISSING_RANGES_MAX   (8)
+
+/** Highest number of blocked versions in a DFU Policy Set message. */
+#define DFU_STATUS_POLICY_BLOCKED_MAX   (4)
+
+/** Policy flag: accept SoftDevice transfers. */
+#define DFU_STATUS_POLICY_FLAG_SOFTDEVICE   (0x01)
+/** Policy flag: accept application versions older than the running one, for a rollback. */
+#define DFU_STATUS_POLICY_FLAG_DOWNGRADE    (0x02)
+
+/** DFU Status opcodes, after the Simple Beacon opcodes of the same company. */
+typedef enum
+{
+    DFU_STATUS_OPCODE_GET = 0xD2,          /**< DFU Status Get. */
+    DFU_STATUS_OPCODE_STATUS = 0xD3,       /**< DFU Status. */
+    DFU_STATUS_OPCODE_POLICY_SET = 0xD4,   /**< DFU Policy Set. */
+    DFU_STATUS_OPCODE_POLICY_STATUS = 0xD5 /**< DFU Policy Status. */
+} dfu_status_opcode_t;
+
+/** Transfer states in a DFU Status message. */
+typedef enum
+{
+    DFU_STATUS_STATE_IDLE,     /**< No transfer since boot. */
+    DFU_STATUS_STATE_TARGET,   /**< Receiving an image for the node. */
+    DFU_STATUS_STATE_RELAY,    /**< Relaying an image for other nodes. */
+    DFU_STATUS_STATE_BANKED,   /**< The image is complete in the bank, waiting to be flashed. */
+    DFU_STATUS_STATE_COMPLETE, /**< The transfer ended successfully. */
+    DFU_STATUS_STATE_FAILED    /**< The transfer ended with an error. */
+} dfu_status_state_t;
+
+/** Range of missing segments. */
+typedef struct __attribute((packed))
+{
+    uint16_t first; /**< First missing segment. */
+    uint16_t count; /**< Number of missing segments. */
+} dfu_status_range_t;
+
+/**
+ * Message format for the DFU Status message. Only the first @c missing_count ranges are sent.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t  state;          /**< Transfer state, @ref dfu_status_state_t. */
+    uint8_t  dfu_type;       /**< DFU type of the transfer, as in the mesh DFU API. */
+    uint8_t  end_reason;     /**< End reason of the last transfer, as in the mesh DFU API. */
+    uint32_t fw_version;     /**< Version of the transferred firmware. */
+    uint16_t segment_count;  /**< Number of segments in the image, 0 if not known yet. */
+    uint16_t received_count; /**< Number of segments received. */
+    uint16_t relay_count;    /**< Number of transfers relayed since boot. */
+    uint16_t policy_id;      /**< Identifier of the DFU policy in use. */
+    uint8_t  in_cohort;      /**< 1 if the node is in the rollout cohort of the policy. */
+    uint8_t  missing_count;  /**< Number of missing ranges that follow. */
+    dfu_status_range_t missing[DFU_STATUS_MISSING_RANGES_MAX]; /**< Missing ranges, lowest first. */
+} dfu_status_msg_status_t;
+
+/** Length of a DFU Status message without the missing ranges. */
+#define DFU_STATUS_MSG_STATUS_LENGTH_MIN    (offsetof(dfu_status_msg_status_t, missing))
+
+/**
+ * Message format for the DFU Policy Set message. Only the first @c blocked_count versions are sent.
+ *
+ * A node takes part in the rollout if its cohort, a hash of its device UUID and the salt in the
+ * range [0, 100), is below the rollout percentage. With the same salt, the cohort of a wave
+ * includes the cohorts of all the smaller waves before it.
+ *
+ * The version window and the blocked versions apply to application transfers.
+ */
+typedef struct __attribute((packed))
+{
+    uint16_t policy_id;       /**< Identifier of the policy, reported back by the nodes. */
+    uint8_t  flags;           /**< Policy flags, @c DFU_STATUS_POLICY_FLAG_*. */
+    uint8_t  rollout_percent; /**< Share of the fleet accepting transfers, 0 to 100. */
+    uint16_t cohort_salt;     /**< Salt of the cohort hash, kept for all the waves of a rollout. */
+    uint32_t version_min;     /**< Lowest application version accepted. */
+    uint32_t version_max;     /**< Highest application version accepted. */
+    uint8_t  blocked_count;   /**< Number of blocked versions that follow. */
+    uint32_t blocked[DFU_STATUS_POLICY_BLOCKED_MAX]; /**< Application versions never accepted. */
+} dfu_status_msg_policy_set_t;
+
+/** Length of a DFU Policy Set message without the blocked versions. */
+#define DFU_STATUS_MSG_POLICY_SET_LENGTH_MIN    (offsetof(dfu_status_msg_policy_set_t, blocked))
+
+/** Message format for the DFU Policy Status message. */
+typedef struct __attribute((packed))
+{
+    uint16_t policy_id; /**< Identifier of the policy in use. */
+    uint8_t  in_cohort; /**< 1 if the node is in the rollout cohort of the policy. */
+    uint8_t  cohort;    /**< Cohort of the node, 0 to 99. */
+} dfu_status_msg_policy_status_t;
+
+/*lint -align_max(pop) */
+
+/** @} end of DFU_STATUS_COMMON */
+/** @} end of DFU_STATUS_MODEL */
+#endif /* DFU_STATUS_COMMON_H__ */
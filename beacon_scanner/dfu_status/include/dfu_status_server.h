@@ -0,0 +1,120 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DFU_STATUS_SERVER_H__
+#define DFU_STATUS_SERVER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "access.h"
+#include "dfu_status_common.h"
+
+/**
+ * @defgroup DFU_STATUS_SERVER DFU Status Server
+ * @ingroup DFU_STATUS_MODEL
+ * This module implements a vendor specific DFU Status Server.
+ * @{
+ */
+
+/** Forward declaration. */
+typedef struct __dfu_status_server dfu_status_server_t;
+
+/**
+ * Status get callback type.
+ *
+ * @param[in]  p_self   Pointer to the DFU Status Server context structure.
+ * @param[out] p_status Status to fill in. At most @ref DFU_STATUS_MISSING_RANGES_MAX missing
+ *                      ranges, with their number in @c missing_count.
+ */
+typedef void (*dfu_status_get_cb_t)(const dfu_status_server_t * p_self, dfu_status_msg_status_t * p_status);
+
+/**
+ * Policy set callback type.
+ *
+ * @param[in]  p_self   Pointer to the DFU Status Server context structure.
+ * @param[in]  p_policy Received policy. Only the first @c blocked_count blocked versions are valid.
+ * @param[out] p_status Policy Status to reply with, when the Set was sent to the node's unicast address.
+ */
+typedef void (*dfu_status_policy_set_cb_t)(const dfu_status_server_t * p_self,
+                                           const dfu_status_msg_policy_set_t * p_policy,
+                                           dfu_status_msg_policy_status_t * p_status);
+
+/** DFU Status Server state structure. */
+struct __dfu_status_server
+{
+    /** Model handle assigned to the server. */
+    access_model_handle_t model_handle;
+    /** Status get callback, required. */
+    dfu_status_get_cb_t get_cb;
+    /** Policy set callback, optional. Policy Set messages are ignored if NULL. */
+    dfu_status_policy_set_cb_t policy_set_cb;
+};
+
+/**
+ * Initializes the DFU Status server.
+ *
+ * @note This function should only be called _once_.
+ * @note The server handles the model allocation and adding.
+ *
+ * @param[in] p_server      DFU Status Server structure pointer.
+ * @param[in] element_index Element index to add the server model.
+ *
+ * @retval NRF_SUCCESS         Successfully added server.
+ * @retval NRF_ERROR_NULL      NULL pointer supplied to function, or no get callback set.
+ * @retval NRF_ERROR_NO_MEM    No more memory available to allocate model.
+ * @retval NRF_ERROR_FORBIDDEN Multiple model instances per element is not allowed.
+ * @retval NRF_ERROR_NOT_FOUND Invalid element index.
+ */
+uint32_t dfu_status_server_init(dfu_status_server_t * p_server, uint16_t element_index);
+
+/**
+ * Publishes the current status.
+ *
+ * @param[in] p_server DFU Status Server structure pointer.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t dfu_status_server_publish(dfu_status_server_t * p_server);
+
+/** @} end of DFU_STATUS_SERVER */
+
+#endif /* DFU_STATUS_SERVER_H__ */
@@ -0,0 +1,149 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dfu_status_client.h"
+#include "dfu_status_common.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "access.h"
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static void handle_status_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    dfu_status_client_t * p_client = p_args;
+    if (p_message->length < DFU_STATUS_MSG_STATUS_LENGTH_MIN || p_message->length > sizeof(dfu_status_msg_status_t))
+    {
+        return;
+    }
+
+    /* Copied out of the packet buffer, which is not aligned. */
+    dfu_status_msg_status_t status;
+    memcpy(&status, p_message->p_data, p_message->length);
+    uint32_t missing_max = (p_message->length - DFU_STATUS_MSG_STATUS_LENGTH_MIN) / sizeof(status.missing[0]);
+    if (status.missing_count > missing_max)
+    {
+        status.missing_count = (uint8_t) missing_max;
+    }
+    p_client->status_cb(p_client, p_message->meta_data.src.value, &status);
+}
+
+static void handle_policy_status_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    dfu_status_client_t * p_client = p_args;
+    if (p_client->policy_status_cb == NULL || p_message->length != sizeof(dfu_status_msg_policy_status_t))
+    {
+        return;
+    }
+
+    dfu_status_msg_policy_status_t status;
+    memcpy(&status, p_message->p_data, sizeof(status));
+    p_client->policy_status_cb(p_client, p_message->meta_data.src.value, &status);
+}
+
+static const access_opcode_handler_t m_opcode_handlers[] =
+{
+    {ACCESS_OPCODE_VENDOR(DFU_STATUS_OPCODE_STATUS, DFU_STATUS_COMPANY_ID), handle_status_cb},
+    {ACCESS_OPCODE_VENDOR(DFU_STATUS_OPCODE_POLICY_STATUS, DFU_STATUS_COMPANY_ID), handle_policy_status_cb}
+};
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+uint32_t dfu_status_client_init(dfu_status_client_t * p_client, uint16_t element_index)
+{
+    if (p_client == NULL || p_client->status_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    access_model_add_params_t init_params;
+    init_params.element_index = element_index;
+    init_params.model_id.model_id = DFU_STATUS_CLIENT_MODEL_ID;
+    init_params.model_id.company_id = DFU_STATUS_COMPANY_ID;
+    init_params.p_opcode_handlers = &m_opcode_handlers[0];
+    init_params.opcode_count = sizeof(m_opcode_handlers) / sizeof(m_opcode_handlers[0]);
+    init_params.p_args = p_client;
+    init_params.publish_timeout_cb = NULL;
+    return access_model_add(&init_params, &p_client->model_handle);
+}
+
+uint32_t dfu_status_client_get(dfu_status_client_t * p_client)
+{
+    if (p_client == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    access_message_tx_t msg;
+    msg.opcode.opcode = DFU_STATUS_OPCODE_GET;
+    msg.opcode.company_id = DFU_STATUS_COMPANY_ID;
+    msg.p_buffer = NULL;
+    msg.length = 0;
+    msg.force_segmented = false;
+    msg.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    msg.access_token = nrf_mesh_unique_token_get();
+    return access_model_publish(p_client->model_handle, &msg);
+}
+
+uint32_t dfu_status_client_policy_set(dfu_status_client_t * p_client, const dfu_status_msg_policy_set_t * p_policy)
+{
+    if (p_client == NULL || p_policy == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (p_policy->blocked_count > DFU_STATUS_POLICY_BLOCKED_MAX)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    access_message_tx_t msg;
+    msg.opcode.opcode = DFU_STATUS_OPCODE_POLICY_SET;
+    msg.opcode.company_id = DFU_STATUS_COMPANY_ID;
+    msg.p_buffer = (const uint8_t *) p_policy;
+    msg.length = (uint16_t) (DFU_STATUS_MSG_POLICY_SET_LENGTH_MIN + p_policy->blocked_count * sizeof(p_policy->blocked[0]));
+    msg.force_segmented = false;
+    msg.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    msg.access_token = nrf_mesh_unique_token_get();
+    return access_model_publish(p_client->model_handle, &msg);
+}
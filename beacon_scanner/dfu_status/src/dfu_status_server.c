@@ -0,0 +1,158 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dfu_status_server.h"
+#include "dfu_status_common.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "access.h"
+#include "nrf_mesh.h"
+#include "nrf_mesh_assert.h"
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+/* Fills in a status message, and returns its length. */
+static uint16_t status_msg_fill(const dfu_status_server_t * p_server, dfu_status_msg_status_t * p_status)
+{
+    p_status->missing_count = 0;
+    p_server->get_cb(p_server, p_status);
+    NRF_MESH_ASSERT(p_status->missing_count <= DFU_STATUS_MISSING_RANGES_MAX);
+    return (uint16_t) (DFU_STATUS_MSG_STATUS_LENGTH_MIN + p_status->missing_count * sizeof(p_status->missing[0]));
+}
+
+static void status_msg_init(access_message_tx_t * p_msg, const dfu_status_msg_status_t * p_status, uint16_t length)
+{
+    p_msg->opcode.opcode = DFU_STATUS_OPCODE_STATUS;
+    p_msg->opcode.company_id = DFU_STATUS_COMPANY_ID;
+    p_msg->p_buffer = (const uint8_t *) p_status;
+    p_msg->length = length;
+    p_msg->force_segmented = false;
+    p_msg->transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    p_msg->access_token = nrf_mesh_unique_token_get();
+}
+
+static void handle_get_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    dfu_status_server_t * p_server = p_args;
+    dfu_status_msg_status_t status;
+    access_message_tx_t reply;
+    status_msg_init(&reply, &status, status_msg_fill(p_server, &status));
+    (void) access_model_reply(p_server->model_handle, p_message, &reply);
+}
+
+static void handle_policy_set_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    dfu_status_server_t * p_server = p_args;
+    if (p_server->policy_set_cb == NULL ||
+        p_message->length < DFU_STATUS_MSG_POLICY_SET_LENGTH_MIN ||
+        p_message->length > sizeof(dfu_status_msg_policy_set_t))
+    {
+        return;
+    }
+
+    /* Copied out of the packet buffer, which is not aligned. */
+    dfu_status_msg_policy_set_t policy;
+    memcpy(&policy, p_message->p_data, p_message->length);
+    uint32_t blocked_max = (p_message->length - DFU_STATUS_MSG_POLICY_SET_LENGTH_MIN) / sizeof(policy.blocked[0]);
+    if (policy.blocked_count > blocked_max)
+    {
+        policy.blocked_count = (uint8_t) blocked_max;
+    }
+
+    dfu_status_msg_policy_status_t status;
+    p_server->policy_set_cb(p_server, &policy, &status);
+
+    /* A Set to a group is not answered, the nodes report the policy in their DFU Status. */
+    if (nrf_mesh_address_type_get(p_message->meta_data.dst.value) == NRF_MESH_ADDRESS_TYPE_UNICAST)
+    {
+        access_message_tx_t reply;
+        reply.opcode.opcode = DFU_STATUS_OPCODE_POLICY_STATUS;
+        reply.opcode.company_id = DFU_STATUS_COMPANY_ID;
+        reply.p_buffer = (const uint8_t *) &status;
+        reply.length = sizeof(status);
+        reply.force_segmented = false;
+        reply.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+        reply.access_token = nrf_mesh_unique_token_get();
+        (void) access_model_reply(p_server->model_handle, p_message, &reply);
+    }
+}
+
+static const access_opcode_handler_t m_opcode_handlers[] =
+{
+    {ACCESS_OPCODE_VENDOR(DFU_STATUS_OPCODE_GET, DFU_STATUS_COMPANY_ID), handle_get_cb},
+    {ACCESS_OPCODE_VENDOR(DFU_STATUS_OPCODE_POLICY_SET, DFU_STATUS_COMPANY_ID), handle_policy_set_cb}
+};
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+uint32_t dfu_status_server_init(dfu_status_server_t * p_server, uint16_t element_index)
+{
+    if (p_server == NULL || p_server->get_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    access_model_add_params_t init_params;
+    init_params.element_index = element_index;
+    init_params.model_id.model_id = DFU_STATUS_SERVER_MODEL_ID;
+    init_params.model_id.company_id = DFU_STATUS_COMPANY_ID;
+    init_params.p_opcode_handlers = &m_opcode_handlers[0];
+    init_params.opcode_count = sizeof(m_opcode_handlers) / sizeof(m_opcode_handlers[0]);
+    init_params.p_args = p_server;
+    init_params.publish_timeout_cb = NULL;
+    return access_model_add(&init_params, &p_server->model_handle);
+}
+
+uint32_t dfu_status_server_publish(dfu_status_server_t * p_server)
+{
+    if (p_server == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    dfu_status_msg_status_t status;
+    access_message_tx_t msg;
+    status_msg_init(&msg, &status, status_msg_fill(p_server, &status));
+    return access_model_publish(p_server->model_handle, &msg);
+}
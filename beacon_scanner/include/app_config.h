@@ -54,6 +54,107 @@
 /** Controls the MIC size used by the model instance for sending the mesh messages. */
 #define APP_CONFIG_MIC_SIZE            (NRF_MESH_TRANSMIC_SIZE_SMALL)
 
+/** Default interval between two report batches, in milliseconds. */
+#define APP_CONFIG_REPORT_INTERVAL_MS  (1000)
+
+/** Maximum number of sighting entries drained from the sighting table for one report batch. */
+#define APP_CONFIG_REPORT_BATCH_ENTRIES_MAX (64)
+
+/** Default RSSI floor for eartag sightings, in dBm. */
+#define APP_CONFIG_RSSI_FLOOR          (-100)
+
+/** Default scan interval of the eartag capture slot, in milliseconds. */
+#define APP_CONFIG_SCAN_INTERVAL_MS    (2000)
+
+/** Default scan window of the eartag capture slot, in milliseconds. */
+#define APP_CONFIG_SCAN_WINDOW_MS      (2000)
+
+/** Scan interval of the mesh slot, in milliseconds. */
+#define APP_CONFIG_SCAN_MESH_INTERVAL_MS (100)
+
+/** Scan window of the mesh slot, in milliseconds. The whole interval, the mesh slot never stops
+ * listening. */
+#define APP_CONFIG_SCAN_MESH_WINDOW_MS (100)
+
+/** Shortest scan interval and window accepted from the gateway, in milliseconds. */
+#define APP_CONFIG_SCAN_TIME_MIN_MS    (3)
+
+/** Longest scan interval and window accepted from the gateway, in milliseconds. */
+#define APP_CONFIG_SCAN_TIME_MAX_MS    (10240)
+
+/** Length of one mesh slot plus one eartag capture slot, in milliseconds. */
+#define APP_CONFIG_SCAN_SLOT_PERIOD_MS (500)
+
+/** Default share of the scan time given to the mesh slot, in percent. */
+#define APP_CONFIG_SCAN_MESH_SHARE     (20)
+
+/** Share of the scan time given to the mesh slot while a DFU transfer is active, in percent. */
+#define APP_CONFIG_SCAN_DFU_MESH_SHARE (90)
+
+/** Filtered RSSI an eartag needs to be reported present, in dBm. */
+#define APP_CONFIG_PRESENCE_ENTER_RSSI (-85)
+
+/** Filtered RSSI a present eartag needs to stay present, in dBm. */
+#define APP_CONFIG_PRESENCE_LEAVE_RSSI (-92)
+
+/** Time an eartag must be heard before it is reported present, in milliseconds. */
+#define APP_CONFIG_PRESENCE_ENTER_MS   (3000)
+
+/** Silent time before a present eartag starts leaving, and again before it is reported absent, in milliseconds. */
+#define APP_CONFIG_PRESENCE_LEAVE_MS   (15000)
+
+/** Interval between two presence digests, in milliseconds. */
+#define APP_CONFIG_PRESENCE_DIGEST_INTERVAL_MS (60000)
+
+/** Number of presence events queued between two reports. */
+#define APP_CONFIG_PRESENCE_EVENTS_MAX (32)
+
+/** Number of flash pages reserved for the report backlog, between the application and the DFU bank. */
+#define APP_CONFIG_BACKLOG_PAGE_COUNT  (4)
+
+/** Number of failed report publishes in a row before reports spill to the backlog. */
+#define APP_CONFIG_BACKLOG_SPILL_FAILURES (3)
+
+/** Shortest time between two backlog records sent to the gateway, in milliseconds. */
+#define APP_CONFIG_BACKLOG_DRAIN_INTERVAL_MS (500)
+
+/** Time the backlog is not pushed after a Reports Get message, while the gateway pulls it, in milliseconds. */
+#define APP_CONFIG_BACKLOG_PULL_HOLDOFF_MS (30000)
+
+/** First retry delay when the mesh TX queue is full, in milliseconds. */
+#define APP_CONFIG_REPORT_BACKOFF_MIN_MS (50)
+
+/** Longest retry delay when the mesh TX queue is full, in milliseconds. */
+#define APP_CONFIG_REPORT_BACKOFF_MAX_MS (2000)
+
+/** Time before an unacknowledged report message is retransmitted, doubled for every retry, in milliseconds. */
+#define APP_CONFIG_REPORT_ACK_TIMEOUT_MS (2000)
+
+/** Set to 0 for gateways that do not send Report Ack messages. The report messages are then sent
+ * once, without a send window. */
+#define APP_CONFIG_REPORT_SACK_ENABLED   (1)
+
+/** Interval between two DFU status publications while a DFU transfer runs, in milliseconds. */
+#define APP_CONFIG_DFU_STATUS_INTERVAL_MS (10000)
+
+/** Shortest time a node listens to its neighbourhood before deciding to relay a DFU transfer, in milliseconds. */
+#define APP_CONFIG_DFU_RELAY_LISTEN_MS (2000)
+
+/** Time a node that suppressed its relay ignores new offers of a DFU transfer, in milliseconds. */
+#define APP_CONFIG_DFU_RELAY_HOLDOFF_MS (60000)
+
+/** Time a mesh neighbour counts for the density after it was last heard, in milliseconds. */
+#define APP_CONFIG_DFU_RELAY_NEIGHBOUR_TIMEOUT_MS (60000)
+
+/** Number of DFU relays wanted around a node. */
+#define APP_CONFIG_DFU_RELAY_TARGET_COUNT (3)
+
+/** Lowest RSSI of a mesh neighbour counted for the density, in dBm. */
+#define APP_CONFIG_DFU_RELAY_NEIGHBOUR_RSSI (-80)
+
+/** RSSI to the nearest DFU transmitter below which a node always relays, in dBm. */
+#define APP_CONFIG_DFU_RELAY_EDGE_RSSI (-85)
+
 /** @} end of APP_SPECIFIC_DEFINES */
 
 
@@ -0,0 +1,179 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DFU_POLICY_H__
+#define DFU_POLICY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup DFU_POLICY DFU policy engine
+ *
+ * Decides whether this node accepts a mesh DFU transfer it is offered, so fleet updates can go out
+ * in waves instead of to every node at once.
+ *
+ * The node takes part in a rollout if its cohort is below the rollout percentage of the policy.
+ * The cohort is a hash of the device UUID and the policy salt, reduced to [0, 100). Raising the
+ * percentage with the same salt adds nodes to the rollout without dropping any.
+ *
+ * Application transfers must also match the application and company IDs of the running image, be
+ * newer than it unless downgrades are allowed, be within the version window of the policy, and not
+ * be one of its blocked versions. Bootloader transfers must match the bootloader ID and be newer.
+ * SoftDevice transfers are only accepted when the policy allows them.
+ *
+ * The policy is not thread safe. All calls must be made from the same interrupt priority.
+ * The module has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Highest number of blocked versions in a policy. */
+#define DFU_POLICY_BLOCKED_MAX          (4)
+
+/** Number of cohorts. */
+#define DFU_POLICY_COHORT_COUNT         (100)
+
+/** Flag: accept SoftDevice transfers. */
+#define DFU_POLICY_FLAG_SOFTDEVICE      (0x01)
+/** Flag: accept application versions older than the running one. */
+#define DFU_POLICY_FLAG_DOWNGRADE       (0x02)
+
+/** Outcome of a policy check. */
+typedef enum
+{
+    DFU_POLICY_ACCEPT,          /**< The transfer is accepted. */
+    DFU_POLICY_REJECT_ID,       /**< The transfer is for another application or bootloader. */
+    DFU_POLICY_REJECT_TYPE,     /**< The DFU type is not accepted by the policy. */
+    DFU_POLICY_REJECT_COHORT,   /**< The node is not in the rollout cohort. */
+    DFU_POLICY_REJECT_VERSION,  /**< The version is not newer than the running one. */
+    DFU_POLICY_REJECT_WINDOW,   /**< The version is outside the version window. */
+    DFU_POLICY_REJECT_BLOCKED   /**< The version is blocked. */
+} dfu_policy_verdict_t;
+
+/** DFU policy. */
+typedef struct
+{
+    uint16_t policy_id;                        /**< Identifier of the policy. */
+    uint8_t  flags;                            /**< Policy flags, @c DFU_POLICY_FLAG_*. */
+    uint8_t  rollout_percent;                  /**< Share of the fleet accepting transfers, 0 to 100. */
+    uint16_t cohort_salt;                      /**< Salt of the cohort hash. */
+    uint32_t version_min;                      /**< Lowest application version accepted. */
+    uint32_t version_max;                      /**< Highest application version accepted. */
+    uint8_t  blocked_count;                    /**< Number of blocked versions. */
+    uint32_t blocked[DFU_POLICY_BLOCKED_MAX];  /**< Application versions never accepted. */
+} dfu_policy_t;
+
+/** Identity of a firmware image, as far as the policy is concerned. */
+typedef struct
+{
+    uint32_t company_id; /**< Company ID of an application, bootloader ID of a bootloader. */
+    uint16_t id;         /**< Application ID, 0 for a bootloader. */
+    uint32_t version;    /**< Application version, bootloader version or SoftDevice FWID. */
+} dfu_policy_fwid_t;
+
+/**
+ * Gets the cohort of a node.
+ *
+ * @param[in] p_uuid Device UUID of the node.
+ * @param[in] length Length of the device UUID.
+ * @param[in] salt   Salt of the cohort hash.
+ *
+ * @returns Cohort of the node, in the range [0, @ref DFU_POLICY_COHORT_COUNT).
+ */
+uint8_t dfu_policy_cohort_get(const uint8_t * p_uuid, uint32_t length, uint16_t salt);
+
+/**
+ * Checks whether a cohort takes part in the rollout of a policy.
+ *
+ * @param[in] p_policy Policy.
+ * @param[in] cohort   Cohort of the node.
+ *
+ * @returns @c true if the cohort is in the rollout.
+ */
+static inline bool dfu_policy_in_cohort(const dfu_policy_t * p_policy, uint8_t cohort)
+{
+    return cohort < p_policy->rollout_percent;
+}
+
+/**
+ * Checks an offered application transfer against the policy.
+ *
+ * @param[in] p_policy  Policy.
+ * @param[in] cohort    Cohort of the node, for the salt of the policy.
+ * @param[in] p_current Running application.
+ * @param[in] p_offered Offered application.
+ *
+ * @returns The verdict.
+ */
+dfu_policy_verdict_t dfu_policy_app_check(const dfu_policy_t * p_policy,
+                                          uint8_t cohort,
+                                          const dfu_policy_fwid_t * p_current,
+                                          const dfu_policy_fwid_t * p_offered);
+
+/**
+ * Checks an offered bootloader transfer against the policy.
+ *
+ * @param[in] p_policy  Policy.
+ * @param[in] cohort    Cohort of the node, for the salt of the policy.
+ * @param[in] p_current Running bootloader.
+ * @param[in] p_offered Offered bootloader.
+ *
+ * @returns The verdict.
+ */
+dfu_policy_verdict_t dfu_policy_bootloader_check(const dfu_policy_t * p_policy,
+                                                 uint8_t cohort,
+                                                 const dfu_policy_fwid_t * p_current,
+                                                 const dfu_policy_fwid_t * p_offered);
+
+/**
+ * Checks an offered SoftDevice transfer against the policy.
+ *
+ * @param[in] p_policy Policy.
+ * @param[in] cohort   Cohort of the node, for the salt of the policy.
+ * @param[in] current  FWID of the running SoftDevice.
+ * @param[in] offered  FWID of the offered SoftDevice.
+ *
+ * @returns The verdict.
+ */
+dfu_policy_verdict_t dfu_policy_softdevice_check(const dfu_policy_t * p_policy,
+                                                 uint8_t cohort,
+                                                 uint16_t current,
+                                                 uint16_t offered);
+
+/** @} end of DFU_POLICY */
+
+#endif /* DFU_POLICY_H__ */
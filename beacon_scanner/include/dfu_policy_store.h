@@ -0,0 +1,105 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DFU_POLICY_STORE_H__
+#define DFU_POLICY_STORE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "mesh_flash.h"
+#include "dfu_policy.h"
+
+/**
+ * @defgroup DFU_POLICY_STORE DFU policy store
+ *
+ * Keeps the last DFU policy pushed by the gateway in a reserved flash page, so a reset does not
+ * fall back to accepting every newer image.
+ *
+ * Policies are appended to the page as checksummed records, and the newest valid record is the
+ * stored policy. The page is only erased when it is full, or when it holds anything else than
+ * policy records. A record torn by a reset is skipped, and the policy before it is restored.
+ *
+ * All flash operations are queued to the mesh flash module as @c MESH_FLASH_USER_APP, which has a
+ * single callback. The application forwards it to @ref dfu_policy_store_flash_op_cb. Only one
+ * write is in flight at a time, a policy saved meanwhile is written when it is done.
+ *
+ * All functions must be called from @ref NRF_MESH_IRQ_PRIORITY_LOWEST.
+ * @{
+ */
+
+/**
+ * Initializes the store.
+ *
+ * @param[in] page_addr Start of the page, page aligned.
+ * @param[in] page_size Size of a flash page, in bytes.
+ */
+void dfu_policy_store_init(uint32_t page_addr, uint32_t page_size);
+
+/**
+ * Loads the stored policy.
+ *
+ * @param[out] p_policy Policy to fill in. Left as is if no policy is stored.
+ *
+ * @retval NRF_SUCCESS         The stored policy was loaded.
+ * @retval NRF_ERROR_NOT_FOUND No policy is stored.
+ */
+uint32_t dfu_policy_store_load(dfu_policy_t * p_policy);
+
+/**
+ * Stores a policy, replacing the stored one.
+ *
+ * @param[in] p_policy Policy to store, copied by the store.
+ *
+ * @retval NRF_SUCCESS      The write was queued, or will be when the write in flight is done.
+ * @retval NRF_ERROR_NO_MEM The flash operation queue is full.
+ */
+uint32_t dfu_policy_store_save(const dfu_policy_t * p_policy);
+
+/**
+ * Handles the completion of a @c MESH_FLASH_USER_APP flash operation. Operations of other modules
+ * are ignored.
+ *
+ * @param[in] user  Flash user of the operation.
+ * @param[in] p_op  Operation that was done.
+ * @param[in] token Token of the operation.
+ */
+void dfu_policy_store_flash_op_cb(mesh_flash_user_t user, const flash_operation_t * p_op, uint16_t token);
+
+/** @} end of DFU_POLICY_STORE */
+
+#endif /* DFU_POLICY_STORE_H__ */
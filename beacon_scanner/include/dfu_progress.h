@@ -0,0 +1,163 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DFU_PROGRESS_H__
+#define DFU_PROGRESS_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup DFU_PROGRESS DFU progress tracker
+ *
+ * Follows the progress of a mesh DFU transfer on this node, for the DFU status telemetry.
+ *
+ * The DFU module of the mesh stack only reports the start and the end of a transfer. The tracker
+ * also reads the DFU data packets the node receives, in the mesh DFU service data advertisements,
+ * and keeps a bitmap of the received segments. The start segment gives the image length, and so
+ * the number of segments to expect, from which the missing ranges are found.
+ *
+ * A data packet with a new transaction ID restarts the bitmap.
+ *
+ * The tracker is not thread safe. All calls must be made from the same interrupt priority.
+ * The module has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Highest number of segments tracked, one bit of RAM each. Covers a 256 kB image. */
+#ifndef DFU_PROGRESS_SEGMENT_MAX
+#define DFU_PROGRESS_SEGMENT_MAX    (16384)
+#endif
+
+/** Number of image bytes in a DFU data segment. */
+#define DFU_PROGRESS_SEGMENT_SIZE   (16)
+
+/** Transfer states. */
+typedef enum
+{
+    DFU_PROGRESS_STATE_IDLE,     /**< No transfer since boot. */
+    DFU_PROGRESS_STATE_TARGET,   /**< Receiving an image for this node. */
+    DFU_PROGRESS_STATE_RELAY,    /**< Relaying an image for other nodes. */
+    DFU_PROGRESS_STATE_BANKED,   /**< The image is complete in the bank, waiting to be flashed. */
+    DFU_PROGRESS_STATE_COMPLETE, /**< The transfer ended successfully. */
+    DFU_PROGRESS_STATE_FAILED    /**< The transfer ended with an error. */
+} dfu_progress_state_t;
+
+/** Range of segments. */
+typedef struct
+{
+    uint16_t first; /**< First segment of the range. */
+    uint16_t count; /**< Number of segments in the range. */
+} dfu_progress_range_t;
+
+/** Transfer progress. */
+typedef struct
+{
+    uint8_t  state;                                   /**< Transfer state, @ref dfu_progress_state_t. */
+    uint8_t  dfu_type;                                /**< DFU type of the transfer, as in the mesh DFU API. */
+    uint8_t  end_reason;                              /**< End reason of the last transfer, as in the mesh DFU API. */
+    uint32_t fw_version;                              /**< Version of the transferred firmware. */
+    uint32_t transaction_id;                          /**< Transaction ID of the tracked data packets. */
+    uint32_t start_address;                           /**< Target address of the image, from the start segment. */
+    uint32_t image_length;                            /**< Length of the image in bytes, 0 until the start segment is received. */
+    uint16_t segment_count;                           /**< Number of segments in the image, 0 until the start segment is received. */
+    uint16_t received_count;                          /**< Number of different segments received. */
+    uint16_t highest_segment;                         /**< Highest segment number received. */
+    uint16_t relay_count;                             /**< Number of transfers relayed since boot. */
+    uint32_t duplicate_count;                         /**< Number of segments received more than once. */
+    uint8_t  bitmap[(DFU_PROGRESS_SEGMENT_MAX + 7) / 8]; /**< Received segments, segment 1 in bit 0. */
+} dfu_progress_t;
+
+/**
+ * Initializes an idle tracker.
+ *
+ * @param[out] p_progress Tracker to initialize.
+ */
+void dfu_progress_init(dfu_progress_t * p_progress);
+
+/**
+ * Records the start of a transfer.
+ *
+ * @param[in,out] p_progress Tracker.
+ * @param[in]     relay      @c true if the node relays the transfer, @c false if it is the target.
+ * @param[in]     dfu_type   DFU type of the transfer.
+ * @param[in]     fw_version Version of the transferred firmware.
+ */
+void dfu_progress_start(dfu_progress_t * p_progress, bool relay, uint8_t dfu_type, uint32_t fw_version);
+
+/**
+ * Records the end of a transfer.
+ *
+ * @param[in,out] p_progress Tracker.
+ * @param[in]     success    @c true if the transfer succeeded.
+ * @param[in]     end_reason End reason reported by the mesh DFU module.
+ */
+void dfu_progress_end(dfu_progress_t * p_progress, bool success, uint8_t end_reason);
+
+/**
+ * Records that the image is complete in the bank.
+ *
+ * @param[in,out] p_progress Tracker.
+ */
+void dfu_progress_banked(dfu_progress_t * p_progress);
+
+/**
+ * Reads a received advertisement packet, and records the segment if it is a DFU data packet.
+ *
+ * @param[in,out] p_progress Tracker.
+ * @param[in]     p_data     Advertisement data.
+ * @param[in]     length     Length of the advertisement data.
+ *
+ * @returns @c true if the packet is a DFU data packet.
+ */
+bool dfu_progress_packet_add(dfu_progress_t * p_progress, const uint8_t * p_data, uint8_t length);
+
+/**
+ * Gets the missing segment ranges, lowest first. Segments after the highest received one are only
+ * known to be missing once the start segment is received.
+ *
+ * @param[in]  p_progress Tracker.
+ * @param[out] p_ranges   Ranges to fill in.
+ * @param[in]  max_count  Number of ranges that fit in @p p_ranges.
+ *
+ * @returns Number of ranges filled in.
+ */
+uint32_t dfu_progress_missing_get(const dfu_progress_t * p_progress, dfu_progress_range_t * p_ranges, uint32_t max_count);
+
+/** @} end of DFU_PROGRESS */
+
+#endif /* DFU_PROGRESS_H__ */
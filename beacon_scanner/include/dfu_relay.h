@@ -0,0 +1,205 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DFU_RELAY_H__
+#define DFU_RELAY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup DFU_RELAY DFU relay policy
+ *
+ * Decides whether this node relays a mesh DFU transfer it is not the target of, so that a dense
+ * group of nodes does not rebroadcast every segment many times over.
+ *
+ * The policy listens to the advertisements around the node all the time, and keeps a table of
+ * the mesh nodes heard. When a transfer is offered, it listens for a randomized window and then
+ * decides from:
+ * - The neighbour density: the number of mesh nodes heard recently with a usable RSSI.
+ * - The DFU transmitters heard around the window: the source, and nodes that already relay.
+ * - The RSSI to the strongest DFU transmitter, the nearest upstream node.
+ * - The hop count to the DFU source, when known.
+ *
+ * The rules, in order:
+ * 1. If the nearest upstream DFU transmitter is weak, the node is at the edge of the coverage, and
+ *    always relays.
+ * 2. If enough DFU transmitters were already heard, the relay is suppressed (counter-based).
+ * 3. Otherwise the node relays with a probability of the target relay count over the neighbour
+ *    density, halved when the node is one hop from the source.
+ *
+ * The randomized window lets the first nodes to decide be heard by the later ones. A suppressed
+ * node is held off for a while, after which a new offer of the transfer is decided again, so
+ * holes left by relays that went away are filled.
+ *
+ * The policy is not thread safe. All calls must be made from the same interrupt priority.
+ * The module has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Highest number of neighbours tracked. */
+#ifndef DFU_RELAY_NEIGHBOURS_MAX
+#define DFU_RELAY_NEIGHBOURS_MAX    (32)
+#endif
+
+/** Length of an advertiser address. */
+#define DFU_RELAY_ADDR_LEN          (6)
+
+/** Hop count value for an unknown distance to the source. */
+#define DFU_RELAY_HOPS_UNKNOWN      (0)
+
+/** Relay decisions. */
+typedef enum
+{
+    DFU_RELAY_DECISION_RELAY,   /**< Relay the transfer. */
+    DFU_RELAY_DECISION_SUPPRESS /**< Do not relay the transfer. */
+} dfu_relay_decision_t;
+
+/** Policy configuration. */
+typedef struct
+{
+    uint32_t listen_ms;            /**< Shortest listening window, the window is up to twice as long. */
+    uint32_t holdoff_ms;           /**< Time a suppressed node ignores new offers, in milliseconds. */
+    uint32_t neighbour_timeout_ms; /**< Time a neighbour counts for the density after it was last heard, in milliseconds. */
+    uint8_t  target_count;         /**< Number of relays wanted around a node. */
+    int8_t   neighbour_rssi;       /**< Lowest RSSI of a neighbour counted for the density. */
+    int8_t   edge_rssi;            /**< Upstream RSSI below which the node always relays. */
+} dfu_relay_config_t;
+
+/** Neighbour entry. */
+typedef struct
+{
+    uint8_t  addr[DFU_RELAY_ADDR_LEN]; /**< Advertiser address. */
+    int8_t   rssi;                     /**< RSSI of the last packet. */
+    uint32_t timestamp;                /**< Time of the last mesh packet, in milliseconds. */
+    uint32_t dfu_timestamp;            /**< Time of the last DFU packet, in milliseconds. */
+    bool     dfu;                      /**< A DFU packet was heard from the neighbour. */
+} dfu_relay_neighbour_t;
+
+/** Inputs and outcome of a decision, for logging. */
+typedef struct
+{
+    uint32_t density;           /**< Number of neighbours counted for the density. */
+    uint32_t transmitter_count; /**< Number of DFU transmitters heard since one listening time before the window. */
+    int8_t   upstream_rssi;     /**< RSSI of the strongest DFU transmitter, INT8_MIN if none. */
+    uint8_t  hops;              /**< Hop count to the source, @ref DFU_RELAY_HOPS_UNKNOWN if not known. */
+    uint32_t probability;       /**< Relay probability used, in 1/256 units. */
+} dfu_relay_inputs_t;
+
+/** Relay policy state. */
+typedef struct
+{
+    dfu_relay_config_t config;                                  /**< Configuration. */
+    dfu_relay_neighbour_t neighbours[DFU_RELAY_NEIGHBOURS_MAX]; /**< Neighbours heard. */
+    uint32_t neighbour_count;                                   /**< Number of neighbour entries in use. */
+    uint32_t listen_timestamp;                                  /**< Start of the listening window. */
+    uint32_t holdoff_timestamp;                                 /**< End of the holdoff after a suppression. */
+    bool     listening;                                         /**< A listening window is open. */
+    bool     holdoff;                                           /**< New offers are ignored until @c holdoff_timestamp. */
+    uint8_t  hops;                                              /**< Hop count to the source. */
+    uint32_t seed;                                              /**< State of the random generator. */
+    uint32_t relay_count;                                       /**< Number of relay decisions. */
+    uint32_t suppress_count;                                    /**< Number of suppressed relays. */
+} dfu_relay_t;
+
+/**
+ * Initializes the policy.
+ *
+ * @param[out] p_relay  Policy to initialize.
+ * @param[in]  p_config Configuration, copied.
+ * @param[in]  seed     Seed of the random generator, different for every node.
+ */
+void dfu_relay_init(dfu_relay_t * p_relay, const dfu_relay_config_t * p_config, uint32_t seed);
+
+/**
+ * Records a received advertisement. Packets other than mesh and mesh DFU packets are ignored.
+ *
+ * @param[in,out] p_relay Policy.
+ * @param[in]     p_data  Advertisement data.
+ * @param[in]     length  Length of the advertisement data.
+ * @param[in]     p_addr  Advertiser address.
+ * @param[in]     rssi    RSSI of the packet.
+ * @param[in]     now     Current time, in milliseconds.
+ */
+void dfu_relay_packet_add(dfu_relay_t * p_relay,
+                          const uint8_t * p_data,
+                          uint8_t length,
+                          const uint8_t * p_addr,
+                          int8_t rssi,
+                          uint32_t now);
+
+/**
+ * Sets the hop count to the DFU source.
+ *
+ * @param[in,out] p_relay Policy.
+ * @param[in]     hops    Hop count, or @ref DFU_RELAY_HOPS_UNKNOWN.
+ */
+void dfu_relay_hops_set(dfu_relay_t * p_relay, uint8_t hops);
+
+/**
+ * Opens a listening window for an offered transfer.
+ *
+ * @param[in,out] p_relay     Policy.
+ * @param[in]     now         Current time, in milliseconds.
+ * @param[out]    p_window_ms Length of the window, in milliseconds. Decide when it has passed.
+ *
+ * @retval true  The window was opened.
+ * @retval false A window is already open, or the node is held off after a suppression.
+ */
+bool dfu_relay_listen_start(dfu_relay_t * p_relay, uint32_t now, uint32_t * p_window_ms);
+
+/**
+ * Closes the listening window without a decision.
+ *
+ * @param[in,out] p_relay Policy.
+ */
+void dfu_relay_listen_cancel(dfu_relay_t * p_relay);
+
+/**
+ * Decides whether to relay the offered transfer, and closes the listening window.
+ *
+ * @param[in,out] p_relay  Policy.
+ * @param[in]     now      Current time, in milliseconds.
+ * @param[out]    p_inputs Inputs of the decision, for logging. May be NULL.
+ *
+ * @returns The decision.
+ */
+dfu_relay_decision_t dfu_relay_decide(dfu_relay_t * p_relay, uint32_t now, dfu_relay_inputs_t * p_inputs);
+
+/** @} end of DFU_RELAY */
+
+#endif /* DFU_RELAY_H__ */
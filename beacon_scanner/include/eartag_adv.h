@@ -0,0 +1,106 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EARTAG_ADV_H__
+#define EARTAG_ADV_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "eartag_config.h"
+
+/**
+ * @defgroup EARTAG_ADV Eartag advertisement parser
+ *
+ * Parses the advertisement data of eartag packets into fixed-size sighting records.
+ *
+ * Eartag packets have a fixed layout (see @ref EARTAG_CONFIG). Packets are first checked by a
+ * prefilter, which compares the length and three 32-bit words of the manufacturer specific data
+ * against match words folded from the configuration at compile time. This rejects phones and other
+ * advertisers in a few instructions, before anything is copied.
+ *
+ * The parser has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Length of the eartag (advertiser) address. */
+#define EARTAG_ADDR_LEN              (6)
+
+/** Length of the manufacturer specific AD structure carrying the eartag data, excluding the length field. */
+#define EARTAG_ADV_AD_LENGTH         (26)
+
+/** Length of the advertisement data of an eartag packet. */
+#define EARTAG_ADV_PACKET_LENGTH     (EARTAG_ADV_PREFIX_LEN + 1 + EARTAG_ADV_AD_LENGTH)
+
+/** Single sighting of an eartag. */
+typedef struct
+{
+    uint8_t  addr[EARTAG_ADDR_LEN]; /**< Advertiser address of the eartag, little endian. */
+    int8_t   rssi;                  /**< Received signal strength in dBm. */
+    int8_t   tx_power;              /**< Calibrated TX power reported by the eartag. */
+    uint16_t major;                 /**< Major identifier reported by the eartag. */
+    uint16_t minor;                 /**< Minor identifier reported by the eartag. */
+    uint32_t timestamp;             /**< Time of reception in milliseconds. */
+} eartag_sighting_t;
+
+/**
+ * Checks whether the advertisement data of a packet can be an eartag advertisement.
+ *
+ * @param[in] p_data Advertisement data, a sequence of AD structures.
+ * @param[in] length Length of the advertisement data.
+ *
+ * @returns @c true if the length, company ID, beacon type and UUID prefix match, @c false otherwise.
+ */
+bool eartag_adv_prefilter(const uint8_t * p_data, uint8_t length);
+
+/**
+ * Parses the advertisement data of a packet.
+ *
+ * Only the identifier fields (@c tx_power, @c major and @c minor) of the sighting are filled in,
+ * the caller is responsible for the address, RSSI and timestamp.
+ *
+ * @param[in]  p_data     Advertisement data, a sequence of AD structures.
+ * @param[in]  length     Length of the advertisement data.
+ * @param[out] p_sighting Sighting to fill in.
+ *
+ * @returns @c true if the packet is an eartag advertisement, @c false otherwise.
+ */
+bool eartag_adv_parse(const uint8_t * p_data, uint8_t length, eartag_sighting_t * p_sighting);
+
+/** @} end of EARTAG_ADV */
+
+#endif /* EARTAG_ADV_H__ */
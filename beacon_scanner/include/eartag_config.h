@@ -0,0 +1,79 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EARTAG_CONFIG_H__
+#define EARTAG_CONFIG_H__
+
+/**
+ * @defgroup EARTAG_CONFIG Eartag advertisement configuration
+ *
+ * Compile-time description of the advertisement packets sent by the eartags.
+ *
+ * The eartags advertise a flags AD structure followed by an iBeacon style manufacturer specific
+ * data structure:
+ * `[length][0xFF][company ID][beacon type][beacon length][UUID][major][minor][TX power]`
+ *
+ * The advertisement prefilter (see @ref EARTAG_ADV) is built from these constants, so packets from
+ * a different eartag generation only need changes here.
+ * @{
+ */
+
+/** Company ID used in the manufacturer specific data of the eartag advertisements. */
+#define EARTAG_COMPANY_ID            (0x004C)
+
+/** Beacon type indicator following the company ID. */
+#define EARTAG_BEACON_TYPE           (0x02)
+
+/** Number of beacon data bytes following the beacon length indicator. */
+#define EARTAG_BEACON_DATA_LENGTH    (0x15)
+
+/** Length of the eartag proximity UUID. */
+#define EARTAG_UUID_LEN              (16)
+
+/** Bytes of the proximity UUID shared by all eartags, in advertising order. */
+#define EARTAG_UUID_BYTES            0xE2, 0xC5, 0x6D, 0xB5, 0xDF, 0xFB, 0x48, 0xD2, \
+                                     0xB0, 0x60, 0xD0, 0xF5, 0xA7, 0x10, 0x96, 0xE0
+
+/** Proximity UUID shared by all eartags, as an array initializer. */
+#define EARTAG_UUID                  {EARTAG_UUID_BYTES}
+
+/** Length of the AD structures preceding the manufacturer specific data, 0 if the eartags send none. */
+#define EARTAG_ADV_PREFIX_LEN        (3)
+
+/** @} end of EARTAG_CONFIG */
+
+#endif /* EARTAG_CONFIG_H__ */
@@ -0,0 +1,128 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EARTAG_SCANNER_H__
+#define EARTAG_SCANNER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "eartag_adv.h"
+
+/**
+ * @defgroup EARTAG_SCANNER Eartag scanner
+ *
+ * Hooks into the mesh scanner and turns received eartag advertisements into sightings.
+ *
+ * The sighting callback is called directly from the mesh packet processing context, which runs at
+ * @ref NRF_MESH_IRQ_PRIORITY_LOWEST, the same priority as the app_timer callbacks. It must be short.
+ * @{
+ */
+
+/**
+ * Sighting callback type.
+ *
+ * @param[in] p_sighting Sighting of an eartag. Only valid for the duration of the call.
+ */
+typedef void (*eartag_scanner_sighting_cb_t)(const eartag_sighting_t * p_sighting);
+
+/**
+ * Packet callback type, for the received advertisements that are not from eartags.
+ *
+ * @param[in] p_data Advertisement data. Only valid for the duration of the call.
+ * @param[in] length Length of the advertisement data.
+ * @param[in] p_addr Advertiser address, little endian. Only valid for the duration of the call.
+ * @param[in] rssi   RSSI of the packet.
+ */
+typedef void (*eartag_scanner_packet_cb_t)(const uint8_t * p_data, uint8_t length, const uint8_t * p_addr, int8_t rssi);
+
+/** Eartag scanner counters. */
+typedef struct
+{
+    uint32_t rx_count;       /**< Number of advertisement packets received while enabled. */
+    uint32_t sighting_count; /**< Number of packets recognized as eartag advertisements. */
+    uint32_t weak_count;     /**< Number of eartag advertisements dropped for being below the RSSI floor. */
+} eartag_scanner_stats_t;
+
+/**
+ * Initializes the eartag scanner and registers it as the mesh RX callback.
+ *
+ * The scanner starts disabled.
+ *
+ * @param[in] sighting_cb Callback receiving every eartag sighting.
+ */
+void eartag_scanner_init(eartag_scanner_sighting_cb_t sighting_cb);
+
+/**
+ * Sets the callback receiving the advertisements that are not from eartags, also while the
+ * scanner is disabled.
+ *
+ * @param[in] packet_cb Packet callback, or NULL to stop forwarding the packets.
+ */
+void eartag_scanner_packet_cb_set(eartag_scanner_packet_cb_t packet_cb);
+
+/**
+ * Enables or disables the processing of eartag advertisements.
+ *
+ * @param[in] enable @c true to forward eartag sightings to the sighting callback.
+ */
+void eartag_scanner_enable(bool enable);
+
+/**
+ * Sets the RSSI floor. Eartag advertisements received with a lower RSSI are dropped.
+ *
+ * @param[in] rssi_floor Lowest accepted RSSI, in dBm.
+ */
+void eartag_scanner_rssi_floor_set(int8_t rssi_floor);
+
+/**
+ * Gets the current time on the millisecond clock used for sighting timestamps.
+ *
+ * @returns Current time in milliseconds.
+ */
+uint32_t eartag_scanner_time_ms_get(void);
+
+/**
+ * Gets the scanner counters.
+ *
+ * @param[out] p_stats Counters to fill in.
+ */
+void eartag_scanner_stats_get(eartag_scanner_stats_t * p_stats);
+
+/** @} end of EARTAG_SCANNER */
+
+#endif /* EARTAG_SCANNER_H__ */
@@ -0,0 +1,165 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLASH_LAYOUT_H__
+#define FLASH_LAYOUT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup FLASH_LAYOUT Flash layout planner
+ *
+ * Maps the regions of the application flash that are in use, and places the DFU bank in the
+ * rest.
+ *
+ * The application adds the regions it knows about: the application image, its own flash storage,
+ * the mesh flash pages and the bootloader. The planner then puts the bank at the start of the
+ * largest free gap between them, so the bank holds the largest image possible.
+ *
+ * A transfer is checked against the plan as soon as its size is known, so an image that cannot be
+ * banked or would overwrite a protected region is rejected at the start of the transfer, not at
+ * the end.
+ *
+ * The module has no SDK dependencies other than the error codes, and can be built for the host.
+ * @{
+ */
+
+/** Highest number of regions in a layout. */
+#ifndef FLASH_LAYOUT_REGIONS_MAX
+#define FLASH_LAYOUT_REGIONS_MAX    (8)
+#endif
+
+/** A region of flash in use. */
+typedef struct
+{
+    const char * p_name; /**< Name of the region, for logging. */
+    uint32_t start;      /**< First address of the region. */
+    uint32_t end;        /**< First address after the region. */
+    bool     keep;       /**< The region must survive a DFU, a new image may not be written over it. */
+} flash_layout_region_t;
+
+/** Flash layout. */
+typedef struct
+{
+    uint32_t flash_start;  /**< First address available to the application. */
+    uint32_t flash_end;    /**< First address after the flash. */
+    uint32_t page_size;    /**< Size of a flash page, in bytes. */
+    flash_layout_region_t regions[FLASH_LAYOUT_REGIONS_MAX]; /**< Regions in use, lowest first. */
+    uint32_t region_count; /**< Number of regions in use. */
+    uint32_t bank_start;   /**< First address of the bank, 0 until planned. */
+    uint32_t bank_end;     /**< First address after the bank. */
+} flash_layout_t;
+
+/**
+ * Initializes an empty layout.
+ *
+ * @param[out] p_layout    Layout to initialize.
+ * @param[in]  flash_start First address available to the application, page aligned.
+ * @param[in]  flash_end   First address after the flash, page aligned.
+ * @param[in]  page_size   Size of a flash page, in bytes.
+ */
+void flash_layout_init(flash_layout_t * p_layout, uint32_t flash_start, uint32_t flash_end, uint32_t page_size);
+
+/**
+ * Adds a region in use to the layout. The region does not need to be page aligned, the pages
+ * it touches are taken out of the free space.
+ *
+ * @param[in,out] p_layout Layout.
+ * @param[in]     p_name   Name of the region, for logging. Must stay valid.
+ * @param[in]     start    First address of the region.
+ * @param[in]     end      First address after the region.
+ * @param[in]     keep     The region must not be overwritten by a new image.
+ *
+ * @retval NRF_SUCCESS             The region was added.
+ * @retval NRF_ERROR_NO_MEM        The layout already has @ref FLASH_LAYOUT_REGIONS_MAX regions.
+ * @retval NRF_ERROR_INVALID_PARAM The region is empty or outside the flash.
+ * @retval NRF_ERROR_INVALID_STATE The region overlaps a region already added.
+ */
+uint32_t flash_layout_region_add(flash_layout_t * p_layout, const char * p_name, uint32_t start, uint32_t end, bool keep);
+
+/**
+ * Places the bank in the largest free gap of the layout.
+ *
+ * @param[in,out] p_layout Layout.
+ *
+ * @retval NRF_SUCCESS      The bank was placed, see @c bank_start and @c bank_end.
+ * @retval NRF_ERROR_NO_MEM There is no free page.
+ */
+uint32_t flash_layout_bank_plan(flash_layout_t * p_layout);
+
+/**
+ * Checks that an image of the given length fits in the bank.
+ *
+ * @param[in] p_layout Layout, with a planned bank.
+ * @param[in] length   Length of the image, in bytes.
+ *
+ * @retval NRF_SUCCESS             The image fits.
+ * @retval NRF_ERROR_NO_MEM        The image is larger than the bank.
+ * @retval NRF_ERROR_INVALID_STATE The bank is not planned.
+ */
+uint32_t flash_layout_bank_check(const flash_layout_t * p_layout, uint32_t length);
+
+/**
+ * Checks that an image can be copied to its target address without overwriting the bank or a
+ * region that must be kept.
+ *
+ * @param[in] p_layout Layout, with a planned bank.
+ * @param[in] start    Target address of the image.
+ * @param[in] length   Length of the image, in bytes.
+ *
+ * @retval NRF_SUCCESS             The target is free to overwrite.
+ * @retval NRF_ERROR_INVALID_ADDR  The target is outside the flash, or overlaps the bank or a kept region.
+ * @retval NRF_ERROR_INVALID_STATE The bank is not planned.
+ */
+uint32_t flash_layout_target_check(const flash_layout_t * p_layout, uint32_t start, uint32_t length);
+
+/**
+ * Gets the number of bytes in the bank.
+ *
+ * @param[in] p_layout Layout.
+ *
+ * @returns Size of the bank, 0 if not planned.
+ */
+static inline uint32_t flash_layout_bank_size(const flash_layout_t * p_layout)
+{
+    return p_layout->bank_end - p_layout->bank_start;
+}
+
+/** @} end of FLASH_LAYOUT */
+
+#endif /* FLASH_LAYOUT_H__ */
@@ -66,6 +66,23 @@
 
 /** @} end of DEVICE_CONFIG */
 
+/**
+ * @defgroup APP_MODEL_CONFIG Application model configuration
+ * @{
+ */
+
+/**
+ * The number of Simple Beacon server instances, one per element.
+ *
+ * Each instance has its own publish address, report sequence numbers and reliable transfer
+ * context, and the eartags are sharded across them by address. The element, model, subscription
+ * and address counts below are sized from this value, next to the DFU Status server on the first
+ * element.
+ */
+#define SIMPLE_BEACON_SERVER_SHARD_COUNT (2)
+
+/** @} end of APP_MODEL_CONFIG */
+
 /**
  * @defgroup ACCESS_CONFIG Access layer configuration
  * @{
@@ -82,7 +99,7 @@
  * @note This value has to be greater than two to fit the configuration and health models,
  * plus the number of models needed by the application.
  */
-#define ACCESS_MODEL_COUNT (3)
+#define ACCESS_MODEL_COUNT (3 + SIMPLE_BEACON_SERVER_SHARD_COUNT)
 
 /**
  * The number of elements in the application.
@@ -90,7 +107,7 @@
  * @warning If the application is to support multiple _instances_ of the _same_ model, they cannot
  * belong in the same element and a separate element is needed for the new instance.
  */
-#define ACCESS_ELEMENT_COUNT (1)
+#define ACCESS_ELEMENT_COUNT (SIMPLE_BEACON_SERVER_SHARD_COUNT)
 
 /**
  * The number of allocated subscription lists for the application.
@@ -98,7 +115,7 @@
  * @note The application should set this number to @ref ACCESS_MODEL_COUNT minus the number of
  * models operating on shared states.
  */
-#define ACCESS_SUBSCRIPTION_LIST_COUNT (1)
+#define ACCESS_SUBSCRIPTION_LIST_COUNT (1 + SIMPLE_BEACON_SERVER_SHARD_COUNT)
 
 /**
  * The number of pages of flash storage reserved for the access layer for persistent data storage.
@@ -133,11 +150,12 @@
 /** Maximum number of virtual addresses. */
 #define DSM_VIRTUAL_ADDR_MAX                            (1)
 /** Maximum number of non-virtual addresses.
- * - Generic OnOff publication
  * - Health publication
+ * - Simple Beacon publication, one per shard
+ * - DFU Status publication
  * - Subscription address
  */
-#define DSM_NONVIRTUAL_ADDR_MAX                         (3)
+#define DSM_NONVIRTUAL_ADDR_MAX                         (3 + SIMPLE_BEACON_SERVER_SHARD_COUNT)
 /** Number of flash pages reserved for the DSM storage */
 #define DSM_FLASH_PAGE_COUNT                            (1)
 /** @} end of DSM_CONFIG */
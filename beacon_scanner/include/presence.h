@@ -0,0 +1,188 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PRESENCE_H__
+#define PRESENCE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "eartag_adv.h"
+
+/**
+ * @defgroup PRESENCE Presence tracker
+ *
+ * Per-eartag presence state machine, turning a stream of sightings into enter and leave events.
+ *
+ * Every tracked eartag goes through the states absent, entering, present and leaving:
+ * - An absent eartag heard at or above the enter RSSI becomes entering.
+ * - An entering eartag whose filtered RSSI stays at or above the enter RSSI for the enter time
+ *   becomes present, and an enter event is reported.
+ * - A present eartag that is not heard at or above the leave RSSI for the leave time becomes leaving.
+ * - A leaving eartag heard at or above the leave RSSI is present again, without any event.
+ * - A leaving eartag that stays silent for another leave time becomes absent, and a leave event is
+ *   reported. Entering eartags that go silent for the leave time are dropped without any event.
+ *
+ * When the table is full, an entering eartag that has not been heard for the enter time is given up
+ * to make room for a new one. Otherwise the sighting of the new eartag is dropped.
+ *
+ * The gap between the enter and leave RSSI, and the enter and leave times, keep eartags at the
+ * edge of the range from flapping. Time based transitions are made by @ref presence_tick.
+ *
+ * The tracker also keeps a digest of the present set: the number of present eartags and an order
+ * independent fingerprint of their addresses, so a receiver of the events can check that it is in
+ * sync with the tracker.
+ *
+ * The tracker is not thread safe. All calls must be made from the same interrupt priority.
+ * The module has no SDK dependencies, and can be built for the host to replay recorded traces.
+ * @{
+ */
+
+/** Base two logarithm of the number of eartags tracked at once. */
+#ifndef PRESENCE_TABLE_SIZE_LOG2
+#define PRESENCE_TABLE_SIZE_LOG2     (7)
+#endif
+
+/** Number of eartags tracked at once. */
+#define PRESENCE_TABLE_SIZE          (1u << PRESENCE_TABLE_SIZE_LOG2)
+
+/** Maximum number of slots probed for a single eartag. */
+#ifndef PRESENCE_TABLE_PROBE_MAX
+#define PRESENCE_TABLE_PROBE_MAX     (8)
+#endif
+
+/** Presence states. */
+typedef enum
+{
+    PRESENCE_STATE_ABSENT,   /**< Not tracked. */
+    PRESENCE_STATE_ENTERING, /**< Heard, not yet reported as present. */
+    PRESENCE_STATE_PRESENT,  /**< Reported as present. */
+    PRESENCE_STATE_LEAVING   /**< Reported as present, but not heard recently. */
+} presence_state_t;
+
+/** Presence event types. */
+typedef enum
+{
+    PRESENCE_EVENT_ENTER, /**< The eartag became present. */
+    PRESENCE_EVENT_LEAVE  /**< The eartag became absent. */
+} presence_event_type_t;
+
+/** Presence event. */
+typedef struct
+{
+    uint8_t  addr[EARTAG_ADDR_LEN]; /**< Advertiser address of the eartag, little endian. */
+    uint8_t  type;                  /**< Event type, @ref presence_event_type_t. */
+    int8_t   rssi;                  /**< Filtered RSSI at the time of the event, in dBm. */
+    uint32_t timestamp;             /**< Time of the event, in milliseconds. */
+} presence_event_t;
+
+/**
+ * Event callback type, called for every state change that is reported.
+ *
+ * @param[in] p_event Event, only valid during the call.
+ */
+typedef void (*presence_event_cb_t)(const presence_event_t * p_event);
+
+/** Presence tracker configuration. */
+typedef struct
+{
+    int8_t   enter_rssi;          /**< Filtered RSSI needed to become present, in dBm. */
+    int8_t   leave_rssi;          /**< Filtered RSSI needed to stay present, in dBm. Should be below @c enter_rssi. */
+    uint32_t enter_ms;            /**< Time an eartag must be heard before it is present, in milliseconds. */
+    uint32_t leave_ms;            /**< Silent time before a present eartag starts leaving, and before it has left, in milliseconds. */
+    presence_event_cb_t event_cb; /**< Event callback. */
+} presence_config_t;
+
+/** Presence state of one eartag. */
+typedef struct
+{
+    uint8_t  addr[EARTAG_ADDR_LEN]; /**< Advertiser address of the eartag, little endian. */
+    uint8_t  slot;                  /**< Slot state, internal to the tracker. */
+    uint8_t  state;                 /**< Presence state, @ref presence_state_t. */
+    int16_t  rssi_filtered;         /**< Filtered RSSI, in 1/16 dBm. */
+    uint32_t state_timestamp;       /**< Time of the last state change, in milliseconds. */
+    uint32_t heard_timestamp;       /**< Time the eartag was last heard above the threshold of its state, in milliseconds. */
+} presence_entry_t;
+
+/** Presence tracker. */
+typedef struct
+{
+    presence_entry_t entries[PRESENCE_TABLE_SIZE]; /**< Table slots. */
+    presence_config_t config;                      /**< Tracker configuration. */
+    uint32_t present_count;                        /**< Number of present or leaving eartags. */
+    uint32_t fingerprint;                          /**< Fingerprint of the present or leaving eartags. */
+    uint32_t drop_count;                           /**< Number of sightings of new eartags dropped for lack of room. */
+} presence_tracker_t;
+
+/**
+ * Initializes a tracker with no eartags present.
+ *
+ * @param[out] p_tracker Tracker to initialize.
+ * @param[in]  p_config  Tracker configuration, copied by the tracker.
+ */
+void presence_init(presence_tracker_t * p_tracker, const presence_config_t * p_config);
+
+/**
+ * Feeds a sighting to the tracker.
+ *
+ * @param[in,out] p_tracker  Tracker.
+ * @param[in]     p_sighting Sighting of an eartag.
+ */
+void presence_sighting_add(presence_tracker_t * p_tracker, const eartag_sighting_t * p_sighting);
+
+/**
+ * Makes the time based transitions. Should be called at least a few times per leave time.
+ *
+ * @param[in,out] p_tracker Tracker.
+ * @param[in]     now       Current time, in milliseconds, on the same clock as the sighting timestamps.
+ */
+void presence_tick(presence_tracker_t * p_tracker, uint32_t now);
+
+/**
+ * Gets the fingerprint of an address, as combined into the tracker fingerprint.
+ *
+ * The tracker fingerprint is the exclusive or of the fingerprints of all present eartags.
+ *
+ * @param[in] p_addr Advertiser address of the eartag.
+ *
+ * @returns Fingerprint of the address.
+ */
+uint32_t presence_addr_fingerprint(const uint8_t * p_addr);
+
+/** @} end of PRESENCE */
+
+#endif /* PRESENCE_H__ */
@@ -0,0 +1,191 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REPORT_BACKLOG_H__
+#define REPORT_BACKLOG_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "mesh_flash.h"
+#include "simple_beacon_codec.h"
+
+/**
+ * @defgroup REPORT_BACKLOG Report backlog
+ *
+ * Ring log of report entries in a reserved flash region, holding the reports that could not be
+ * published while the gateway was unreachable.
+ *
+ * The region is a ring of pages. Every page starts with a header carrying a sequence number, so
+ * the oldest and newest pages are found again after a reset. Records are appended to the newest
+ * page, and when it is full the oldest page is erased and reused, dropping any records still
+ * pending in it. Every page is erased once per lap of the ring, which spreads the wear evenly.
+ *
+ * A record is drained by clearing its state word in place, so draining does not need an erase.
+ * Records are checksummed, a record torn by a reset is skipped.
+ *
+ * All flash operations are queued to the mesh flash module as @c MESH_FLASH_USER_APP, and are
+ * executed in the mesh timeslot, so they never stall the radio. The flash user has a single
+ * callback, the application forwards it to @ref report_backlog_flash_op_cb. Only one record write
+ * is in flight at a time.
+ *
+ * All functions must be called from @ref NRF_MESH_IRQ_PRIORITY_LOWEST.
+ * @{
+ */
+
+/** Maximum number of entries in one record. */
+#ifndef REPORT_BACKLOG_RECORD_ENTRIES_MAX
+#define REPORT_BACKLOG_RECORD_ENTRIES_MAX  (64)
+#endif
+
+/** A record in the backlog, pending or already drained. */
+typedef struct
+{
+    const simple_beacon_report_entry_t * p_entries; /**< Entries of the record, in flash. */
+    uint32_t count;                                 /**< Number of entries. */
+    uint32_t seq;                                   /**< Record sequence number. */
+    uint32_t timestamp;                             /**< Time the record was written, in milliseconds. */
+    bool     stale;                                 /**< The record was written before the last reset, and @c timestamp is on a different clock. */
+} report_backlog_record_t;
+
+/** Report backlog counters. */
+typedef struct
+{
+    uint32_t pending_count; /**< Number of records waiting to be drained. */
+    uint32_t written_count; /**< Number of records written since init. */
+    uint32_t drained_count; /**< Number of records drained since init. */
+    uint32_t lost_count;    /**< Number of pending records overwritten because the ring was full. */
+} report_backlog_stats_t;
+
+/**
+ * Initializes the backlog, and recovers the records left in the region.
+ *
+ * @param[in] start_addr Start of the region, page aligned.
+ * @param[in] page_size  Size of a flash page, in bytes.
+ * @param[in] page_count Number of pages in the region, at least 2.
+ */
+void report_backlog_init(uint32_t start_addr, uint32_t page_size, uint32_t page_count);
+
+/**
+ * Appends a record to the backlog.
+ *
+ * @param[in] p_entries Report entries to store, with their ages relative to @p timestamp.
+ * @param[in] count     Number of entries.
+ * @param[in] timestamp Time the entries were taken from the sighting table, in milliseconds.
+ *
+ * @retval NRF_SUCCESS              The record write was queued.
+ * @retval NRF_ERROR_BUSY           A record write is still in flight.
+ * @retval NRF_ERROR_NO_MEM         The flash operation queue is full.
+ * @retval NRF_ERROR_INVALID_LENGTH The record is empty or larger than @ref REPORT_BACKLOG_RECORD_ENTRIES_MAX.
+ */
+uint32_t report_backlog_write(const simple_beacon_report_entry_t * p_entries, uint32_t count, uint32_t timestamp);
+
+/**
+ * Gets the oldest pending record.
+ *
+ * @param[out] pp_entries  Entries of the record, in flash. Valid until the record is popped.
+ * @param[out] p_count     Number of entries.
+ * @param[out] p_timestamp Time the record was written, in milliseconds.
+ * @param[out] p_stale     Set to @c true if the record was written before the last reset, in which
+ *                         case @p p_timestamp is on a different clock.
+ *
+ * @retval NRF_SUCCESS         The oldest record was returned.
+ * @retval NRF_ERROR_NOT_FOUND The backlog is empty.
+ */
+uint32_t report_backlog_peek(const simple_beacon_report_entry_t ** pp_entries,
+                             uint32_t * p_count,
+                             uint32_t * p_timestamp,
+                             bool * p_stale);
+
+/**
+ * Marks the oldest pending record as drained.
+ *
+ * @retval NRF_SUCCESS         The record was drained.
+ * @retval NRF_ERROR_NOT_FOUND The backlog is empty.
+ */
+uint32_t report_backlog_pop(void);
+
+/**
+ * Finds the oldest record still in flash with a sequence number of at least @p seq. Drained
+ * records are found as well, until their page is reused.
+ *
+ * The entries point into flash, and stay valid until the next call to @ref report_backlog_write.
+ *
+ * @param[in]  seq      Lowest record sequence number to look for.
+ * @param[out] p_record Record found.
+ *
+ * @retval NRF_SUCCESS         A record was found.
+ * @retval NRF_ERROR_NOT_FOUND There is no record at or after @p seq.
+ */
+uint32_t report_backlog_find(uint32_t seq, report_backlog_record_t * p_record);
+
+/**
+ * Marks all pending records with a sequence number lower than @p seq as drained.
+ *
+ * @param[in] seq Sequence number of the oldest record to keep pending.
+ *
+ * @returns Number of records drained.
+ */
+uint32_t report_backlog_drain_before(uint32_t seq);
+
+/**
+ * Gets the number of records waiting to be drained.
+ *
+ * @returns Number of pending records.
+ */
+uint32_t report_backlog_count(void);
+
+/**
+ * Handles the completion of a @c MESH_FLASH_USER_APP flash operation. Operations of other modules
+ * are ignored.
+ *
+ * @param[in] user  Flash user of the operation.
+ * @param[in] p_op  Operation that was done.
+ * @param[in] token Token of the operation.
+ */
+void report_backlog_flash_op_cb(mesh_flash_user_t user, const flash_operation_t * p_op, uint16_t token);
+
+/**
+ * Gets the backlog counters.
+ *
+ * @param[out] p_stats Counters to fill in.
+ */
+void report_backlog_stats_get(report_backlog_stats_t * p_stats);
+
+/** @} end of REPORT_BACKLOG */
+
+#endif /* REPORT_BACKLOG_H__ */
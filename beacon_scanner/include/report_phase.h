@@ -0,0 +1,89 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REPORT_PHASE_H__
+#define REPORT_PHASE_H__
+
+#include <stdint.h>
+
+/**
+ * @defgroup REPORT_PHASE Report phase
+ *
+ * Derives a stable publish phase and jitter window from the node address, so that scanners
+ * configured identically spread their periodic reports over the report interval instead of
+ * flushing at the same time.
+ *
+ * The phase is the fractional part of the node number multiplied by the golden ratio. The
+ * provisioner hands out consecutive unicast addresses, one per element, so the unicast address
+ * divided by the number of elements numbers the nodes consecutively, and their phases are spread
+ * evenly over the interval for any fleet size. The jitter window is half the slot width, so jittered reports of
+ * neighbouring slots do not overlap.
+ *
+ * The module has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Publish phase of a node. */
+typedef struct
+{
+    uint32_t offset_ms; /**< Offset of the first report from the start of the interval, in milliseconds. */
+    uint32_t jitter_ms; /**< Width of the jitter window, in milliseconds. */
+    uint32_t seed;      /**< State of the jitter generator. */
+} report_phase_t;
+
+/**
+ * Derives the publish phase of a node.
+ *
+ * @param[out] p_phase      Phase to initialize.
+ * @param[in]  address      Unicast address of the node, divided by the number of elements per node.
+ * @param[in]  interval_ms  Report interval, in milliseconds.
+ * @param[in]  node_count   Number of nodes sharing the interval.
+ */
+void report_phase_init(report_phase_t * p_phase, uint16_t address, uint32_t interval_ms, uint32_t node_count);
+
+/**
+ * Gets the next jitter value.
+ *
+ * @param[in,out] p_phase Phase to draw the jitter from.
+ *
+ * @returns Pseudo random value in the range [0, @c jitter_ms), zero if the jitter window is empty.
+ */
+uint32_t report_phase_jitter_get(report_phase_t * p_phase);
+
+/** @} end of REPORT_PHASE */
+
+#endif /* REPORT_PHASE_H__ */
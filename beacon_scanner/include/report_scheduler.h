@@ -0,0 +1,151 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REPORT_SCHEDULER_H__
+#define REPORT_SCHEDULER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh.h"
+#include "report_phase.h"
+
+/**
+ * @defgroup REPORT_SCHEDULER Report scheduler
+ *
+ * Decides when report batches are flushed to the mesh.
+ *
+ * A batch is flushed when the batch is full or when the report interval expires. When the
+ * mesh TX queue is full (@c NRF_ERROR_NO_MEM), the scheduler holds back with an exponential
+ * backoff, and retries as soon as a TX complete event shows that queue space was freed. The
+ * number of batches in flight is limited to @ref REPORT_SCHEDULER_INFLIGHT_MAX.
+ *
+ * The interval flushes are made at the node's @ref REPORT_PHASE offset into every interval,
+ * jittered within the phase's jitter window, so a fleet enabled by one group message does not
+ * flush in lockstep. The intervals run on a fixed grid from the start, flushes in between do not
+ * move the phase.
+ *
+ * All functions must be called from @ref NRF_MESH_IRQ_PRIORITY_LOWEST, the flush callback is
+ * called from the app_timer context at the same priority.
+ * @{
+ */
+
+/** Maximum number of published batches waiting for their TX complete event. */
+#ifndef REPORT_SCHEDULER_INFLIGHT_MAX
+#define REPORT_SCHEDULER_INFLIGHT_MAX  (2)
+#endif
+
+/**
+ * Flush callback type, publishes one batch.
+ *
+ * @param[out] p_token Access token of the published message, only used on success.
+ * @param[out] p_more  Set to @c true if there are entries left after this batch.
+ *
+ * @returns The status code of the publish, or @c NRF_ERROR_INVALID_LENGTH if there was nothing to publish.
+ */
+typedef uint32_t (*report_scheduler_flush_cb_t)(nrf_mesh_tx_token_t * p_token, bool * p_more);
+
+/** Report scheduler configuration. */
+typedef struct
+{
+    uint32_t interval_ms;                 /**< Report interval, in milliseconds. */
+    uint32_t backoff_min_ms;              /**< First retry delay after @c NRF_ERROR_NO_MEM, in milliseconds. */
+    uint32_t backoff_max_ms;              /**< Longest retry delay, in milliseconds. */
+    report_scheduler_flush_cb_t flush_cb; /**< Flush callback. */
+} report_scheduler_config_t;
+
+/** Report scheduler counters. */
+typedef struct
+{
+    uint32_t flush_count;       /**< Number of batches queued for transmission. */
+    uint32_t no_mem_count;      /**< Number of flushes that failed with @c NRF_ERROR_NO_MEM. */
+    uint32_t error_count;       /**< Number of flushes that failed with other errors. */
+    uint32_t tx_complete_count; /**< Number of TX complete events for published batches. */
+} report_scheduler_stats_t;
+
+/**
+ * Initializes the report scheduler.
+ *
+ * @param[in] p_config Scheduler configuration, copied by the scheduler.
+ */
+void report_scheduler_init(const report_scheduler_config_t * p_config);
+
+/**
+ * Starts the report intervals, and schedules the first flush at the node's publish phase.
+ *
+ * @param[in] p_phase Publish phase of the node, copied by the scheduler.
+ */
+void report_scheduler_start(const report_phase_t * p_phase);
+
+/**
+ * Stops the report interval. The scheduler ignores notifications until it is started again.
+ */
+void report_scheduler_stop(void);
+
+/**
+ * Changes the report interval. Takes effect when the scheduler is started again.
+ *
+ * @param[in] interval_ms Report interval, in milliseconds.
+ */
+void report_scheduler_interval_set(uint32_t interval_ms);
+
+/** Notifies the scheduler that a full batch is waiting. */
+void report_scheduler_batch_full(void);
+
+/**
+ * Notifies the scheduler of a TX complete event.
+ *
+ * @param[in] token Access token of the completed transmission.
+ */
+void report_scheduler_tx_complete(nrf_mesh_tx_token_t token);
+
+/**
+ * Notifies the scheduler that the receiver made room for more reports, for example by
+ * acknowledging report messages. A backoff in progress is cut short.
+ */
+void report_scheduler_resume(void);
+
+/**
+ * Gets the scheduler counters.
+ *
+ * @param[out] p_stats Counters to fill in.
+ */
+void report_scheduler_stats_get(report_scheduler_stats_t * p_stats);
+
+/** @} end of REPORT_SCHEDULER */
+
+#endif /* REPORT_SCHEDULER_H__ */
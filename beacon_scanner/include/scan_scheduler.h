@@ -0,0 +1,148 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SCAN_SCHEDULER_H__
+#define SCAN_SCHEDULER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup SCAN_SCHEDULER Scan scheduler
+ *
+ * Shares the scanner's time between mesh traffic and eartag capture.
+ *
+ * The mesh bearer owns the only scanner, and eartag advertisements come in through the same
+ * RX path as mesh packets. The scheduler splits every scan period into a mesh slot and a capture
+ * slot, and sets the bearer scan interval and window at every switch:
+ * - In the mesh slot, the scanner runs with the mesh timing, and eartag ingestion is paused.
+ * - In the capture slot, the scanner runs with the capture timing set by the gateway, and eartag
+ *   advertisements are aggregated.
+ *
+ * The mesh share of the period is configurable, and is raised to the DFU share while a DFU
+ * transfer is active. While the scheduler is disabled, the scanner keeps the mesh timing.
+ *
+ * The scheduler owns the bearer scan timing, nothing else may call scanner_config_scan_time_set().
+ *
+ * The time spent in each slot is counted, so the share can be sized per site.
+ *
+ * All functions must be called from @ref NRF_MESH_IRQ_PRIORITY_LOWEST, the slot timer runs in
+ * the app_timer context at the same priority.
+ * @{
+ */
+
+/** Scan scheduler slot. */
+typedef enum
+{
+    SCAN_SCHEDULER_MODE_MESH,    /**< Eartag ingestion paused. */
+    SCAN_SCHEDULER_MODE_CAPTURE  /**< Eartag advertisements are aggregated. */
+} scan_scheduler_mode_t;
+
+/** Scan scheduler configuration. */
+typedef struct
+{
+    uint32_t period_ms;                /**< Length of one mesh slot plus one capture slot, in milliseconds. */
+    uint8_t mesh_share;                /**< Share of the period given to the mesh slot, in percent. */
+    uint8_t dfu_mesh_share;            /**< Share of the period given to the mesh slot during a DFU transfer, in percent. */
+    uint16_t mesh_scan_interval_ms;    /**< Bearer scan interval in the mesh slot, in milliseconds. */
+    uint16_t mesh_scan_window_ms;      /**< Bearer scan window in the mesh slot, in milliseconds. */
+    uint16_t capture_scan_interval_ms; /**< Bearer scan interval in the capture slot, in milliseconds. */
+    uint16_t capture_scan_window_ms;   /**< Bearer scan window in the capture slot, in milliseconds. */
+} scan_scheduler_config_t;
+
+/** Scan scheduler counters. Only time while the scheduler is enabled is counted. */
+typedef struct
+{
+    uint32_t mesh_ms;      /**< Time spent in the mesh slot, in milliseconds. */
+    uint32_t capture_ms;   /**< Time spent in the capture slot, in milliseconds. */
+    uint32_t dfu_ms;       /**< Time spent with a DFU transfer active, in milliseconds. */
+    uint32_t switch_count; /**< Number of slot switches. */
+} scan_scheduler_stats_t;
+
+/**
+ * Initializes the scan scheduler. The scheduler starts disabled.
+ *
+ * @param[in] p_config Scheduler configuration, copied by the scheduler.
+ */
+void scan_scheduler_init(const scan_scheduler_config_t * p_config);
+
+/**
+ * Enables or disables eartag capture. When disabled, the whole period is left to the mesh.
+ *
+ * @param[in] enable Set to @c true to start alternating slots.
+ */
+void scan_scheduler_enable(bool enable);
+
+/**
+ * Changes the mesh share of the scan period. Takes effect from the next slot.
+ *
+ * @param[in] mesh_share Share of the period given to the mesh slot, in percent.
+ */
+void scan_scheduler_mesh_share_set(uint8_t mesh_share);
+
+/**
+ * Changes the bearer scan timing of the capture slot. Takes effect at once in the capture slot.
+ *
+ * @param[in] interval_ms Scan interval, in milliseconds.
+ * @param[in] window_ms   Scan window, in milliseconds, at most @p interval_ms.
+ */
+void scan_scheduler_capture_scan_time_set(uint16_t interval_ms, uint16_t window_ms);
+
+/**
+ * Notifies the scheduler of the start or end of a DFU transfer.
+ *
+ * @param[in] active Set to @c true while a DFU transfer is active.
+ */
+void scan_scheduler_dfu_active_set(bool active);
+
+/**
+ * Gets the current slot.
+ *
+ * @returns The current slot.
+ */
+scan_scheduler_mode_t scan_scheduler_mode_get(void);
+
+/**
+ * Gets the scheduler counters.
+ *
+ * @param[out] p_stats Counters to fill in.
+ */
+void scan_scheduler_stats_get(scan_scheduler_stats_t * p_stats);
+
+/** @} end of SCAN_SCHEDULER */
+
+#endif /* SCAN_SCHEDULER_H__ */
@@ -0,0 +1,160 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIGHTING_TABLE_H__
+#define SIGHTING_TABLE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "eartag_adv.h"
+
+/**
+ * @defgroup SIGHTING_TABLE Sighting table
+ *
+ * Statically allocated open-addressing hash table aggregating repeated sightings of the same eartag.
+ *
+ * The table is keyed by the eartag address and uses linear probing limited to
+ * @ref SIGHTING_TABLE_PROBE_MAX slots, so both inserts and evictions have a bounded cost. When no
+ * slot is available within the probe window, the entry in the window that was seen least recently
+ * is evicted.
+ *
+ * The table is not thread safe. All calls must be made from the same interrupt priority.
+ * The module has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Base two logarithm of the number of slots in the table. */
+#ifndef SIGHTING_TABLE_SIZE_LOG2
+#define SIGHTING_TABLE_SIZE_LOG2     (7)
+#endif
+
+/** Number of slots in the table. */
+#define SIGHTING_TABLE_SIZE          (1u << SIGHTING_TABLE_SIZE_LOG2)
+
+/** Maximum number of slots probed for a single key. */
+#ifndef SIGHTING_TABLE_PROBE_MAX
+#define SIGHTING_TABLE_PROBE_MAX     (8)
+#endif
+
+/** Aggregated sightings of one eartag. */
+typedef struct
+{
+    uint8_t  addr[EARTAG_ADDR_LEN]; /**< Advertiser address of the eartag, little endian. */
+    uint16_t count;                 /**< Number of sightings, saturating. */
+    int8_t   rssi_min;              /**< Lowest RSSI seen, in dBm. */
+    int8_t   rssi_max;              /**< Highest RSSI seen, in dBm. */
+    uint8_t  state;                 /**< Slot state, internal to the table. */
+    int8_t   tx_power;              /**< Last calibrated TX power reported by the eartag. */
+    uint16_t major;                 /**< Last major identifier reported by the eartag. */
+    uint16_t minor;                 /**< Last minor identifier reported by the eartag. */
+    int32_t  rssi_sum;              /**< Sum of the RSSI of all sightings, in dBm. */
+    uint32_t first_timestamp;       /**< Time of the first sighting, in milliseconds. */
+    uint32_t last_timestamp;        /**< Time of the last sighting, in milliseconds. */
+} sighting_entry_t;
+
+/** Sighting table. */
+typedef struct
+{
+    sighting_entry_t entries[SIGHTING_TABLE_SIZE]; /**< Table slots. */
+    uint32_t count;                                /**< Number of entries in the table. */
+    uint32_t drain_cursor;                         /**< Slot the next drain starts from. */
+    uint32_t evict_count;                          /**< Number of entries evicted since init. */
+} sighting_table_t;
+
+/**
+ * Initializes an empty sighting table.
+ *
+ * @param[out] p_table Table to initialize.
+ */
+void sighting_table_init(sighting_table_t * p_table);
+
+/**
+ * Adds a sighting to the table.
+ *
+ * @param[in,out] p_table    Table to add the sighting to.
+ * @param[in]     p_sighting Sighting to add.
+ * @param[out]    p_evicted  Filled with the evicted entry if the table had to evict one, may be NULL.
+ *
+ * @returns @c true if an entry was evicted to make room for the sighting.
+ */
+bool sighting_table_insert(sighting_table_t * p_table,
+                           const eartag_sighting_t * p_sighting,
+                           sighting_entry_t * p_evicted);
+
+/**
+ * Merges an aggregated entry into the table, e.g. to put back an entry that could not be reported.
+ *
+ * @param[in,out] p_table   Table to merge the entry into.
+ * @param[in]     p_entry   Entry to merge.
+ * @param[out]    p_evicted Filled with the evicted entry if the table had to evict one, may be NULL.
+ *
+ * @returns @c true if an entry was evicted to make room for the merged entry.
+ */
+bool sighting_table_merge(sighting_table_t * p_table,
+                          const sighting_entry_t * p_entry,
+                          sighting_entry_t * p_evicted);
+
+/**
+ * Removes up to @p max_count entries from the table.
+ *
+ * Consecutive calls continue where the previous call stopped, so a table can be drained in
+ * several steps while new sightings keep arriving.
+ *
+ * @param[in,out] p_table   Table to drain.
+ * @param[out]    p_entries Array receiving the removed entries.
+ * @param[in]     max_count Size of the @p p_entries array.
+ *
+ * @returns Number of entries removed.
+ */
+uint32_t sighting_table_drain(sighting_table_t * p_table, sighting_entry_t * p_entries, uint32_t max_count);
+
+/**
+ * Gets the number of entries in the table.
+ *
+ * @param[in] p_table Table to query.
+ *
+ * @returns Number of entries.
+ */
+static inline uint32_t sighting_table_count(const sighting_table_t * p_table)
+{
+    return p_table->count;
+}
+
+/** @} end of SIGHTING_TABLE */
+
+#endif /* SIGHTING_TABLE_H__ */
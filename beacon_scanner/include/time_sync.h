@@ -0,0 +1,140 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TIME_SYNC_H__
+#define TIME_SYNC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup TIME_SYNC Time synchronization
+ *
+ * Estimates the mesh-wide network time from the time beacons the gateway publishes, so sightings
+ * from different scanners can be put on one time line.
+ *
+ * The network time is a 32-bit millisecond count from an epoch chosen by the gateway. It wraps
+ * after 49.7 days, which the gateway resolves against its own clock.
+ *
+ * Every beacon is a sample of the network time, taken when the gateway sent it. The time spent in
+ * relays is estimated from the number of hops, and added to the sample. The remaining delay is
+ * random and never negative, so the sample with the least delay is the most accurate one: out of
+ * every window of @ref TIME_SYNC_WINDOW samples, only the one with the highest offset between the
+ * network time and the local clock is kept. The kept sample becomes the reference point of the
+ * estimate, and the drift of the local clock is measured between the kept samples of consecutive
+ * windows, and smoothed.
+ *
+ * A sample too far from the estimate is dropped as an outlier, unless several in a row disagree,
+ * in which case the network time has stepped and the tracker starts over from the last sample.
+ *
+ * The tracker is not thread safe. All calls must be made from the same interrupt priority.
+ * The module has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Error beyond which a sample is an outlier, in milliseconds. */
+#ifndef TIME_SYNC_OUTLIER_MS
+#define TIME_SYNC_OUTLIER_MS        (500)
+#endif
+
+/** Number of outliers in a row that make the tracker step to the network time. */
+#ifndef TIME_SYNC_OUTLIERS_STEP
+#define TIME_SYNC_OUTLIERS_STEP     (3)
+#endif
+
+/** Number of samples out of which the one with the least delay is kept. */
+#ifndef TIME_SYNC_WINDOW
+#define TIME_SYNC_WINDOW            (8)
+#endif
+
+/** Largest drift accepted between the local clock and the network time, in parts per billion. */
+#ifndef TIME_SYNC_DRIFT_MAX_PPB
+#define TIME_SYNC_DRIFT_MAX_PPB     (250000)
+#endif
+
+/** Time sync tracker. */
+typedef struct
+{
+    bool     synced;           /**< At least one sample has been taken. */
+    uint32_t local_ref;        /**< Local time of the reference point, in milliseconds. */
+    uint32_t network_ref;      /**< Network time of the reference point, in milliseconds. */
+    int32_t  drift_ppb;        /**< Drift of the network time against the local clock, in parts per billion. */
+    uint32_t window_count;     /**< Number of samples in the current window. */
+    uint32_t window_local;     /**< Local time of the best sample of the current window, in milliseconds. */
+    uint32_t window_offset;    /**< Offset from local to network time of the best sample of the current window. */
+    bool     prev_valid;       /**< A previous window is available for the drift measurement. */
+    uint32_t prev_local;       /**< Local time of the best sample of the previous window, in milliseconds. */
+    uint32_t prev_offset;      /**< Offset from local to network time of the best sample of the previous window. */
+    uint32_t outlier_run;      /**< Number of outliers in a row. */
+    int32_t  last_error_ms;    /**< Error of the last sample, in milliseconds. */
+    uint32_t sample_count;     /**< Number of samples taken. */
+    uint32_t outlier_count;    /**< Number of samples dropped as outliers. */
+    uint32_t step_count;       /**< Number of times the tracker stepped to the network time. */
+} time_sync_t;
+
+/**
+ * Initializes a tracker with no time reference.
+ *
+ * @param[out] p_sync Tracker to initialize.
+ */
+void time_sync_init(time_sync_t * p_sync);
+
+/**
+ * Adds a time beacon sample.
+ *
+ * @param[in,out] p_sync       Tracker.
+ * @param[in]     local_ms     Local time the beacon was received, in milliseconds.
+ * @param[in]     network_ms   Network time the beacon was sent, in milliseconds.
+ * @param[in]     hops         Number of relays the beacon went through.
+ * @param[in]     hop_delay_ms Average delay of one relay, in milliseconds.
+ */
+void time_sync_sample_add(time_sync_t * p_sync, uint32_t local_ms, uint32_t network_ms, uint32_t hops, uint32_t hop_delay_ms);
+
+/**
+ * Converts a local time to network time.
+ *
+ * @param[in]  p_sync       Tracker.
+ * @param[in]  local_ms     Local time, in milliseconds.
+ * @param[out] p_network_ms Network time, in milliseconds.
+ *
+ * @returns @c true if the tracker has a time reference, @c false if @p p_network_ms was not set.
+ */
+bool time_sync_network_time_get(const time_sync_t * p_sync, uint32_t local_ms, uint32_t * p_network_ms);
+
+/** @} end of TIME_SYNC */
+
+#endif /* TIME_SYNC_H__ */
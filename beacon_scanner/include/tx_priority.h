@@ -0,0 +1,150 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TX_PRIORITY_H__
+#define TX_PRIORITY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh.h"
+
+/**
+ * @defgroup TX_PRIORITY TX priority scheduler
+ *
+ * Orders the messages the scanner publishes by traffic class.
+ *
+ * Each class is a queue kept by its owner, which tells the scheduler how many messages are
+ * waiting and sends the next one on request. On every flush the scheduler sends from the highest
+ * class with messages waiting: control messages first, then live reports, then the flash backlog.
+ * A class that fails with @c NRF_ERROR_NO_MEM holds back the classes below it, so reports never
+ * get ahead of a control message waiting for room in the TX queue.
+ *
+ * The scheduler keeps the queue depth and the time waited by the sent messages of every class.
+ *
+ * All functions must be called from @ref NRF_MESH_IRQ_PRIORITY_LOWEST.
+ * @{
+ */
+
+/** Time waited is unknown, for a message that is not counted in the latency. */
+#define TX_PRIORITY_WAIT_UNKNOWN    (UINT32_MAX)
+
+/** Traffic classes, highest priority first. */
+typedef enum
+{
+    TX_PRIORITY_CLASS_CONTROL, /**< State publications answering control messages. */
+    TX_PRIORITY_CLASS_REPORT,  /**< Live reports and their retransmissions. */
+    TX_PRIORITY_CLASS_BACKLOG, /**< Reports replayed from the flash backlog. */
+    TX_PRIORITY_CLASS_COUNT    /**< Number of classes. */
+} tx_priority_class_t;
+
+/**
+ * Depth callback type.
+ *
+ * @returns Number of messages waiting in the class.
+ */
+typedef uint32_t (*tx_priority_depth_cb_t)(void);
+
+/**
+ * Send callback type, sends the next message of the class.
+ *
+ * @param[out] p_token   Access token of the sent message, only used on success.
+ * @param[out] p_wait_ms Time the sent message waited in the queue, in milliseconds, or
+ *                       @ref TX_PRIORITY_WAIT_UNKNOWN. Only used on success.
+ *
+ * @returns The status code of the publish, or @c NRF_ERROR_INVALID_LENGTH if there was nothing to send.
+ */
+typedef uint32_t (*tx_priority_send_cb_t)(nrf_mesh_tx_token_t * p_token, uint32_t * p_wait_ms);
+
+/** Traffic class configuration. */
+typedef struct
+{
+    tx_priority_depth_cb_t depth_cb; /**< Depth callback. */
+    tx_priority_send_cb_t send_cb;   /**< Send callback. */
+} tx_priority_class_config_t;
+
+/** Traffic class counters. */
+typedef struct
+{
+    uint32_t depth;        /**< Number of messages waiting at the last flush. */
+    uint32_t depth_max;    /**< Highest number of messages waiting at a flush. */
+    uint32_t sent_count;   /**< Number of messages sent. */
+    uint32_t wait_samples; /**< Number of sent messages with a known time waited. */
+    uint32_t wait_ms;      /**< Time waited by the last sent message, in milliseconds. */
+    uint32_t wait_avg_ms;  /**< Moving average of the time waited, in milliseconds. */
+    uint32_t wait_max_ms;  /**< Longest time waited, in milliseconds. */
+} tx_priority_stats_t;
+
+/**
+ * Initializes the scheduler.
+ *
+ * @param[in] p_classes Configuration of every class, indexed by @ref tx_priority_class_t, copied
+ *                      by the scheduler.
+ */
+void tx_priority_init(const tx_priority_class_config_t * p_classes);
+
+/**
+ * Sends the next message, from the highest class with messages waiting. Has the signature of a
+ * @ref report_scheduler_flush_cb_t.
+ *
+ * @param[out] p_token Access token of the sent message, only used on success.
+ * @param[out] p_more  Set to @c true if messages are left in any class.
+ *
+ * @returns The status code of the publish, or @c NRF_ERROR_INVALID_LENGTH if all classes are empty.
+ */
+uint32_t tx_priority_flush(nrf_mesh_tx_token_t * p_token, bool * p_more);
+
+/**
+ * Sends all waiting control messages, without waiting for the next flush. Call when room is
+ * freed in the TX queue.
+ *
+ * @returns The status code of the last publish, or @c NRF_ERROR_INVALID_LENGTH if no control
+ *          message was waiting.
+ */
+uint32_t tx_priority_control_flush(void);
+
+/**
+ * Gets the counters of a class.
+ *
+ * @param[in]  traffic_class Class, @ref tx_priority_class_t.
+ * @param[out] p_stats       Counters to fill in.
+ */
+void tx_priority_stats_get(tx_priority_class_t traffic_class, tx_priority_stats_t * p_stats);
+
+/** @} end of TX_PRIORITY */
+
+#endif /* TX_PRIORITY_H__ */
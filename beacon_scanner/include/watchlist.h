@@ -0,0 +1,193 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WATCHLIST_H__
+#define WATCHLIST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "eartag_adv.h"
+
+/**
+ * @defgroup WATCHLIST Tag watchlist
+ *
+ * Set of eartags the gateway is interested in, used to drop other sightings before aggregation.
+ *
+ * The watchlist is either a Bloom filter or a sorted array of eartag addresses:
+ * - Bloom filter: a bit array of @c length * 8 bits. An address is in the set when the bits
+ *   <tt>(h1 + i * h2) % (length * 8)</tt>, for @c i from 0 to <tt>hash_count - 1</tt>, are all set,
+ *   where @c h1 and @c h2 are given by @ref watchlist_addr_hash. Bit @c n is bit <tt>n % 8</tt> of
+ *   byte <tt>n / 8</tt>.
+ * - Sorted set: little endian 6-byte addresses, in increasing order of their 48-bit value.
+ *
+ * A new watchlist is received in chunks into a staging buffer while the active watchlist is still
+ * in use. When the last chunk is in and the watchlist is valid, the staging buffer becomes the
+ * active one with a single pointer store, so scanning never pauses.
+ *
+ * The watchlist is not thread safe. All calls must be made from the same interrupt priority.
+ * The module has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Largest watchlist, in bytes. */
+#ifndef WATCHLIST_SIZE_MAX
+#define WATCHLIST_SIZE_MAX           (1024)
+#endif
+
+/** Largest number of hash functions of a Bloom filter. */
+#define WATCHLIST_HASH_COUNT_MAX     (16)
+
+/** Watchlist formats. */
+typedef enum
+{
+    WATCHLIST_FORMAT_BLOOM = 0,  /**< Bloom filter. */
+    WATCHLIST_FORMAT_SORTED = 1  /**< Sorted array of addresses. */
+} watchlist_format_t;
+
+/** Result of adding a chunk. */
+typedef enum
+{
+    WATCHLIST_STATUS_IN_PROGRESS = 0,  /**< Chunk accepted, more chunks are expected. */
+    WATCHLIST_STATUS_COMPLETE = 1,     /**< The watchlist is complete and active. */
+    WATCHLIST_STATUS_OUT_OF_ORDER = 2, /**< Chunk not at the expected offset, resend from the received length. */
+    WATCHLIST_STATUS_TOO_LARGE = 3,    /**< The watchlist does not fit in @ref WATCHLIST_SIZE_MAX. */
+    WATCHLIST_STATUS_INVALID = 4       /**< The complete watchlist is malformed, and was discarded. */
+} watchlist_status_t;
+
+/** One watchlist buffer. */
+typedef struct
+{
+    uint8_t  data[WATCHLIST_SIZE_MAX]; /**< Bloom filter bits or sorted addresses. */
+    uint16_t length;                   /**< Length of the watchlist, in bytes. */
+    uint8_t  format;                   /**< Watchlist format, @ref watchlist_format_t. */
+    uint8_t  hash_count;               /**< Number of hash functions of a Bloom filter. */
+    uint8_t  transfer_id;              /**< Transfer the watchlist was received in. */
+} watchlist_filter_t;
+
+/** Watchlist with its staging buffer. */
+typedef struct
+{
+    watchlist_filter_t filters[2];        /**< Active and staging buffers. */
+    const watchlist_filter_t * p_active;  /**< Active watchlist, NULL if there is none. */
+    watchlist_filter_t * p_staging;       /**< Buffer receiving the next watchlist. */
+    uint16_t received;                    /**< Number of bytes received into the staging buffer. */
+    bool     receiving;                   /**< A transfer into the staging buffer is in progress. */
+} watchlist_t;
+
+/**
+ * Initializes a watchlist with no active list.
+ *
+ * @param[out] p_watchlist Watchlist to initialize.
+ */
+void watchlist_init(watchlist_t * p_watchlist);
+
+/**
+ * Adds a chunk of a watchlist transfer.
+ *
+ * A chunk at offset 0 starts a new transfer, aborting any transfer in progress. Chunks that were
+ * already received are acknowledged again, so lost acknowledgements can be retried.
+ *
+ * @param[in,out] p_watchlist  Watchlist.
+ * @param[in]     transfer_id  Identifier of the transfer, the same for all its chunks.
+ * @param[in]     format       Watchlist format, @ref watchlist_format_t.
+ * @param[in]     hash_count   Number of hash functions of a Bloom filter, ignored for other formats.
+ * @param[in]     total_length Length of the complete watchlist, in bytes.
+ * @param[in]     offset       Offset of the chunk in the watchlist.
+ * @param[in]     p_data       Chunk data.
+ * @param[in]     length       Length of the chunk data.
+ *
+ * @returns The status of the transfer.
+ */
+watchlist_status_t watchlist_chunk_add(watchlist_t * p_watchlist,
+                                       uint8_t transfer_id,
+                                       uint8_t format,
+                                       uint8_t hash_count,
+                                       uint16_t total_length,
+                                       uint16_t offset,
+                                       const uint8_t * p_data,
+                                       uint16_t length);
+
+/**
+ * Gets the number of bytes received in the current transfer.
+ *
+ * @param[in] p_watchlist Watchlist.
+ *
+ * @returns The offset the next chunk is expected at.
+ */
+static inline uint16_t watchlist_received_get(const watchlist_t * p_watchlist)
+{
+    return p_watchlist->received;
+}
+
+/**
+ * Removes the active watchlist.
+ *
+ * @param[in,out] p_watchlist Watchlist.
+ */
+void watchlist_clear(watchlist_t * p_watchlist);
+
+/**
+ * Checks an eartag against the active watchlist.
+ *
+ * Bloom filters may match eartags that are not in the set, but never miss one that is.
+ *
+ * @param[in] p_watchlist Watchlist.
+ * @param[in] p_addr      Advertiser address of the eartag.
+ *
+ * @returns @c true if the eartag is in the watchlist, or if there is no active watchlist.
+ */
+bool watchlist_match(const watchlist_t * p_watchlist, const uint8_t * p_addr);
+
+/**
+ * Gets the two base hashes of an address used by the Bloom filter.
+ *
+ * With @c low the first four address bytes and @c high the last two, as little endian integers:
+ * - <tt>h1 = (low ^ (high * 0x9E37)) * 0x9E3779B1</tt>
+ * - <tt>h2 = ((low * 0x85EBCA6B) ^ (high * 0xC2B2)) * 0x27D4EB2F | 1</tt>
+ *
+ * all in 32-bit unsigned arithmetic.
+ *
+ * @param[in]  p_addr Advertiser address of the eartag.
+ * @param[out] p_h1   First hash.
+ * @param[out] p_h2   Second hash, always odd.
+ */
+void watchlist_addr_hash(const uint8_t * p_addr, uint32_t * p_h1, uint32_t * p_h2);
+
+/** @} end of WATCHLIST */
+
+#endif /* WATCHLIST_H__ */
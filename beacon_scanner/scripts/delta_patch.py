@@ -0,0 +1,298 @@
+#!/usr/bin/env python3
+# Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+#    list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form, except as embedded into a Nordic
+#    Semiconductor ASA integrated circuit in a product or a software update for
+#    such product, must reproduce the above copyright notice, this list of
+#    conditions and the following disclaimer in the documentation and/or other
+#    materials provided with the distribution.
+#
+# 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+#    contributors may be used to endorse or promote products derived from this
+#    software without specific prior written permission.
+#
+# 4. This software, with or without modification, must only be used with a
+#    Nordic Semiconductor ASA integrated circuit.
+#
+# 5. Any software provided in binary form under this license must not be reverse
+#    engineered, decompiled, modified and/or disassembled.
+#
+# THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+# OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+# OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+# GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+# HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+# OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Estimates what delta patches would save on beacon scanner application transfers.
+
+The scanner has no delta DFU mode: the mesh DFU bootloader copies the bank into the
+application as is, so only full images can be installed. This tool sizes the patch between
+two builds, to tell whether a bootloader that applies patches is worth having. The inputs are
+the application hex files of two builds, the image is every byte from the lowest to the
+highest address, with gaps filled with 0xFF as in erased flash.
+
+    delta_patch.py make old.hex new.hex -o patch.bin
+    delta_patch.py apply old.hex patch.bin -o new.bin
+    delta_patch.py bench old1.hex new1.hex [old2.hex new2.hex ...]
+
+A patch is a header (magic "DPT1", then the length and zlib CRC-32 of the base image and of
+the new image, little endian 32-bit words), followed by operations. Every operation starts
+with the varint (length << 1) | kind. A copy (kind 0) is followed by the zigzag varint of the
+distance from the output offset to the source offset in the base image, so code that only
+moved encodes in a byte or two. An insert (kind 1) is followed by length literal bytes.
+Varints are unsigned LEB128, and the patch ends when the output reaches the new length.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = 0x31545044
+HEADER = struct.Struct("<IIIII")
+OP_COPY = 0
+OP_INSERT = 1
+
+# Shortest match worth a copy, a copy costs two to five bytes.
+MATCH_MIN = 8
+# Candidate positions kept per key, the most recent ones.
+CANDIDATES_MAX = 32
+# Payload of one mesh DFU data segment.
+DFU_SEGMENT_SIZE = 16
+
+
+def hex_read(path):
+    """Reads an Intel HEX file, returns (start address, image bytes)."""
+    data = {}
+    base = 0
+    with open(path) as f:
+        for line_number, line in enumerate(f, 1):
+            line = line.strip()
+            if not line:
+                continue
+            if not line.startswith(":"):
+                raise ValueError("%s:%d: not an Intel HEX record" % (path, line_number))
+            record = bytes.fromhex(line[1:])
+            if sum(record) & 0xFF:
+                raise ValueError("%s:%d: bad checksum" % (path, line_number))
+            length, address, record_type = record[0], (record[1] << 8) | record[2], record[3]
+            payload = record[4:4 + length]
+            if record_type == 0x00:
+                for i, byte in enumerate(payload):
+                    data[base + address + i] = byte
+            elif record_type == 0x01:
+                break
+            elif record_type == 0x02:
+                base = ((payload[0] << 8) | payload[1]) << 4
+            elif record_type == 0x04:
+                base = ((payload[0] << 8) | payload[1]) << 16
+    if not data:
+        raise ValueError("%s: no data" % path)
+    start, end = min(data), max(data) + 1
+    image = bytearray(b"\xff" * (end - start))
+    for address, byte in data.items():
+        image[address - start] = byte
+    return start, bytes(image)
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def diff(base, new):
+    """Returns the operations that rebuild new from base, as (kind, length, distance or literal)."""
+    index = {}
+    for i in range(len(base) - MATCH_MIN + 1):
+        positions = index.setdefault(base[i:i + MATCH_MIN], [])
+        if len(positions) == CANDIDATES_MAX:
+            positions.pop(0)
+        positions.append(i)
+
+    ops = []
+    literal_start = 0
+    distance = 0
+    i = 0
+    while i <= len(new) - MATCH_MIN:
+        best_length, best_source = 0, 0
+        candidates = index.get(new[i:i + MATCH_MIN], [])
+        # The distance of the previous copy first, code that moved keeps moving together.
+        if 0 <= i + distance < len(base):
+            candidates = [i + distance] + candidates
+        for source in candidates:
+            length = 0
+            while (i + length < len(new) and source + length < len(base) and
+                   new[i + length] == base[source + length]):
+                length += 1
+            if length > best_length:
+                best_length, best_source = length, source
+        if best_length < MATCH_MIN:
+            i += 1
+            continue
+        # Grow the match back into the pending literals.
+        while i > literal_start and best_source > 0 and new[i - 1] == base[best_source - 1]:
+            i -= 1
+            best_source -= 1
+            best_length += 1
+        if i > literal_start:
+            ops.append((OP_INSERT, i - literal_start, new[literal_start:i]))
+        distance = best_source - i
+        ops.append((OP_COPY, best_length, distance))
+        i += best_length
+        literal_start = i
+    if literal_start < len(new):
+        ops.append((OP_INSERT, len(new) - literal_start, new[literal_start:]))
+    return ops
+
+
+def patch_make(base, new):
+    out = bytearray(HEADER.pack(MAGIC, len(base), zlib.crc32(base), len(new), zlib.crc32(new)))
+    for kind, length, arg in diff(base, new):
+        out += varint((length << 1) | kind)
+        out += varint(zigzag(arg)) if kind == OP_COPY else arg
+    return bytes(out)
+
+
+def patch_apply(base, patch):
+    """Rebuilds the new image, raises ValueError on a bad patch."""
+    magic, base_length, base_crc, new_length, new_crc = HEADER.unpack_from(patch)
+    if magic != MAGIC:
+        raise ValueError("not a delta patch")
+    if base_length > len(base) or zlib.crc32(base[:base_length]) != base_crc:
+        raise ValueError("patch made for another base image")
+
+    def varint_read(offset):
+        value, shift = 0, 0
+        while True:
+            byte = patch[offset]
+            offset += 1
+            value |= (byte & 0x7F) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value, offset
+
+    out = bytearray()
+    offset = HEADER.size
+    while len(out) < new_length:
+        word, offset = varint_read(offset)
+        length = word >> 1
+        if length == 0 or len(out) + length > new_length:
+            raise ValueError("bad operation at patch offset %d" % offset)
+        if word & 1 == OP_COPY:
+            value, offset = varint_read(offset)
+            source = len(out) + ((value >> 1) ^ -(value & 1))
+            if source < 0 or source + length > base_length:
+                raise ValueError("copy outside the base image at patch offset %d" % offset)
+            out += base[source:source + length]
+        else:
+            out += patch[offset:offset + length]
+            offset += length
+    if offset != len(patch) or zlib.crc32(out) != new_crc:
+        raise ValueError("patch does not rebuild the new image")
+    return bytes(out)
+
+
+def transfer_time(length, interval_ms):
+    segments = (length + DFU_SEGMENT_SIZE - 1) // DFU_SEGMENT_SIZE
+    return segments, segments * interval_ms / 1000.0
+
+
+def images_read(old_path, new_path):
+    old_start, old = hex_read(old_path)
+    new_start, new = hex_read(new_path)
+    if old_start != new_start:
+        raise ValueError("the images start at different addresses, 0x%X and 0x%X" % (old_start, new_start))
+    return new_start, old, new
+
+
+def cmd_make(args):
+    _, old, new = images_read(args.old, args.new)
+    patch = patch_make(old, new)
+    patch_apply(old, patch)
+    with open(args.output, "wb") as f:
+        f.write(patch)
+    print("%d byte image, %d byte patch (%.1f%%)" % (len(new), len(patch), 100.0 * len(patch) / len(new)))
+
+
+def cmd_apply(args):
+    _, old = hex_read(args.old)
+    with open(args.patch, "rb") as f:
+        patch = f.read()
+    new = patch_apply(old, patch)
+    with open(args.output, "wb") as f:
+        f.write(new)
+    print("%d byte image rebuilt" % len(new))
+
+
+def cmd_bench(args):
+    if len(args.images) % 2:
+        raise ValueError("bench takes pairs of old and new hex files")
+    print("%-40s %8s %8s %6s %9s %9s %8s" % ("pair", "image", "patch", "ratio", "full s", "delta s", "saved s"))
+    for old_path, new_path in zip(args.images[0::2], args.images[1::2]):
+        _, old, new = images_read(old_path, new_path)
+        patch = patch_make(old, new)
+        patch_apply(old, patch)
+        _, full_s = transfer_time(len(new), args.segment_interval_ms)
+        _, delta_s = transfer_time(len(patch), args.segment_interval_ms)
+        name = "%s -> %s" % (old_path, new_path)
+        print("%-40s %8d %8d %5.1f%% %9.1f %9.1f %8.1f" % (name[-40:], len(new), len(patch),
+                                                           100.0 * len(patch) / len(new),
+                                                           full_s, delta_s, full_s - delta_s))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command")
+    commands.required = True
+
+    make = commands.add_parser("make", help="make a patch from two application hex files")
+    make.add_argument("old", help="hex file of the running application")
+    make.add_argument("new", help="hex file of the new application")
+    make.add_argument("-o", "--output", required=True, help="raw patch file")
+    make.set_defaults(func=cmd_make)
+
+    apply = commands.add_parser("apply", help="rebuild the new image from the old one and a patch")
+    apply.add_argument("old", help="hex file of the running application")
+    apply.add_argument("patch", help="raw patch file")
+    apply.add_argument("-o", "--output", required=True, help="raw image file")
+    apply.set_defaults(func=cmd_apply)
+
+    bench = commands.add_parser("bench", help="report patch sizes and transfer times of build pairs")
+    bench.add_argument("images", nargs="+", help="old and new hex files, in pairs")
+    bench.add_argument("--segment-interval-ms", type=float, default=200.0,
+                       help="time between two data segments, the nrfutil -i option (default: %(default)s)")
+    bench.set_defaults(func=cmd_bench)
+
+    args = parser.parse_args()
+    try:
+        args.func(args)
+    except (IOError, ValueError) as e:
+        print("error: %s" % e, file=sys.stderr)
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
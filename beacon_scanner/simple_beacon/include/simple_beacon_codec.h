@@ -0,0 +1,119 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIMPLE_BEACON_CODEC_H__
+#define SIMPLE_BEACON_CODEC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup SIMPLE_BEACON_CODEC Simple Beacon report codec
+ * @ingroup SIMPLE_BEACON_MODEL
+ * Compact encoding of the sighting entries in a Simple Beacon Report Batch message.
+ *
+ * Every entry is encoded as:
+ * - the difference to the previous entry's address, as a zigzag encoded varint,
+ * - the sighting count minus one, as a varint,
+ * - one byte with the average RSSI bucket in the high nibble and the highest RSSI bucket in the low nibble,
+ * - the age relative to the batch base time, in 100 ms units, as a varint.
+ *
+ * Entries sorted by address give the smallest deltas. The codec has no SDK dependencies, so the
+ * same source can be used by the server and by the gateway side, and built for the host.
+ * @{
+ */
+
+/** Length of an eartag address. */
+#define SIMPLE_BEACON_CODEC_ADDR_LEN        (6)
+
+/** Largest possible encoded size of one entry. */
+#define SIMPLE_BEACON_CODEC_ENTRY_SIZE_MAX  (7 + 3 + 1 + 3)
+
+/** Smallest possible encoded size of one entry. */
+#define SIMPLE_BEACON_CODEC_ENTRY_SIZE_MIN  (4)
+
+/** RSSI of the lowest bucket, in dBm. Lower values are clamped to it. */
+#define SIMPLE_BEACON_CODEC_RSSI_FLOOR      (-100)
+
+/** Width of an RSSI bucket, in dB. */
+#define SIMPLE_BEACON_CODEC_RSSI_STEP       (5)
+
+/** Sighting entry carried in a Simple Beacon Report Batch message. */
+typedef struct
+{
+    uint8_t  addr[SIMPLE_BEACON_CODEC_ADDR_LEN]; /**< Advertiser address of the eartag, little endian. */
+    uint16_t count;    /**< Number of sightings since the previous report, at least one. */
+    int8_t   rssi_avg; /**< Average RSSI, in dBm. Quantized by the encoding. */
+    int8_t   rssi_max; /**< Highest RSSI seen, in dBm. Quantized by the encoding. */
+    uint16_t age;      /**< Time since the last sighting relative to the batch base time, in 100 ms units. */
+} simple_beacon_report_entry_t;
+
+/**
+ * Encodes as many entries as fit in a buffer.
+ *
+ * @param[in]  p_entries Entries to encode, preferably sorted by address.
+ * @param[in]  count     Number of entries.
+ * @param[out] p_buffer  Buffer to encode into.
+ * @param[in]  size      Size of the buffer.
+ * @param[out] p_length  Number of bytes written to the buffer.
+ *
+ * @returns Number of entries encoded, starting from the first one.
+ */
+uint32_t simple_beacon_codec_encode(const simple_beacon_report_entry_t * p_entries,
+                                    uint32_t count,
+                                    uint8_t * p_buffer,
+                                    uint32_t size,
+                                    uint32_t * p_length);
+
+/**
+ * Decodes a known number of entries.
+ *
+ * @param[in]  p_buffer  Encoded entries.
+ * @param[in]  length    Length of the encoded entries.
+ * @param[out] p_entries Array receiving the decoded entries.
+ * @param[in]  count     Number of entries to decode.
+ *
+ * @returns @c true if exactly @p count entries were decoded from exactly @p length bytes.
+ */
+bool simple_beacon_codec_decode(const uint8_t * p_buffer,
+                                uint32_t length,
+                                simple_beacon_report_entry_t * p_entries,
+                                uint32_t count);
+
+/** @} end of SIMPLE_BEACON_CODEC */
+
+#endif /* SIMPLE_BEACON_CODEC_H__ */
@@ -41,6 +41,7 @@
 #include <stdint.h>
 #include "access.h"
 #include "utils.h"
+#include "simple_beacon_codec.h"
 
 /**
  * @defgroup SIMPLE_BEACON_MODEL Simple Beacon model
@@ -64,6 +65,32 @@
  * @copydoc SIMPLE_BEACON_OPCODE_SET_UNRELIABLE
  * @par
  * @copydoc SIMPLE_BEACON_OPCODE_STATUS
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_REPORT_STATUS
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_REPORT_BATCH
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_CONFIG_GET
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_CONFIG_SET
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_CONFIG_STATUS
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_PRESENCE_EVENTS
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_PRESENCE_DIGEST
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_WATCHLIST_CHUNK
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_WATCHLIST_STATUS
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_REPORT_ACK
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_REPORTS_GET
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_REPORTS_PAGE
+ * @par
+ * @copydoc SIMPLE_BEACON_OPCODE_TIME_BEACON
  *
  * @ingroup MESH_API_GROUP_VENDOR_MODELS
  * @{
@@ -80,13 +107,31 @@
 /** Simple Beacon opcodes. */
 typedef enum
 {
-    SIMPLE_BEACON_OPCODE_SET = 0xC1,            /**< Simple Beacon Acknowledged Set. */
-    SIMPLE_BEACON_OPCODE_GET = 0xC2,            /**< Simple Beacon Get. */
-    SIMPLE_BEACON_OPCODE_SET_UNRELIABLE = 0xC3, /**< Simple Beacon Set Unreliable. */
-    SIMPLE_BEACON_OPCODE_STATUS = 0xC4,          /**< Simple Beacon Status. */
-    SIMPLE_BEACON_OPCODE_REPORT_STATUS = 0xC5
+    SIMPLE_BEACON_OPCODE_SET = 0xC1,              /**< Simple Beacon Acknowledged Set. */
+    SIMPLE_BEACON_OPCODE_GET = 0xC2,              /**< Simple Beacon Get. */
+    SIMPLE_BEACON_OPCODE_SET_UNRELIABLE = 0xC3,   /**< Simple Beacon Set Unreliable. */
+    SIMPLE_BEACON_OPCODE_STATUS = 0xC4,           /**< Simple Beacon Status. */
+    SIMPLE_BEACON_OPCODE_REPORT_STATUS = 0xC5,    /**< Simple Beacon Report Status. */
+    SIMPLE_BEACON_OPCODE_REPORT_BATCH = 0xC6,     /**< Simple Beacon Report Batch, several sightings in one message. */
+    SIMPLE_BEACON_OPCODE_CONFIG_GET = 0xC7,       /**< Simple Beacon Config Get. */
+    SIMPLE_BEACON_OPCODE_CONFIG_SET = 0xC8,       /**< Simple Beacon Acknowledged Config Set. */
+    SIMPLE_BEACON_OPCODE_CONFIG_STATUS = 0xC9,    /**< Simple Beacon Config Status. */
+    SIMPLE_BEACON_OPCODE_PRESENCE_EVENTS = 0xCA,  /**< Simple Beacon Presence Events, eartags entering and leaving. */
+    SIMPLE_BEACON_OPCODE_PRESENCE_DIGEST = 0xCB,  /**< Simple Beacon Presence Digest, keep-alive summary of the present eartags. */
+    SIMPLE_BEACON_OPCODE_WATCHLIST_CHUNK = 0xCC,  /**< Simple Beacon Watchlist Chunk, part of a new tag watchlist. */
+    SIMPLE_BEACON_OPCODE_WATCHLIST_STATUS = 0xCD, /**< Simple Beacon Watchlist Status, acknowledges a Watchlist Chunk. */
+    SIMPLE_BEACON_OPCODE_REPORT_ACK = 0xCE,       /**< Simple Beacon Report Ack, selective acknowledgement of report messages. */
+    SIMPLE_BEACON_OPCODE_REPORTS_GET = 0xCF,      /**< Simple Beacon Reports Get, pulls stored report history from a cursor. */
+    SIMPLE_BEACON_OPCODE_REPORTS_PAGE = 0xD0,     /**< Simple Beacon Reports Page, one page of stored report history. */
+    SIMPLE_BEACON_OPCODE_TIME_BEACON = 0xD1       /**< Simple Beacon Time Beacon, the network time published by the gateway. */
 } simple_beacon_opcode_t;
 
+/** Length of a reply slot in a reply window, fits an unsegmented reply with its retransmissions. */
+#define SIMPLE_BEACON_REPLY_SLOT_MS         (50)
+
+/** Size of a vendor specific opcode. */
+#define SIMPLE_BEACON_VENDOR_OPCODE_SIZE    (3)
+
 /** Message format for the Simple Beacon Set message. */
 typedef struct __attribute((packed))
 {
@@ -105,6 +150,27 @@ typedef struct __attribute((packed))
     uint8_t report_enable; /**< State to get. */
 } simple_beacon_msg_get_t;
 
+/**
+ * Message format for the Simple Beacon Set message with a reply window.
+ *
+ * A Set or Get sent to a group address makes every server reply at once. With a reply window, each
+ * server delays its Status reply to the slot given by its unicast address modulo the number of
+ * @ref SIMPLE_BEACON_REPLY_SLOT_MS slots in the window, so the replies of consecutively addressed
+ * servers arrive one per slot.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t report_enable;    /**< State to set. */
+    uint16_t reply_window_ms; /**< Time to spread the replies over, 0 to reply at once. */
+} simple_beacon_msg_set_staggered_t;
+
+/** Message format for the Simple Beacon Get message with a reply window. */
+typedef struct __attribute((packed))
+{
+    uint8_t report_enable;    /**< Not used. */
+    uint16_t reply_window_ms; /**< Time to spread the replies over, 0 to reply at once. */
+} simple_beacon_msg_get_staggered_t;
+
 typedef struct __attribute((packed))
 {
     uint8_t report_enable; /**< State to get. */
@@ -116,6 +182,224 @@ typedef struct __attribute((packed))
     uint8_t custome_data[16];
 } simple_beacon_msg_report_t;
 
+/** Base time of a report batch from a server without a network time. */
+#define SIMPLE_BEACON_TIME_UNKNOWN  (0xFFFFFFFF)
+
+/**
+ * Message format for the Simple Beacon Report Batch message.
+ *
+ * The entry ages are relative to @c base_time, the network time the batch was sent at, so the
+ * sightings of all servers can be put on one time line.
+ */
+typedef struct __attribute((packed))
+{
+    uint16_t batch_seq; /**< Batch sequence number, incremented for every batch sent by the server. */
+    uint8_t  count;     /**< Number of entries in the batch. */
+    uint32_t base_time; /**< Network time of the batch, in milliseconds, or @ref SIMPLE_BEACON_TIME_UNKNOWN. */
+    uint8_t  data[];    /**< Entries, encoded as described in @ref SIMPLE_BEACON_CODEC. */
+} simple_beacon_msg_report_batch_t;
+
+/** Maximum size of the encoded entries in a Simple Beacon Report Batch message. */
+#define SIMPLE_BEACON_REPORT_BATCH_DATA_MAX \
+    (ACCESS_MESSAGE_LENGTH_MAX - SIMPLE_BEACON_VENDOR_OPCODE_SIZE - sizeof(simple_beacon_msg_report_batch_t))
+
+/** Presence event types. */
+typedef enum
+{
+    SIMPLE_BEACON_PRESENCE_ENTER = 0, /**< The eartag became present. */
+    SIMPLE_BEACON_PRESENCE_LEAVE = 1  /**< The eartag became absent. */
+} simple_beacon_presence_type_t;
+
+/** Presence event, as carried in the Presence Events message. */
+typedef struct __attribute((packed))
+{
+    uint8_t addr[SIMPLE_BEACON_CODEC_ADDR_LEN]; /**< Advertiser address of the eartag, little endian. */
+    uint8_t type;                               /**< Event type, @ref simple_beacon_presence_type_t. */
+    int8_t  rssi;                               /**< Filtered RSSI at the time of the event, in dBm. */
+} simple_beacon_presence_event_t;
+
+/** Message format for the Simple Beacon Presence Events message. */
+typedef struct __attribute((packed))
+{
+    uint16_t batch_seq;                        /**< Sequence number, shared with the Report Batch and Presence Digest messages. */
+    uint8_t  count;                            /**< Number of events. */
+    simple_beacon_presence_event_t events[];   /**< Events, oldest first. */
+} simple_beacon_msg_presence_events_t;
+
+/** Maximum number of events in a Simple Beacon Presence Events message. */
+#define SIMPLE_BEACON_PRESENCE_EVENTS_MAX \
+    ((ACCESS_MESSAGE_LENGTH_MAX - SIMPLE_BEACON_VENDOR_OPCODE_SIZE - sizeof(simple_beacon_msg_presence_events_t)) / \
+     sizeof(simple_beacon_presence_event_t))
+
+/**
+ * Message format for the Simple Beacon Presence Digest message.
+ *
+ * The fingerprint is the exclusive or of a 32-bit hash of the address of every present eartag, so a
+ * receiver that applies the presence events can check that its view matches the scanner's. A
+ * scanner with several server elements reports every eartag from the same element, and each
+ * element sends the digest of its own eartags.
+ */
+typedef struct __attribute((packed))
+{
+    uint16_t batch_seq;     /**< Sequence number, shared with the Report Batch and Presence Events messages. */
+    uint16_t present_count; /**< Number of present eartags reported by the element. */
+    uint32_t fingerprint;   /**< Fingerprint of the present eartags reported by the element. */
+} simple_beacon_msg_presence_digest_t;
+
+/**
+ * Message format for the Simple Beacon Report Ack message.
+ *
+ * Acknowledges the report messages (Report Batch, Presence Events and Presence Digest) by their
+ * sequence number. Every report message below @c ack_seq has been received. Bit @c n of
+ * @c received_bitmap is set if the report message with sequence number <tt>ack_seq + 1 + n</tt>
+ * has been received as well, so the messages with a clear bit below the highest set bit are
+ * missing and are retransmitted by the server right away.
+ */
+typedef struct __attribute((packed))
+{
+    uint16_t ack_seq;         /**< Lowest report sequence number not received yet. */
+    uint32_t received_bitmap; /**< Received report messages following @c ack_seq. */
+} simple_beacon_msg_report_ack_t;
+
+/**
+ * Message format for the Simple Beacon Reports Get message.
+ *
+ * Pulls the report history the server stored while it could not publish, one page per request,
+ * starting at a cursor. The cursor is a record sequence number and an entry index in that record,
+ * and the Reports Page reply carries the cursor of the next page. The first request of a pull
+ * uses cursor 0:0.
+ *
+ * A request also acknowledges all records before its cursor, so the server stops pushing them.
+ * The gateway paces the transfer: it sends the next request when it is ready for more, and may
+ * interleave requests to many servers.
+ */
+typedef struct __attribute((packed))
+{
+    uint32_t since_seq;   /**< Record sequence number of the cursor. */
+    uint8_t  since_entry; /**< Entry index of the cursor in the record. */
+    uint16_t max_bytes;   /**< Largest encoded entry data the gateway wants in the page, 0 for no limit. */
+} simple_beacon_msg_reports_get_t;
+
+/**
+ * Message format for the Simple Beacon Reports Page message.
+ *
+ * Carries consecutive entries of one stored record, encoded as in the Report Batch message. Entry
+ * ages are relative to the time the record was stored, add @c record_age to get the age at the
+ * time of the reply. A page with no entries ends the pull, the history is exhausted.
+ */
+typedef struct __attribute((packed))
+{
+    uint32_t record_seq;  /**< Sequence number of the record the entries are from. */
+    uint8_t  first_entry; /**< Index of the first entry in the record. */
+    uint8_t  count;       /**< Number of entries in the page. */
+    uint16_t record_age;  /**< Time since the record was stored, in 100 ms units. 0xFFFF if unknown. */
+    uint32_t next_seq;    /**< Record sequence number of the next cursor. */
+    uint8_t  next_entry;  /**< Entry index of the next cursor. */
+    uint8_t  data[];      /**< Entries, encoded as described in @ref SIMPLE_BEACON_CODEC. */
+} simple_beacon_msg_reports_page_t;
+
+/** Maximum size of the encoded entries in a Simple Beacon Reports Page message. */
+#define SIMPLE_BEACON_REPORTS_PAGE_DATA_MAX \
+    (ACCESS_MESSAGE_LENGTH_MAX - SIMPLE_BEACON_VENDOR_OPCODE_SIZE - sizeof(simple_beacon_msg_reports_page_t))
+
+/**
+ * Message format for the Simple Beacon Time Beacon message.
+ *
+ * Published periodically by the gateway to a group address all servers subscribe to. The network
+ * time is a millisecond count from an epoch chosen by the gateway, and wraps after 49.7 days.
+ * Relays decrement the TTL, so the receiver knows the number of hops the beacon made, and adds
+ * the relay delay to the network time.
+ */
+typedef struct __attribute((packed))
+{
+    uint32_t network_time; /**< Network time the beacon was sent at, in milliseconds. */
+    uint8_t  ttl;          /**< TTL the beacon was sent with. */
+    uint8_t  hop_delay;    /**< Average delay added by a relay, in milliseconds. */
+} simple_beacon_msg_time_beacon_t;
+
+/** Version of the scanner configuration state defined by @ref simple_beacon_config_t. */
+#define SIMPLE_BEACON_CONFIG_VERSION    (3)
+
+/** Tag filter modes. */
+typedef enum
+{
+    SIMPLE_BEACON_FILTER_MODE_NONE = 0,      /**< Report every eartag heard above the RSSI floor. */
+    SIMPLE_BEACON_FILTER_MODE_WATCHLIST = 1, /**< Only report eartags in the watchlist, when one has been received. */
+} simple_beacon_filter_mode_t;
+
+/** Report modes. */
+typedef enum
+{
+    SIMPLE_BEACON_REPORT_MODE_SIGHTINGS = 0, /**< Report Batch messages with the aggregated sightings of every eartag. */
+    SIMPLE_BEACON_REPORT_MODE_PRESENCE = 1   /**< Presence Events on enter and leave, and periodic Presence Digest messages. */
+} simple_beacon_report_mode_t;
+
+/**
+ * Scanner configuration state, carried in the Config Set and Config Status messages.
+ *
+ * Servers ignore Config Set messages with a version they do not support, and reply with their
+ * current configuration.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t  version;         /**< Configuration version, @ref SIMPLE_BEACON_CONFIG_VERSION. */
+    uint16_t report_interval; /**< Longest time between two report batches, in 100 ms units. */
+    uint8_t  batch_size_max;  /**< Number of tags that triggers a report batch before the interval expires. */
+    int8_t   rssi_floor;      /**< Sightings below this RSSI are dropped, in dBm. */
+    uint16_t scan_interval;   /**< Scan interval of the eartag capture slot, in milliseconds. */
+    uint16_t scan_window;     /**< Scan window of the eartag capture slot, in milliseconds. */
+    uint8_t  filter_mode;     /**< Tag filter mode, @ref simple_beacon_filter_mode_t. */
+    uint8_t  mesh_share;      /**< Share of the scan time given to the mesh slot, in percent. */
+    uint8_t  report_mode;     /**< Report mode, @ref simple_beacon_report_mode_t. */
+} simple_beacon_config_t;
+
+/** Watchlist formats. */
+typedef enum
+{
+    SIMPLE_BEACON_WATCHLIST_FORMAT_BLOOM = 0,  /**< Bloom filter over the eartag addresses. */
+    SIMPLE_BEACON_WATCHLIST_FORMAT_SORTED = 1  /**< Sorted array of 6-byte eartag addresses. */
+} simple_beacon_watchlist_format_t;
+
+/** Watchlist transfer status codes. */
+typedef enum
+{
+    SIMPLE_BEACON_WATCHLIST_STATUS_IN_PROGRESS = 0,  /**< Chunk accepted, more chunks are expected. */
+    SIMPLE_BEACON_WATCHLIST_STATUS_COMPLETE = 1,     /**< The watchlist is complete and in use. */
+    SIMPLE_BEACON_WATCHLIST_STATUS_OUT_OF_ORDER = 2, /**< Chunk not at the expected offset, resend from the received length. */
+    SIMPLE_BEACON_WATCHLIST_STATUS_TOO_LARGE = 3,    /**< The watchlist does not fit on the server. */
+    SIMPLE_BEACON_WATCHLIST_STATUS_INVALID = 4       /**< The complete watchlist is malformed, and was discarded. */
+} simple_beacon_watchlist_status_code_t;
+
+/**
+ * Message format for the Simple Beacon Watchlist Chunk message.
+ *
+ * A watchlist is sent as consecutive chunks of one transfer, starting at offset 0. The server
+ * acknowledges every chunk with a Watchlist Status message. The new watchlist is used as soon as
+ * the last chunk is in, until then the server keeps using the previous one. Every new watchlist
+ * must be sent with a new transfer ID.
+ */
+typedef struct __attribute((packed))
+{
+    uint8_t  transfer_id;  /**< Transfer identifier, the same for all chunks of a watchlist. */
+    uint8_t  format;       /**< Watchlist format, @ref simple_beacon_watchlist_format_t. */
+    uint8_t  hash_count;   /**< Number of hash functions of a Bloom filter, 0 for other formats. */
+    uint16_t total_length; /**< Length of the complete watchlist, in bytes. */
+    uint16_t offset;       /**< Offset of this chunk in the watchlist. */
+    uint8_t  data[];       /**< Chunk data. */
+} simple_beacon_msg_watchlist_chunk_t;
+
+/** Maximum chunk data in a Simple Beacon Watchlist Chunk message. */
+#define SIMPLE_BEACON_WATCHLIST_CHUNK_DATA_MAX \
+    (ACCESS_MESSAGE_LENGTH_MAX - SIMPLE_BEACON_VENDOR_OPCODE_SIZE - sizeof(simple_beacon_msg_watchlist_chunk_t))
+
+/** Message format for the Simple Beacon Watchlist Status message. */
+typedef struct __attribute((packed))
+{
+    uint8_t  transfer_id;     /**< Transfer identifier of the acknowledged chunk. */
+    uint8_t  status;          /**< Transfer status, @ref simple_beacon_watchlist_status_code_t. */
+    uint16_t received_length; /**< Offset the next chunk is expected at. */
+} simple_beacon_msg_watchlist_status_t;
+
 /*lint -align_max(pop) */
 
 /** @} end of SIMPLE_BEACON_COMMON */
@@ -0,0 +1,214 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIMPLE_BEACON_REPORT_WINDOW_H__
+#define SIMPLE_BEACON_REPORT_WINDOW_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "simple_beacon_tx_pool.h"
+
+/**
+ * @defgroup SIMPLE_BEACON_REPORT_WINDOW Simple Beacon report window
+ * @ingroup SIMPLE_BEACON_MODEL
+ * Send window of the selective acknowledgement protocol for Simple Beacon report messages.
+ *
+ * Every report message (Report Batch, Presence Events and Presence Digest) carries a sequence
+ * number. Published messages are kept in the window until the gateway acknowledges them with a
+ * Report Ack message, which holds:
+ * - a cumulative acknowledgement: the lowest sequence number not received yet, all lower ones are
+ *   acknowledged,
+ * - a bitmap of the next 32 sequence numbers, where bit @c n set means that sequence number
+ *   <tt>ack_seq + 1 + n</tt> was received.
+ *
+ * Messages the gateway reports as missing, because a later one was received, are marked lost and
+ * retransmitted first. Messages that stay unacknowledged are retransmitted after a timeout, which
+ * doubles with every retry. Several messages can be in flight at once, there is no stop-and-wait.
+ * A message still unacknowledged after @ref SIMPLE_BEACON_REPORT_RETRIES_MAX retransmissions is
+ * given up, so a gateway that stops acknowledging cannot jam the window.
+ *
+ * The messages stay in the @ref SIMPLE_BEACON_TX_POOL blocks they were built in, the window holds
+ * a reference to the block of every message it keeps.
+ *
+ * The window has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Number of sequence numbers covered by the bitmap of a Report Ack message. */
+#define SIMPLE_BEACON_REPORT_ACK_BITMAP_BITS (32)
+
+/** Highest number of timeout doublings for a retransmitted message. */
+#define SIMPLE_BEACON_REPORT_BACKOFF_SHIFT_MAX (4)
+
+/** Number of retransmissions of a message before it is given up. */
+#ifndef SIMPLE_BEACON_REPORT_RETRIES_MAX
+#define SIMPLE_BEACON_REPORT_RETRIES_MAX    (6)
+#endif
+
+/** Slot states. */
+typedef enum
+{
+    SIMPLE_BEACON_REPORT_SLOT_FREE,  /**< The slot holds no message. */
+    SIMPLE_BEACON_REPORT_SLOT_SENT,  /**< The message was sent, and is waiting for an acknowledgement. */
+    SIMPLE_BEACON_REPORT_SLOT_LOST   /**< The gateway reported the message as missing. */
+} simple_beacon_report_slot_state_t;
+
+/** A report message waiting for an acknowledgement. */
+typedef struct
+{
+    const uint8_t * p_data;    /**< Message parameters, as published, in a pool block. */
+    uint16_t length;           /**< Length of the message parameters. */
+    uint16_t seq;              /**< Sequence number of the message. */
+    uint8_t  opcode;           /**< Vendor opcode of the message. */
+    uint8_t  state;            /**< Slot state, @ref simple_beacon_report_slot_state_t. */
+    uint8_t  retries;          /**< Number of retransmissions. */
+    uint32_t sent_timestamp;   /**< Time of the last transmission. */
+    uint32_t stored_timestamp; /**< Time of the first transmission. */
+} simple_beacon_report_slot_t;
+
+/** Send window. */
+typedef struct
+{
+    simple_beacon_report_slot_t slots[SIMPLE_BEACON_REPORT_WINDOW_SIZE]; /**< Window slots. */
+    simple_beacon_tx_pool_t * p_pool;                                    /**< Pool of the message blocks. */
+    uint32_t count;                                                      /**< Number of used slots. */
+    uint32_t acked_count;                                                /**< Number of messages acknowledged since init. */
+    uint32_t retransmit_count;                                           /**< Number of retransmissions since init. */
+    uint32_t expired_count;                                              /**< Number of messages given up since init. */
+} simple_beacon_report_window_t;
+
+/**
+ * Initializes an empty window.
+ *
+ * @param[out] p_window Window to initialize.
+ * @param[in]  p_pool   Pool the messages are allocated from.
+ */
+void simple_beacon_report_window_init(simple_beacon_report_window_t * p_window, simple_beacon_tx_pool_t * p_pool);
+
+/**
+ * Checks whether the window has room for another message.
+ *
+ * @param[in] p_window Window.
+ *
+ * @returns @c true if all slots are in use.
+ */
+static inline bool simple_beacon_report_window_is_full(const simple_beacon_report_window_t * p_window)
+{
+    return p_window->count >= SIMPLE_BEACON_REPORT_WINDOW_SIZE;
+}
+
+/**
+ * Stores a published message, and holds a reference to its block. The window must not be full.
+ *
+ * @param[in,out] p_window Window.
+ * @param[in]     seq      Sequence number of the message.
+ * @param[in]     opcode   Vendor opcode of the message.
+ * @param[in]     p_data   Message parameters, in a block of the window's pool.
+ * @param[in]     length   Length of the message parameters.
+ * @param[in]     now      Current time, in the unit of the retransmission timeout.
+ */
+void simple_beacon_report_window_store(simple_beacon_report_window_t * p_window,
+                                       uint16_t seq,
+                                       uint8_t opcode,
+                                       const uint8_t * p_data,
+                                       uint16_t length,
+                                       uint32_t now);
+
+/**
+ * Applies a Report Ack message.
+ *
+ * @param[in,out] p_window Window.
+ * @param[in]     ack_seq  Lowest sequence number not received by the gateway.
+ * @param[in]     bitmap   Received sequence numbers following @p ack_seq.
+ *
+ * @returns Number of messages acknowledged, and removed from the window. Their blocks are released.
+ */
+uint32_t simple_beacon_report_window_ack(simple_beacon_report_window_t * p_window, uint16_t ack_seq, uint32_t bitmap);
+
+/**
+ * Gets the next message to retransmit: the oldest lost message, or else the oldest message whose
+ * retransmission timeout has expired. Messages out of retransmissions are left out, see
+ * @ref simple_beacon_report_window_expired_get.
+ *
+ * @param[in,out] p_window Window.
+ * @param[in]     now      Current time.
+ * @param[in]     timeout  Time before the first retransmission of an unacknowledged message.
+ *
+ * @returns The message to retransmit, or NULL if there is none.
+ */
+simple_beacon_report_slot_t * simple_beacon_report_window_retransmit_get(simple_beacon_report_window_t * p_window,
+                                                                         uint32_t now,
+                                                                         uint32_t timeout);
+
+/**
+ * Records the retransmission of a message.
+ *
+ * @param[in,out] p_window Window.
+ * @param[in,out] p_slot   Retransmitted message, from @ref simple_beacon_report_window_retransmit_get.
+ * @param[in]     now      Current time.
+ */
+void simple_beacon_report_window_sent(simple_beacon_report_window_t * p_window,
+                                      simple_beacon_report_slot_t * p_slot,
+                                      uint32_t now);
+
+/**
+ * Gets the next message to give up: a message retransmitted @ref SIMPLE_BEACON_REPORT_RETRIES_MAX
+ * times that the gateway reported lost again, or whose last retransmission timed out.
+ *
+ * @param[in] p_window Window.
+ * @param[in] now      Current time.
+ * @param[in] timeout  Time before the first retransmission of an unacknowledged message.
+ *
+ * @returns The message to give up, or NULL if there is none.
+ */
+simple_beacon_report_slot_t * simple_beacon_report_window_expired_get(simple_beacon_report_window_t * p_window,
+                                                                      uint32_t now,
+                                                                      uint32_t timeout);
+
+/**
+ * Removes a given up message from the window, and releases its block.
+ *
+ * @param[in,out] p_window Window.
+ * @param[in,out] p_slot   Given up message, from @ref simple_beacon_report_window_expired_get.
+ */
+void simple_beacon_report_window_expire(simple_beacon_report_window_t * p_window,
+                                        simple_beacon_report_slot_t * p_slot);
+
+/** @} end of SIMPLE_BEACON_REPORT_WINDOW */
+
+#endif /* SIMPLE_BEACON_REPORT_WINDOW_H__ */
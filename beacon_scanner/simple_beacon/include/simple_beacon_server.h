@@ -41,6 +41,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "access.h"
+#include "timer_scheduler.h"
+#include "simple_beacon_common.h"
+#include "simple_beacon_report_window.h"
+#include "simple_beacon_tx_pool.h"
 
 /**
  * @defgroup SIMPLE_BEACON_SERVER Simple Beacon Server
@@ -70,6 +74,101 @@ typedef bool (*simple_beacon_get_cb_t)(const simple_beacon_server_t * p_self);
  */
 typedef bool (*simple_beacon_set_cb_t)(const simple_beacon_server_t * p_self, bool beacon);
 
+/**
+ * Config get callback type.
+ * @param[in]  p_self   Pointer to the Simple Beacon Server context structure.
+ * @param[out] p_config Current scanner configuration.
+ */
+typedef void (*simple_beacon_config_get_cb_t)(const simple_beacon_server_t * p_self, simple_beacon_config_t * p_config);
+
+/**
+ * Config set callback type.
+ *
+ * The application may clamp the values, the applied configuration is read back with the config get
+ * callback and sent in the Config Status message.
+ *
+ * @param[in] p_self   Pointer to the Simple Beacon Server context structure.
+ * @param[in] p_config Desired scanner configuration, with a supported version.
+ */
+typedef void (*simple_beacon_config_set_cb_t)(const simple_beacon_server_t * p_self, const simple_beacon_config_t * p_config);
+
+/**
+ * Watchlist chunk callback type.
+ *
+ * @param[in]  p_self      Pointer to the Simple Beacon Server context structure.
+ * @param[in]  p_chunk     Received chunk header.
+ * @param[in]  data_length Length of the chunk data following the header.
+ * @param[out] p_status    Status to acknowledge the chunk with, the transfer ID is filled in by the server.
+ */
+typedef void (*simple_beacon_watchlist_chunk_cb_t)(const simple_beacon_server_t * p_self,
+                                                   const simple_beacon_msg_watchlist_chunk_t * p_chunk,
+                                                   uint16_t data_length,
+                                                   simple_beacon_msg_watchlist_status_t * p_status);
+
+/**
+ * Report ack callback type.
+ *
+ * @param[in] p_self      Pointer to the Simple Beacon Server context structure.
+ * @param[in] acked_count Number of report messages acknowledged by the Report Ack message.
+ */
+typedef void (*simple_beacon_report_ack_cb_t)(const simple_beacon_server_t * p_self, uint32_t acked_count);
+
+/**
+ * Report expired callback type, called for a report message given up after
+ * @ref SIMPLE_BEACON_REPORT_RETRIES_MAX retransmissions, before its block is released.
+ *
+ * @param[in] p_self Pointer to the Simple Beacon Server context structure.
+ * @param[in] opcode Vendor opcode of the message.
+ * @param[in] p_data Message parameters.
+ * @param[in] length Length of the message parameters.
+ * @param[in] age_ms Time since the message was first sent, in milliseconds.
+ */
+typedef void (*simple_beacon_report_expired_cb_t)(const simple_beacon_server_t * p_self,
+                                                  uint8_t opcode,
+                                                  const uint8_t * p_data,
+                                                  uint16_t length,
+                                                  uint32_t age_ms);
+
+/** Stored report record, served from the application's storage by the Reports Get message. */
+typedef struct
+{
+    const simple_beacon_report_entry_t * p_entries; /**< Entries of the record, read in place. */
+    uint32_t count;                                 /**< Number of entries. */
+    uint32_t seq;                                   /**< Record sequence number. */
+    uint16_t age;                                   /**< Time since the record was stored, in 100 ms units, 0xFFFF if unknown. */
+} simple_beacon_report_record_t;
+
+/**
+ * Reports get callback type.
+ *
+ * Finds the oldest stored record with a sequence number of at least @p since_seq. The records
+ * before @p since_seq have been received by the client, and may be dropped.
+ *
+ * @param[in]  p_self    Pointer to the Simple Beacon Server context structure.
+ * @param[in]  since_seq Lowest record sequence number to look for.
+ * @param[out] p_record  Record found. The entries must stay valid until the callback returns.
+ *
+ * @returns @c true if a record was found.
+ */
+typedef bool (*simple_beacon_reports_get_cb_t)(const simple_beacon_server_t * p_self,
+                                               uint32_t since_seq,
+                                               simple_beacon_report_record_t * p_record);
+
+/**
+ * Time beacon callback type.
+ *
+ * @param[in] p_self       Pointer to the Simple Beacon Server context structure.
+ * @param[in] network_time Network time the beacon was sent at, in milliseconds.
+ * @param[in] hops         Number of relays the beacon went through.
+ * @param[in] hop_delay    Average delay added by a relay, in milliseconds.
+ * @param[in] rx_age_ms    Time since the beacon was received by the radio, in milliseconds.
+ */
+typedef void (*simple_beacon_time_beacon_cb_t)(const simple_beacon_server_t * p_self,
+                                               uint32_t network_time,
+                                               uint32_t hops,
+                                               uint32_t hop_delay,
+                                               uint32_t rx_age_ms);
+
 /** Simple Beacon Server state structure. */
 struct __simple_beacon_server
 {
@@ -79,6 +178,57 @@ struct __simple_beacon_server
     simple_beacon_get_cb_t get_cb;
     /** Set callback. */
     simple_beacon_set_cb_t set_cb;
+    /** Config get callback, optional. The config messages are ignored if not set. */
+    simple_beacon_config_get_cb_t config_get_cb;
+    /** Config set callback, required if the config get callback is set. */
+    simple_beacon_config_set_cb_t config_set_cb;
+    /** Watchlist chunk callback, optional. The Watchlist Chunk messages are ignored if not set. */
+    simple_beacon_watchlist_chunk_cb_t watchlist_chunk_cb;
+    /**
+     * Pool of the message buffers, required. May be shared between servers, and must be
+     * initialized with @ref simple_beacon_tx_pool_init before the servers. The blocks are returned
+     * with @ref simple_beacon_server_tx_complete.
+     */
+    simple_beacon_tx_pool_t * p_tx_pool;
+    /**
+     * Send window for the report messages, optional. If set, the report messages are kept until
+     * acknowledged by a Report Ack message, and publishing fails with @c NRF_ERROR_NO_MEM while
+     * the window is full.
+     */
+    simple_beacon_report_window_t * p_report_window;
+    /** Report ack callback, optional. Called for Report Ack messages when the send window is set. */
+    simple_beacon_report_ack_cb_t report_ack_cb;
+    /** Report expired callback, optional. Called for given up report messages when the send window is set. */
+    simple_beacon_report_expired_cb_t report_expired_cb;
+    /** Reports get callback, optional. The Reports Get messages are ignored if not set. */
+    simple_beacon_reports_get_cb_t reports_get_cb;
+    /** Time beacon callback, optional. The Time Beacon messages are ignored if not set. */
+    simple_beacon_time_beacon_cb_t time_beacon_cb;
+    /** Sequence number of the next report message, shared by report batches and presence messages. */
+    uint16_t batch_seq;
+    /** Access token of the last published report message. */
+    nrf_mesh_tx_token_t batch_token;
+    /** The state in @c status_published has been published. */
+    bool status_published_valid;
+    /** Last published report state. */
+    bool status_published;
+    /** Number of Status publications left out because the reply or an earlier publication covered them. */
+    uint32_t status_suppressed_count;
+    /**
+     * A Status publication after a Set failed on a full TX queue, and is left to the application, see
+     * @ref simple_beacon_server_status_publish.
+     */
+    bool status_publish_pending;
+    /** Time the pending Status publication failed, see @ref timer_now. */
+    timestamp_t status_pending_timestamp;
+    /** Access token of the last Status publication. */
+    nrf_mesh_tx_token_t status_token;
+    /** Timer for a Status reply delayed to its slot in a reply window. */
+    timer_event_t reply_timer;
+    /** Request answered by the delayed reply, without its parameters. */
+    access_message_rx_t reply_message;
+    /** A delayed reply is pending. */
+    bool reply_pending;
 };
 
 /**
@@ -91,7 +241,8 @@ struct __simple_beacon_server
  * @param[in] element_index Element index to add the server model.
  *
  * @retval NRF_SUCCESS         Successfully added server.
- * @retval NRF_ERROR_NULL      NULL pointer supplied to function.
+ * @retval NRF_ERROR_NULL      NULL pointer supplied to function, no TX pool set, or only one of the
+ *                             config callbacks set.
  * @retval NRF_ERROR_NO_MEM    No more memory available to allocate model.
  * @retval NRF_ERROR_FORBIDDEN Multiple model instances per element is not allowed.
  * @retval NRF_ERROR_NOT_FOUND Invalid element index.
@@ -120,8 +271,186 @@ uint32_t simple_beacon_server_init(simple_beacon_server_t * p_server, uint16_t e
  */
 uint32_t simple_beacon_server_status_publish(simple_beacon_server_t * p_server, bool value);
 
+/**
+ * Publishes a Report Status message with 16 bytes of custom data.
+ *
+ * The data is copied into a pool block. Build the message in place with
+ * @ref simple_beacon_server_tx_block_alloc to avoid the copy.
+ *
+ * @param[in]  p_server  Simple Beacon Server structure pointer
+ * @param[in]  user_data 16 bytes of custom data.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, or no free pool block.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
 uint32_t simple_beacon_server_report_publish(simple_beacon_server_t * p_server, uint8_t * user_data);
 
+/**
+ * Allocates a message buffer from the pool of the server, for a message to be built in place and
+ * published with @ref simple_beacon_server_tx_block_publish.
+ *
+ * @param[in] p_server Simple Beacon Server structure pointer
+ *
+ * @returns Buffer of @ref SIMPLE_BEACON_TX_BLOCK_SIZE bytes, or NULL if no block is free.
+ */
+uint8_t * simple_beacon_server_tx_block_alloc(simple_beacon_server_t * p_server);
+
+/**
+ * Publishes a message built in a buffer from @ref simple_beacon_server_tx_block_alloc.
+ *
+ * The buffer is handed over in all cases. It returns to the pool when the message is transmitted,
+ * or right away if the publish fails.
+ *
+ * @param[in] p_server Simple Beacon Server structure pointer
+ * @param[in] opcode   Vendor opcode of the message.
+ * @param[in] p_block  Message parameters, in a pool block.
+ * @param[in] length   Length of the message parameters.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ * @retval NRF_ERROR_INVALID_LENGTH Attempted to send message larger than @ref ACCESS_MESSAGE_LENGTH_MAX.
+ */
+uint32_t simple_beacon_server_tx_block_publish(simple_beacon_server_t * p_server,
+                                               uint8_t opcode,
+                                               uint8_t * p_block,
+                                               uint16_t length);
+
+/**
+ * Returns the message buffer of a completed transmission to the pool. Must be called for every
+ * @c NRF_MESH_EVT_TX_COMPLETE event, and for segmented messages that failed.
+ *
+ * @param[in] p_server Simple Beacon Server structure pointer
+ * @param[in] token    Access token of the transmission.
+ */
+void simple_beacon_server_tx_complete(simple_beacon_server_t * p_server, nrf_mesh_tx_token_t token);
+
+/**
+ * Publishes an unsolicited Config Status message with the current scanner configuration.
+ *
+ * @param[in]  p_server         Simple Beacon Server structure pointer
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function, or no config callbacks set.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t simple_beacon_server_config_status_publish(simple_beacon_server_t * p_server);
+
+/**
+ * Publishes a batch of sighting entries in a single, segmented, Report Batch message.
+ *
+ * The entries are encoded with the @ref SIMPLE_BEACON_CODEC, and as many entries as fit in one
+ * message are sent, starting from the first one. When the batch is queued successfully, the batch
+ * sequence number of the server is incremented and the access token of the message is stored in
+ * @c batch_token, to be matched with the @c NRF_MESH_EVT_TX_COMPLETE event.
+ *
+ * @param[in]  p_server    Simple Beacon Server structure pointer
+ * @param[in]  p_entries   Entries to publish, preferably sorted by address.
+ * @param[in]  count       Number of entries.
+ * @param[in]  base_time   Network time the entry ages are relative to, in milliseconds, or
+ *                         @ref SIMPLE_BEACON_TIME_UNKNOWN.
+ * @param[out] p_published Number of entries included in the published message.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, no free pool block, or the send window is full.
+ * @retval NRF_ERROR_NOT_FOUND      Invalid model handle or model not bound to element.
+ * @retval NRF_ERROR_INVALID_ADDR   The element index is greater than the number of local unicast
+ *                                  addresses stored by the @ref DEVICE_STATE_MANAGER.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ * @retval NRF_ERROR_INVALID_LENGTH The batch is empty.
+ */
+uint32_t simple_beacon_server_report_batch_publish(simple_beacon_server_t * p_server,
+                                                   const simple_beacon_report_entry_t * p_entries,
+                                                   uint32_t count,
+                                                   uint32_t base_time,
+                                                   uint32_t * p_published);
+
+/**
+ * Publishes presence events in a single, segmented, Presence Events message.
+ *
+ * As many events as fit in one message are sent, starting from the first one. On success, the
+ * report sequence number is incremented and the access token is stored in @c batch_token, as for
+ * @ref simple_beacon_server_report_batch_publish.
+ *
+ * @param[in]  p_server    Simple Beacon Server structure pointer
+ * @param[in]  p_events    Events to publish, oldest first.
+ * @param[in]  count       Number of events.
+ * @param[out] p_published Number of events included in the published message.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, no free pool block, or the send window is full.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ * @retval NRF_ERROR_INVALID_LENGTH There are no events.
+ */
+uint32_t simple_beacon_server_presence_events_publish(simple_beacon_server_t * p_server,
+                                                      const simple_beacon_presence_event_t * p_events,
+                                                      uint32_t count,
+                                                      uint32_t * p_published);
+
+/**
+ * Publishes a Presence Digest message.
+ *
+ * On success, the report sequence number is incremented and the access token is stored in
+ * @c batch_token, as for @ref simple_beacon_server_report_batch_publish.
+ *
+ * @param[in] p_server      Simple Beacon Server structure pointer
+ * @param[in] present_count Number of present eartags.
+ * @param[in] fingerprint   Fingerprint of the present eartags.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message, no free pool block, or the send window is full.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t simple_beacon_server_presence_digest_publish(simple_beacon_server_t * p_server,
+                                                      uint16_t present_count,
+                                                      uint32_t fingerprint);
+
+/**
+ * Retransmits the oldest report message reported missing by the gateway, or else the oldest
+ * report message left unacknowledged for longer than its retransmission timeout. The timeout
+ * doubles with every retransmission of the same message.
+ *
+ * Messages out of retransmissions are given up first, through @c report_expired_cb.
+ *
+ * On success, the access token of the message is stored in @c batch_token.
+ *
+ * @param[in] p_server   Simple Beacon Server structure pointer
+ * @param[in] timeout_ms Time before the first retransmission of an unacknowledged message, in milliseconds.
+ *
+ * @retval NRF_SUCCESS              Successfully queued packet for transmission.
+ * @retval NRF_ERROR_NULL           NULL pointer supplied to function.
+ * @retval NRF_ERROR_NOT_FOUND      No report message to retransmit, or no send window set.
+ * @retval NRF_ERROR_NO_MEM         Not enough memory available for message.
+ * @retval NRF_ERROR_INVALID_PARAM  Model not bound to appkey, publish address not set or wrong
+ *                                  opcode format.
+ */
+uint32_t simple_beacon_server_report_retransmit(simple_beacon_server_t * p_server, uint32_t timeout_ms);
+
+/**
+ * Checks whether @ref simple_beacon_server_report_retransmit has a report message to retransmit.
+ *
+ * @param[in] p_server   Simple Beacon Server structure pointer
+ * @param[in] timeout_ms Time before the first retransmission of an unacknowledged message, in milliseconds.
+ *
+ * @returns @c true if a report message is due for retransmission, or is to be given up.
+ */
+bool simple_beacon_server_report_retransmit_due(simple_beacon_server_t * p_server, uint32_t timeout_ms);
+
 /** @} end of SIMPLE_BEACON_SERVER */
 
 #endif /* SIMPLE_BEACON_SERVER_H__ */
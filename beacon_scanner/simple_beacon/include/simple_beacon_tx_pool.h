@@ -0,0 +1,175 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIMPLE_BEACON_TX_POOL_H__
+#define SIMPLE_BEACON_TX_POOL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_mesh_config_app.h"
+
+/**
+ * @defgroup SIMPLE_BEACON_TX_POOL Simple Beacon TX buffer pool
+ * @ingroup SIMPLE_BEACON_MODEL
+ * Fixed pool of message buffers for the Simple Beacon Server.
+ *
+ * Messages are built in place in a pool block, and the same block is handed to the access layer
+ * and kept in the report send window for retransmissions, so a message is never copied between
+ * buffers of the model, and no message sized buffer lives on the stack.
+ *
+ * Blocks are reference counted. The owner of a new block holds one reference, every transmission
+ * holds one until the TX complete event with its access token, and the send window holds one
+ * until the message is acknowledged. A block returns to the pool when the last reference is gone.
+ * When more transmissions are held than tracked, the oldest is released, so a transmission that
+ * never completes does not leak its block.
+ *
+ * The pool has no SDK dependencies other than the mesh assert, and can be built for the host. It is
+ * sized from the shard count in the application model configuration.
+ * @{
+ */
+
+/** Size of a pool block, the largest message parameters of a vendor message. */
+#define SIMPLE_BEACON_TX_BLOCK_SIZE     (377)
+
+/** Number of report messages that can wait for an acknowledgement, per send window. Defined
+ * with the pool, which is sized from it. */
+#ifndef SIMPLE_BEACON_REPORT_WINDOW_SIZE
+#define SIMPLE_BEACON_REPORT_WINDOW_SIZE    (8)
+#endif
+
+/** Number of servers sharing the pool, each with a send window, one per shard of the application
+ * model configuration. */
+#define SIMPLE_BEACON_TX_POOL_SERVER_COUNT  (SIMPLE_BEACON_SERVER_SHARD_COUNT)
+
+/** Blocks left when all send windows are full: the report being built, and the Status and
+ * Reports Page replies. */
+#define SIMPLE_BEACON_TX_POOL_HEADROOM  (4)
+
+/** Number of blocks in the pool. Full send windows must not starve the replies. */
+#define SIMPLE_BEACON_TX_POOL_SIZE \
+    (SIMPLE_BEACON_TX_POOL_SERVER_COUNT * SIMPLE_BEACON_REPORT_WINDOW_SIZE + SIMPLE_BEACON_TX_POOL_HEADROOM)
+
+/** Number of transmissions tracked at once. */
+#ifndef SIMPLE_BEACON_TX_POOL_TX_MAX
+#define SIMPLE_BEACON_TX_POOL_TX_MAX    (8)
+#endif
+
+/** Pool block. */
+typedef struct
+{
+    uint8_t data[SIMPLE_BEACON_TX_BLOCK_SIZE]; /**< Message parameters. */
+    uint8_t refs;                              /**< Number of references, 0 for a free block. */
+} simple_beacon_tx_block_t;
+
+/** Transmission holding a block. */
+typedef struct
+{
+    uint32_t                   token;   /**< Access token of the transmission. */
+    simple_beacon_tx_block_t * p_block; /**< Block being transmitted. */
+} simple_beacon_tx_pool_tx_t;
+
+/** Block pool. */
+typedef struct
+{
+    simple_beacon_tx_block_t blocks[SIMPLE_BEACON_TX_POOL_SIZE]; /**< Pool blocks. */
+    simple_beacon_tx_pool_tx_t tx[SIMPLE_BEACON_TX_POOL_TX_MAX]; /**< Transmissions holding a block, oldest first. */
+    uint32_t tx_count;                                           /**< Number of transmissions holding a block. */
+    uint32_t alloc_fail_count;                                   /**< Number of allocations that found no free block. */
+} simple_beacon_tx_pool_t;
+
+/**
+ * Initializes a pool with all blocks free.
+ *
+ * @param[out] p_pool Pool to initialize.
+ */
+void simple_beacon_tx_pool_init(simple_beacon_tx_pool_t * p_pool);
+
+/**
+ * Allocates a block, with one reference held by the caller.
+ *
+ * @param[in,out] p_pool Pool.
+ *
+ * @returns Data of the block, @ref SIMPLE_BEACON_TX_BLOCK_SIZE bytes, or NULL if all blocks are in use.
+ */
+uint8_t * simple_beacon_tx_pool_alloc(simple_beacon_tx_pool_t * p_pool);
+
+/**
+ * Adds a reference to a block.
+ *
+ * @param[in,out] p_pool Pool.
+ * @param[in]     p_data Data of a block of @p p_pool.
+ */
+void simple_beacon_tx_pool_ref(simple_beacon_tx_pool_t * p_pool, const uint8_t * p_data);
+
+/**
+ * Removes a reference from a block, and frees the block if it was the last one.
+ *
+ * @param[in,out] p_pool Pool.
+ * @param[in]     p_data Data of a block of @p p_pool.
+ */
+void simple_beacon_tx_pool_unref(simple_beacon_tx_pool_t * p_pool, const uint8_t * p_data);
+
+/**
+ * Holds a block until the TX complete event of a transmission.
+ *
+ * @param[in,out] p_pool Pool.
+ * @param[in]     p_data Data of a block of @p p_pool.
+ * @param[in]     token  Access token of the transmission.
+ */
+void simple_beacon_tx_pool_tx_hold(simple_beacon_tx_pool_t * p_pool, const uint8_t * p_data, uint32_t token);
+
+/**
+ * Releases the block held by a transmission, if any.
+ *
+ * @param[in,out] p_pool Pool.
+ * @param[in]     token  Access token of the completed transmission.
+ */
+void simple_beacon_tx_pool_tx_complete(simple_beacon_tx_pool_t * p_pool, uint32_t token);
+
+/**
+ * Gets the number of free blocks.
+ *
+ * @param[in] p_pool Pool.
+ *
+ * @returns Number of free blocks.
+ */
+uint32_t simple_beacon_tx_pool_free_count(const simple_beacon_tx_pool_t * p_pool);
+
+/** @} end of SIMPLE_BEACON_TX_POOL */
+
+#endif /* SIMPLE_BEACON_TX_POOL_H__ */
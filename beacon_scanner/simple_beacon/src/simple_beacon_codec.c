@@ -0,0 +1,191 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "simple_beacon_codec.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RSSI_BUCKET_MAX     (15)
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static uint64_t addr_to_u64(const uint8_t * p_addr)
+{
+    uint64_t value = 0;
+    for (uint32_t i = SIMPLE_BEACON_CODEC_ADDR_LEN; i > 0; i--)
+    {
+        value = (value << 8) | p_addr[i - 1];
+    }
+    return value;
+}
+
+static void addr_from_u64(uint8_t * p_addr, uint64_t value)
+{
+    for (uint32_t i = 0; i < SIMPLE_BEACON_CODEC_ADDR_LEN; i++)
+    {
+        p_addr[i] = (uint8_t) value;
+        value >>= 8;
+    }
+}
+
+static uint32_t varint_put(uint8_t * p_buffer, uint64_t value)
+{
+    uint32_t length = 0;
+    while (value >= 0x80)
+    {
+        p_buffer[length++] = (uint8_t) (value | 0x80);
+        value >>= 7;
+    }
+    p_buffer[length++] = (uint8_t) value;
+    return length;
+}
+
+static bool varint_get(const uint8_t * p_buffer, uint32_t length, uint32_t * p_offset, uint64_t * p_value)
+{
+    uint64_t value = 0;
+    for (uint32_t shift = 0; shift < 64 && *p_offset < length; shift += 7)
+    {
+        uint8_t byte = p_buffer[(*p_offset)++];
+        value |= (uint64_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            *p_value = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint8_t rssi_to_bucket(int8_t rssi)
+{
+    int32_t bucket = ((int32_t) rssi - SIMPLE_BEACON_CODEC_RSSI_FLOOR) / SIMPLE_BEACON_CODEC_RSSI_STEP;
+    if (bucket < 0)
+    {
+        return 0;
+    }
+    return (bucket > RSSI_BUCKET_MAX) ? RSSI_BUCKET_MAX : (uint8_t) bucket;
+}
+
+static int8_t rssi_from_bucket(uint8_t bucket)
+{
+    /* Middle of the bucket. */
+    return (int8_t) (SIMPLE_BEACON_CODEC_RSSI_FLOOR + bucket * SIMPLE_BEACON_CODEC_RSSI_STEP +
+                     SIMPLE_BEACON_CODEC_RSSI_STEP / 2);
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+uint32_t simple_beacon_codec_encode(const simple_beacon_report_entry_t * p_entries,
+                                    uint32_t count,
+                                    uint8_t * p_buffer,
+                                    uint32_t size,
+                                    uint32_t * p_length)
+{
+    uint8_t scratch[SIMPLE_BEACON_CODEC_ENTRY_SIZE_MAX];
+    uint64_t previous = 0;
+    uint32_t length = 0;
+    uint32_t encoded;
+
+    for (encoded = 0; encoded < count; encoded++)
+    {
+        const simple_beacon_report_entry_t * p_entry = &p_entries[encoded];
+        uint64_t addr = addr_to_u64(p_entry->addr);
+        int64_t delta = (int64_t) (addr - previous);
+        uint64_t zigzag = ((uint64_t) delta << 1) ^ (uint64_t) (delta >> 63);
+
+        uint32_t entry_length = varint_put(&scratch[0], zigzag);
+        entry_length += varint_put(&scratch[entry_length], (p_entry->count > 0) ? p_entry->count - 1u : 0);
+        scratch[entry_length++] = (uint8_t) ((rssi_to_bucket(p_entry->rssi_avg) << 4) | rssi_to_bucket(p_entry->rssi_max));
+        entry_length += varint_put(&scratch[entry_length], p_entry->age);
+
+        if (length + entry_length > size)
+        {
+            break;
+        }
+        for (uint32_t i = 0; i < entry_length; i++)
+        {
+            p_buffer[length + i] = scratch[i];
+        }
+        length += entry_length;
+        previous = addr;
+    }
+
+    *p_length = length;
+    return encoded;
+}
+
+bool simple_beacon_codec_decode(const uint8_t * p_buffer,
+                                uint32_t length,
+                                simple_beacon_report_entry_t * p_entries,
+                                uint32_t count)
+{
+    uint64_t previous = 0;
+    uint32_t offset = 0;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t zigzag;
+        uint64_t count_minus_one;
+        uint64_t age;
+        if (!varint_get(p_buffer, length, &offset, &zigzag) ||
+            !varint_get(p_buffer, length, &offset, &count_minus_one) ||
+            offset >= length)
+        {
+            return false;
+        }
+        uint8_t rssi = p_buffer[offset++];
+        if (!varint_get(p_buffer, length, &offset, &age) ||
+            count_minus_one >= UINT16_MAX || age > UINT16_MAX)
+        {
+            return false;
+        }
+
+        int64_t delta = (int64_t) (zigzag >> 1) ^ -(int64_t) (zigzag & 1);
+        previous = (previous + (uint64_t) delta) & 0xFFFFFFFFFFFFull;
+        addr_from_u64(p_entries[i].addr, previous);
+        p_entries[i].count = (uint16_t) (count_minus_one + 1);
+        p_entries[i].rssi_avg = rssi_from_bucket(rssi >> 4);
+        p_entries[i].rssi_max = rssi_from_bucket(rssi & 0x0F);
+        p_entries[i].age = (uint16_t) age;
+    }
+    return offset == length;
+}
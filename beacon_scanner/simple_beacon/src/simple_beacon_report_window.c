@@ -0,0 +1,229 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "simple_beacon_report_window.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+/** Gets the distance from @p base to @p seq in sequence number space, negative if @p seq is older. */
+static inline int32_t seq_distance(uint16_t seq, uint16_t base)
+{
+    return (int16_t) (uint16_t) (seq - base);
+}
+
+/** Checks whether the slot is older than the other slot, NULL counts as newest. */
+static inline bool slot_is_older(const simple_beacon_report_slot_t * p_slot, const simple_beacon_report_slot_t * p_other)
+{
+    return (p_other == NULL || seq_distance(p_slot->seq, p_other->seq) < 0);
+}
+
+static void slot_release(simple_beacon_report_window_t * p_window, simple_beacon_report_slot_t * p_slot)
+{
+    p_slot->state = SIMPLE_BEACON_REPORT_SLOT_FREE;
+    simple_beacon_tx_pool_unref(p_window->p_pool, p_slot->p_data);
+    p_window->count--;
+}
+
+static void slot_free(simple_beacon_report_window_t * p_window, simple_beacon_report_slot_t * p_slot)
+{
+    slot_release(p_window, p_slot);
+    p_window->acked_count++;
+}
+
+/** Checks whether the retransmission timeout of a sent message has expired. */
+static bool slot_timed_out(const simple_beacon_report_slot_t * p_slot, uint32_t now, uint32_t timeout)
+{
+    uint32_t shift = (p_slot->retries < SIMPLE_BEACON_REPORT_BACKOFF_SHIFT_MAX) ?
+                     p_slot->retries : SIMPLE_BEACON_REPORT_BACKOFF_SHIFT_MAX;
+    return (now - p_slot->sent_timestamp >= (timeout << shift));
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void simple_beacon_report_window_init(simple_beacon_report_window_t * p_window, simple_beacon_tx_pool_t * p_pool)
+{
+    memset(p_window, 0, sizeof(*p_window));
+    p_window->p_pool = p_pool;
+}
+
+void simple_beacon_report_window_store(simple_beacon_report_window_t * p_window,
+                                       uint16_t seq,
+                                       uint8_t opcode,
+                                       const uint8_t * p_data,
+                                       uint16_t length,
+                                       uint32_t now)
+{
+    for (uint32_t i = 0; i < SIMPLE_BEACON_REPORT_WINDOW_SIZE; i++)
+    {
+        simple_beacon_report_slot_t * p_slot = &p_window->slots[i];
+        if (p_slot->state == SIMPLE_BEACON_REPORT_SLOT_FREE)
+        {
+            simple_beacon_tx_pool_ref(p_window->p_pool, p_data);
+            p_slot->p_data = p_data;
+            p_slot->length = length;
+            p_slot->seq = seq;
+            p_slot->opcode = opcode;
+            p_slot->state = SIMPLE_BEACON_REPORT_SLOT_SENT;
+            p_slot->retries = 0;
+            p_slot->sent_timestamp = now;
+            p_slot->stored_timestamp = now;
+            p_window->count++;
+            return;
+        }
+    }
+}
+
+uint32_t simple_beacon_report_window_ack(simple_beacon_report_window_t * p_window, uint16_t ack_seq, uint32_t bitmap)
+{
+    uint32_t acked = p_window->acked_count;
+
+    /* Sequence numbers below the highest one received are missing, not just late. */
+    int32_t highest = -1;
+    for (int32_t bit = SIMPLE_BEACON_REPORT_ACK_BITMAP_BITS - 1; bit >= 0; bit--)
+    {
+        if (bitmap & (1u << bit))
+        {
+            highest = bit + 1;
+            break;
+        }
+    }
+
+    for (uint32_t i = 0; i < SIMPLE_BEACON_REPORT_WINDOW_SIZE; i++)
+    {
+        simple_beacon_report_slot_t * p_slot = &p_window->slots[i];
+        if (p_slot->state == SIMPLE_BEACON_REPORT_SLOT_FREE)
+        {
+            continue;
+        }
+
+        int32_t distance = seq_distance(p_slot->seq, ack_seq);
+        if (distance < 0)
+        {
+            slot_free(p_window, p_slot);
+        }
+        else if (distance > SIMPLE_BEACON_REPORT_ACK_BITMAP_BITS)
+        {
+            continue;
+        }
+        else if (distance > 0 && (bitmap & (1u << (distance - 1))))
+        {
+            slot_free(p_window, p_slot);
+        }
+        else if (distance < highest)
+        {
+            p_slot->state = SIMPLE_BEACON_REPORT_SLOT_LOST;
+        }
+    }
+    return p_window->acked_count - acked;
+}
+
+simple_beacon_report_slot_t * simple_beacon_report_window_retransmit_get(simple_beacon_report_window_t * p_window,
+                                                                         uint32_t now,
+                                                                         uint32_t timeout)
+{
+    simple_beacon_report_slot_t * p_lost = NULL;
+    simple_beacon_report_slot_t * p_expired = NULL;
+
+    for (uint32_t i = 0; i < SIMPLE_BEACON_REPORT_WINDOW_SIZE; i++)
+    {
+        simple_beacon_report_slot_t * p_slot = &p_window->slots[i];
+        if (p_slot->retries >= SIMPLE_BEACON_REPORT_RETRIES_MAX)
+        {
+            continue;
+        }
+        if (p_slot->state == SIMPLE_BEACON_REPORT_SLOT_LOST)
+        {
+            if (slot_is_older(p_slot, p_lost))
+            {
+                p_lost = p_slot;
+            }
+        }
+        else if (p_slot->state == SIMPLE_BEACON_REPORT_SLOT_SENT)
+        {
+            if (slot_timed_out(p_slot, now, timeout) && slot_is_older(p_slot, p_expired))
+            {
+                p_expired = p_slot;
+            }
+        }
+    }
+    return (p_lost != NULL) ? p_lost : p_expired;
+}
+
+simple_beacon_report_slot_t * simple_beacon_report_window_expired_get(simple_beacon_report_window_t * p_window,
+                                                                      uint32_t now,
+                                                                      uint32_t timeout)
+{
+    for (uint32_t i = 0; i < SIMPLE_BEACON_REPORT_WINDOW_SIZE; i++)
+    {
+        simple_beacon_report_slot_t * p_slot = &p_window->slots[i];
+        if (p_slot->state != SIMPLE_BEACON_REPORT_SLOT_FREE &&
+            p_slot->retries >= SIMPLE_BEACON_REPORT_RETRIES_MAX &&
+            (p_slot->state == SIMPLE_BEACON_REPORT_SLOT_LOST || slot_timed_out(p_slot, now, timeout)))
+        {
+            return p_slot;
+        }
+    }
+    return NULL;
+}
+
+void simple_beacon_report_window_expire(simple_beacon_report_window_t * p_window,
+                                        simple_beacon_report_slot_t * p_slot)
+{
+    slot_release(p_window, p_slot);
+    p_window->expired_count++;
+}
+
+void simple_beacon_report_window_sent(simple_beacon_report_window_t * p_window,
+                                      simple_beacon_report_slot_t * p_slot,
+                                      uint32_t now)
+{
+    p_slot->state = SIMPLE_BEACON_REPORT_SLOT_SENT;
+    p_slot->sent_timestamp = now;
+    if (p_slot->retries < UINT8_MAX)
+    {
+        p_slot->retries++;
+    }
+    p_window->retransmit_count++;
+}
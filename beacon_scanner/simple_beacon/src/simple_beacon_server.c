@@ -42,7 +42,13 @@
 #include <stddef.h>
 
 #include "access.h"
+#include "device_state_manager.h"
 #include "nrf_mesh_assert.h"
+#include "timer.h"
+#include "utils.h"
+
+/* Any vendor message fits in a pool block. */
+NRF_MESH_STATIC_ASSERT(SIMPLE_BEACON_TX_BLOCK_SIZE >= ACCESS_MESSAGE_LENGTH_MAX - SIMPLE_BEACON_VENDOR_OPCODE_SIZE);
 
 /*****************************************************************************
  * Static functions
@@ -66,6 +72,219 @@ static void reply_status(const simple_beacon_server_t * p_server,
     (void) access_model_reply(p_server->model_handle, p_message, &reply);
 }
 
+static void reply_timeout(timestamp_t timestamp, void * p_context)
+{
+    simple_beacon_server_t * p_server = p_context;
+    p_server->reply_pending = false;
+    reply_status(p_server, &p_server->reply_message, p_server->get_cb(p_server));
+}
+
+/* Gets the reply delay of this server in a reply window of the given length. Servers with
+ * consecutive addresses get consecutive slots. */
+static uint32_t reply_delay_ms_get(const simple_beacon_server_t * p_server, uint16_t window_ms)
+{
+    uint32_t slot_count = window_ms / SIMPLE_BEACON_REPLY_SLOT_MS;
+    uint16_t element_index;
+    if (slot_count <= 1 ||
+        access_model_element_index_get(p_server->model_handle, &element_index) != NRF_SUCCESS)
+    {
+        return 0;
+    }
+
+    dsm_local_unicast_address_t local_addresses;
+    dsm_local_unicast_addresses_get(&local_addresses);
+    return ((local_addresses.address_start + element_index) % slot_count) * SIMPLE_BEACON_REPLY_SLOT_MS;
+}
+
+/* Replies with the current state, in this server's slot if the request carries a reply window. A
+ * new request replaces a pending delayed reply. */
+static void reply_status_staggered(simple_beacon_server_t * p_server,
+                                   const access_message_rx_t * p_message,
+                                   uint16_t window_ms)
+{
+    uint32_t delay_ms = reply_delay_ms_get(p_server, window_ms);
+    if (delay_ms == 0)
+    {
+        reply_status(p_server, p_message, p_server->get_cb(p_server));
+        return;
+    }
+
+    if (p_server->reply_pending)
+    {
+        timer_sch_abort(&p_server->reply_timer);
+    }
+    p_server->reply_message = *p_message;
+    p_server->reply_message.p_data = NULL;
+    p_server->reply_message.length = 0;
+    p_server->reply_message.meta_data.p_core_metadata = NULL;
+    p_server->reply_timer.timestamp = timer_now() + MS_TO_US(delay_ms);
+    p_server->reply_timer.interval = 0;
+    p_server->reply_timer.cb = reply_timeout;
+    p_server->reply_timer.p_context = p_server;
+    p_server->reply_pending = true;
+    timer_sch_schedule(&p_server->reply_timer);
+}
+
+/* Gets the reply window of a Set or Get, 0 if the request does not carry one. */
+static uint16_t reply_window_get(const access_message_rx_t * p_message)
+{
+    NRF_MESH_STATIC_ASSERT(sizeof(simple_beacon_msg_set_staggered_t) == sizeof(simple_beacon_msg_get_staggered_t));
+    if (p_message->length < sizeof(simple_beacon_msg_set_staggered_t))
+    {
+        return 0;
+    }
+    return ((const simple_beacon_msg_set_staggered_t *) p_message->p_data)->reply_window_ms;
+}
+
+/* Checks whether publishing the state after a Set is redundant: the state did not change since it
+ * was last published, or the publication would go to the client that got a reply, or to the group
+ * the Set was sent to, whose members all received the Set already. */
+static bool status_publish_is_redundant(const simple_beacon_server_t * p_server,
+                                        const access_message_rx_t * p_message,
+                                        bool report_enable,
+                                        bool replied)
+{
+    if (p_server->status_published_valid && p_server->status_published == report_enable)
+    {
+        return true;
+    }
+
+    dsm_handle_t publish_handle;
+    nrf_mesh_address_t publish_address;
+    if (access_model_publish_address_get(p_server->model_handle, &publish_handle) != NRF_SUCCESS ||
+        dsm_address_get(publish_handle, &publish_address) != NRF_SUCCESS)
+    {
+        return false;
+    }
+    return ((replied && publish_address.value == p_message->meta_data.src.value) ||
+            publish_address.value == p_message->meta_data.dst.value);
+}
+
+/* Publishes the state after a Set, unless that is redundant. */
+static void status_publish_coalesced(simple_beacon_server_t * p_server,
+                                     const access_message_rx_t * p_message,
+                                     bool report_enable,
+                                     bool replied)
+{
+    if (status_publish_is_redundant(p_server, p_message, report_enable, replied))
+    {
+        /* The subscribers know the state, as if it had been published. */
+        p_server->status_published_valid = true;
+        p_server->status_published = report_enable;
+        p_server->status_suppressed_count++;
+        return;
+    }
+    if (simple_beacon_server_status_publish(p_server, report_enable) == NRF_ERROR_NO_MEM &&
+        !p_server->status_publish_pending)
+    {
+        /* The TX queue is full, left for the application to publish when there is room. */
+        p_server->status_publish_pending = true;
+        p_server->status_pending_timestamp = timer_now();
+    }
+}
+
+static void config_status_msg_fill(const simple_beacon_server_t * p_server,
+                                   simple_beacon_config_t * p_config,
+                                   access_message_tx_t * p_msg)
+{
+    p_server->config_get_cb(p_server, p_config);
+    p_config->version = SIMPLE_BEACON_CONFIG_VERSION;
+    p_msg->opcode.opcode = SIMPLE_BEACON_OPCODE_CONFIG_STATUS;
+    p_msg->opcode.company_id = SIMPLE_BEACON_COMPANY_ID;
+    p_msg->p_buffer = (const uint8_t *) p_config;
+    p_msg->length = sizeof(*p_config);
+    p_msg->force_segmented = false;
+    p_msg->transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    p_msg->access_token = nrf_mesh_unique_token_get();
+}
+
+static void reply_config_status(const simple_beacon_server_t * p_server, const access_message_rx_t * p_message)
+{
+    simple_beacon_config_t config;
+    access_message_tx_t reply;
+    config_status_msg_fill(p_server, &config, &reply);
+    (void) access_model_reply(p_server->model_handle, p_message, &reply);
+}
+
+/* Current time for the send window, in microseconds. The window only takes differences of the
+ * wrapping clock, the timeouts are converted to microseconds to match. */
+static inline uint32_t report_window_now(void)
+{
+    return timer_now();
+}
+
+/* Gives up the report messages out of retransmissions, and hands them to the application. */
+static void report_window_expire(simple_beacon_server_t * p_server, uint32_t now, uint32_t timeout_ms)
+{
+    simple_beacon_report_slot_t * p_slot;
+    while ((p_slot = simple_beacon_report_window_expired_get(p_server->p_report_window, now,
+                                                             MS_TO_US(timeout_ms))) != NULL)
+    {
+        if (p_server->report_expired_cb != NULL)
+        {
+            p_server->report_expired_cb(p_server, p_slot->opcode, p_slot->p_data, p_slot->length,
+                                        (now - p_slot->stored_timestamp) / 1000);
+        }
+        simple_beacon_report_window_expire(p_server->p_report_window, p_slot);
+    }
+}
+
+/* Publishes a pool block, which is held until the TX complete event of the message. */
+static uint32_t block_send(simple_beacon_server_t * p_server,
+                           uint8_t opcode,
+                           const uint8_t * p_block,
+                           uint16_t length,
+                           nrf_mesh_tx_token_t * p_token)
+{
+    access_message_tx_t msg;
+    msg.opcode.opcode = opcode;
+    msg.opcode.company_id = SIMPLE_BEACON_COMPANY_ID;
+    msg.p_buffer = p_block;
+    msg.length = length;
+    msg.force_segmented = false;
+    msg.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    msg.access_token = nrf_mesh_unique_token_get();
+
+    uint32_t status = access_model_publish(p_server->model_handle, &msg);
+    if (status == NRF_SUCCESS)
+    {
+        simple_beacon_tx_pool_tx_hold(p_server->p_tx_pool, p_block, msg.access_token);
+        *p_token = msg.access_token;
+    }
+    return status;
+}
+
+/* Allocates a block for a report message, if there is room for the message in the send window. */
+static uint8_t * report_block_alloc(simple_beacon_server_t * p_server)
+{
+    if (p_server->p_report_window != NULL && simple_beacon_report_window_is_full(p_server->p_report_window))
+    {
+        return NULL;
+    }
+    return simple_beacon_tx_pool_alloc(p_server->p_tx_pool);
+}
+
+/* Publishes a message carrying the server's report sequence number, and advances the sequence on success.
+ * The caller's reference to the block is released. */
+static uint32_t report_msg_publish(simple_beacon_server_t * p_server,
+                                   uint8_t opcode,
+                                   const uint8_t * p_block,
+                                   uint16_t length)
+{
+    uint32_t status = block_send(p_server, opcode, p_block, length, &p_server->batch_token);
+    if (status == NRF_SUCCESS)
+    {
+        if (p_server->p_report_window != NULL)
+        {
+            simple_beacon_report_window_store(p_server->p_report_window, p_server->batch_seq, opcode,
+                                              p_block, length, report_window_now());
+        }
+        p_server->batch_seq++;
+    }
+    simple_beacon_tx_pool_unref(p_server->p_tx_pool, p_block);
+    return status;
+}
+
 /*****************************************************************************
  * Opcode handler callbacks
  *****************************************************************************/
@@ -77,15 +296,15 @@ static void handle_set_cb(access_model_handle_t handle, const access_message_rx_
 
     bool value = (((simple_beacon_msg_set_t*) p_message->p_data)->report_enable) > 0;
     value = p_server->set_cb(p_server, value);
-    reply_status(p_server, p_message, value);
-    (void) simple_beacon_server_status_publish(p_server, value); /* We don't care about status */
+    reply_status_staggered(p_server, p_message, reply_window_get(p_message));
+    status_publish_coalesced(p_server, p_message, value, true);
 }
 
 static void handle_get_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
 {
     simple_beacon_server_t * p_server = p_args;
     NRF_MESH_ASSERT(p_server->get_cb != NULL);
-    reply_status(p_server, p_message, p_server->get_cb(p_server));
+    reply_status_staggered(p_server, p_message, reply_window_get(p_message));
 }
 
 static void handle_set_unreliable_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
@@ -94,14 +313,189 @@ static void handle_set_unreliable_cb(access_model_handle_t handle, const access_
     NRF_MESH_ASSERT(p_server->set_cb != NULL);
     bool value = (((simple_beacon_msg_set_unreliable_t*) p_message->p_data)->report_enable) > 0;
     value = p_server->set_cb(p_server, value);
-    (void)simple_beacon_server_status_publish(p_server, value);
+    status_publish_coalesced(p_server, p_message, value, false);
+}
+
+static void handle_config_get_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    simple_beacon_server_t * p_server = p_args;
+    if (p_server->config_get_cb == NULL)
+    {
+        return;
+    }
+    reply_config_status(p_server, p_message);
+}
+
+static void handle_config_set_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    simple_beacon_server_t * p_server = p_args;
+    if (p_server->config_get_cb == NULL)
+    {
+        return;
+    }
+
+    /* Unsupported versions are answered with the current configuration, so the client can adapt. */
+    const simple_beacon_config_t * p_config = (const simple_beacon_config_t *) p_message->p_data;
+    if (p_message->length == sizeof(simple_beacon_config_t) &&
+        p_config->version == SIMPLE_BEACON_CONFIG_VERSION)
+    {
+        p_server->config_set_cb(p_server, p_config);
+    }
+    reply_config_status(p_server, p_message);
+}
+
+static void handle_watchlist_chunk_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    simple_beacon_server_t * p_server = p_args;
+    if (p_server->watchlist_chunk_cb == NULL || p_message->length < sizeof(simple_beacon_msg_watchlist_chunk_t))
+    {
+        return;
+    }
+
+    const simple_beacon_msg_watchlist_chunk_t * p_chunk = (const simple_beacon_msg_watchlist_chunk_t *) p_message->p_data;
+    simple_beacon_msg_watchlist_status_t status;
+    p_server->watchlist_chunk_cb(p_server, p_chunk, p_message->length - sizeof(simple_beacon_msg_watchlist_chunk_t), &status);
+    status.transfer_id = p_chunk->transfer_id;
+
+    access_message_tx_t reply;
+    reply.opcode.opcode = SIMPLE_BEACON_OPCODE_WATCHLIST_STATUS;
+    reply.opcode.company_id = SIMPLE_BEACON_COMPANY_ID;
+    reply.p_buffer = (const uint8_t *) &status;
+    reply.length = sizeof(status);
+    reply.force_segmented = false;
+    reply.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    reply.access_token = nrf_mesh_unique_token_get();
+    (void) access_model_reply(p_server->model_handle, p_message, &reply);
+}
+
+static void handle_report_ack_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    simple_beacon_server_t * p_server = p_args;
+    if (p_server->p_report_window == NULL || p_message->length != sizeof(simple_beacon_msg_report_ack_t))
+    {
+        return;
+    }
+
+    const simple_beacon_msg_report_ack_t * p_ack = (const simple_beacon_msg_report_ack_t *) p_message->p_data;
+    uint32_t acked_count = simple_beacon_report_window_ack(p_server->p_report_window, p_ack->ack_seq, p_ack->received_bitmap);
+    if (p_server->report_ack_cb != NULL)
+    {
+        p_server->report_ack_cb(p_server, acked_count);
+    }
+}
+
+static void handle_reports_get_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    simple_beacon_server_t * p_server = p_args;
+    if (p_server->reports_get_cb == NULL || p_message->length != sizeof(simple_beacon_msg_reports_get_t))
+    {
+        return;
+    }
+
+    /* Without a free block the request is dropped, the client requests again. */
+    uint8_t * p_block = simple_beacon_tx_pool_alloc(p_server->p_tx_pool);
+    if (p_block == NULL)
+    {
+        return;
+    }
+
+    const simple_beacon_msg_reports_get_t * p_get = (const simple_beacon_msg_reports_get_t *) p_message->p_data;
+    simple_beacon_msg_reports_page_t * p_page = (simple_beacon_msg_reports_page_t *) p_block;
+    uint32_t data_max = SIMPLE_BEACON_REPORTS_PAGE_DATA_MAX;
+    if (p_get->max_bytes != 0 && p_get->max_bytes < data_max)
+    {
+        /* Always room for one entry, an empty page ends the pull. */
+        data_max = MAX(p_get->max_bytes, SIMPLE_BEACON_CODEC_ENTRY_SIZE_MAX);
+    }
+
+    simple_beacon_report_record_t record;
+    uint32_t length = 0;
+    p_page->count = 0;
+    p_page->next_seq = p_get->since_seq;
+    p_page->next_entry = p_get->since_entry;
+    bool found = p_server->reports_get_cb(p_server, p_get->since_seq, &record);
+    if (found && record.seq == p_get->since_seq && p_get->since_entry >= record.count)
+    {
+        /* The cursor is past the end of its record. */
+        found = p_server->reports_get_cb(p_server, p_get->since_seq + 1, &record);
+    }
+
+    if (found)
+    {
+        /* Entries are encoded straight from the record, the cursor entry only applies to its own record. */
+        uint32_t first = (record.seq == p_get->since_seq) ? p_get->since_entry : 0;
+        p_page->count = (uint8_t) simple_beacon_codec_encode(&record.p_entries[first],
+                                                             MIN(record.count - first, UINT8_MAX),
+                                                             p_page->data, data_max, &length);
+        p_page->record_seq = record.seq;
+        p_page->first_entry = (uint8_t) first;
+        p_page->record_age = record.age;
+        if (first + p_page->count >= record.count)
+        {
+            p_page->next_seq = record.seq + 1;
+            p_page->next_entry = 0;
+        }
+        else
+        {
+            p_page->next_seq = record.seq;
+            p_page->next_entry = (uint8_t) (first + p_page->count);
+        }
+    }
+    else
+    {
+        p_page->record_seq = p_get->since_seq;
+        p_page->first_entry = p_get->since_entry;
+        p_page->record_age = UINT16_MAX;
+    }
+
+    access_message_tx_t reply;
+    reply.opcode.opcode = SIMPLE_BEACON_OPCODE_REPORTS_PAGE;
+    reply.opcode.company_id = SIMPLE_BEACON_COMPANY_ID;
+    reply.p_buffer = p_block;
+    reply.length = sizeof(simple_beacon_msg_reports_page_t) + length;
+    reply.force_segmented = false;
+    reply.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
+    reply.access_token = nrf_mesh_unique_token_get();
+    if (access_model_reply(p_server->model_handle, p_message, &reply) == NRF_SUCCESS)
+    {
+        simple_beacon_tx_pool_tx_hold(p_server->p_tx_pool, p_block, reply.access_token);
+    }
+    simple_beacon_tx_pool_unref(p_server->p_tx_pool, p_block);
+}
+
+static void handle_time_beacon_cb(access_model_handle_t handle, const access_message_rx_t * p_message, void * p_args)
+{
+    simple_beacon_server_t * p_server = p_args;
+    if (p_server->time_beacon_cb == NULL || p_message->length != sizeof(simple_beacon_msg_time_beacon_t))
+    {
+        return;
+    }
+
+    const simple_beacon_msg_time_beacon_t * p_beacon = (const simple_beacon_msg_time_beacon_t *) p_message->p_data;
+    uint32_t hops = (p_beacon->ttl > p_message->meta_data.ttl) ? p_beacon->ttl - p_message->meta_data.ttl : 0;
+
+    /* The scanner timestamps the packet on reception, which excludes the processing delay. */
+    uint32_t rx_age_ms = 0;
+    const nrf_mesh_rx_metadata_t * p_rx_metadata = p_message->meta_data.p_core_metadata;
+    if (p_rx_metadata != NULL && p_rx_metadata->source == NRF_MESH_RX_SOURCE_SCANNER)
+    {
+        rx_age_ms = (timer_now() - p_rx_metadata->params.scanner.timestamp) / 1000;
+    }
+
+    p_server->time_beacon_cb(p_server, p_beacon->network_time, hops, p_beacon->hop_delay, rx_age_ms);
 }
 
 static const access_opcode_handler_t m_opcode_handlers[] =
 {
     {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_SET,            SIMPLE_BEACON_COMPANY_ID), handle_set_cb},
     {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_GET,            SIMPLE_BEACON_COMPANY_ID), handle_get_cb},
-    {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_SET_UNRELIABLE, SIMPLE_BEACON_COMPANY_ID), handle_set_unreliable_cb}
+    {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_SET_UNRELIABLE, SIMPLE_BEACON_COMPANY_ID), handle_set_unreliable_cb},
+    {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_CONFIG_GET,     SIMPLE_BEACON_COMPANY_ID), handle_config_get_cb},
+    {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_CONFIG_SET,     SIMPLE_BEACON_COMPANY_ID), handle_config_set_cb},
+    {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_WATCHLIST_CHUNK, SIMPLE_BEACON_COMPANY_ID), handle_watchlist_chunk_cb},
+    {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_REPORT_ACK,     SIMPLE_BEACON_COMPANY_ID), handle_report_ack_cb},
+    {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_REPORTS_GET,    SIMPLE_BEACON_COMPANY_ID), handle_reports_get_cb},
+    {ACCESS_OPCODE_VENDOR(SIMPLE_BEACON_OPCODE_TIME_BEACON,    SIMPLE_BEACON_COMPANY_ID), handle_time_beacon_cb}
 };
 
 /*****************************************************************************
@@ -112,7 +506,9 @@ uint32_t simple_beacon_server_init(simple_beacon_server_t * p_server, uint16_t e
 {
     if (p_server == NULL ||
         p_server->get_cb == NULL ||
-        p_server->set_cb == NULL)
+        p_server->set_cb == NULL ||
+        p_server->p_tx_pool == NULL ||
+        (p_server->config_get_cb == NULL) != (p_server->config_set_cb == NULL))
     {
         return NRF_ERROR_NULL;
     }
@@ -125,6 +521,15 @@ uint32_t simple_beacon_server_init(simple_beacon_server_t * p_server, uint16_t e
     init_params.opcode_count = sizeof(m_opcode_handlers) / sizeof(m_opcode_handlers[0]);
     init_params.p_args = p_server;
     init_params.publish_timeout_cb = NULL;
+    p_server->batch_seq = 0;
+    p_server->status_published_valid = false;
+    p_server->status_suppressed_count = 0;
+    p_server->status_publish_pending = false;
+    p_server->reply_pending = false;
+    if (p_server->p_report_window != NULL)
+    {
+        simple_beacon_report_window_init(p_server->p_report_window, p_server->p_tx_pool);
+    }
     return access_model_add(&init_params, &p_server->model_handle);
 }
 
@@ -140,20 +545,195 @@ uint32_t simple_beacon_server_status_publish(simple_beacon_server_t * p_server,
     msg.force_segmented = false;
     msg.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
     msg.access_token = nrf_mesh_unique_token_get();
-    return access_model_publish(p_server->model_handle, &msg);
+    uint32_t result = access_model_publish(p_server->model_handle, &msg);
+    if (result == NRF_SUCCESS)
+    {
+        p_server->status_token = msg.access_token;
+        p_server->status_published_valid = true;
+        p_server->status_published = value;
+        p_server->status_publish_pending = false;
+    }
+    return result;
 }
 
 uint32_t simple_beacon_server_report_publish(simple_beacon_server_t * p_server, uint8_t * data)
 {
-    simple_beacon_msg_report_t report_msg;
-    memcpy(report_msg.custome_data, data, 16);
+    uint8_t * p_block = simple_beacon_server_tx_block_alloc(p_server);
+    if (p_block == NULL)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+    memcpy(((simple_beacon_msg_report_t *) p_block)->custome_data, data, 16);
+    return simple_beacon_server_tx_block_publish(p_server, SIMPLE_BEACON_OPCODE_REPORT_STATUS, p_block,
+                                                 sizeof(simple_beacon_msg_report_t));
+}
+
+uint8_t * simple_beacon_server_tx_block_alloc(simple_beacon_server_t * p_server)
+{
+    return (p_server == NULL) ? NULL : simple_beacon_tx_pool_alloc(p_server->p_tx_pool);
+}
+
+uint32_t simple_beacon_server_tx_block_publish(simple_beacon_server_t * p_server,
+                                               uint8_t opcode,
+                                               uint8_t * p_block,
+                                               uint16_t length)
+{
+    if (p_server == NULL || p_block == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    nrf_mesh_tx_token_t token;
+    uint32_t status = block_send(p_server, opcode, p_block, length, &token);
+    simple_beacon_tx_pool_unref(p_server->p_tx_pool, p_block);
+    return status;
+}
+
+void simple_beacon_server_tx_complete(simple_beacon_server_t * p_server, nrf_mesh_tx_token_t token)
+{
+    simple_beacon_tx_pool_tx_complete(p_server->p_tx_pool, token);
+}
+
+uint32_t simple_beacon_server_config_status_publish(simple_beacon_server_t * p_server)
+{
+    if (p_server == NULL || p_server->config_get_cb == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    simple_beacon_config_t config;
     access_message_tx_t msg;
-    msg.opcode.opcode = SIMPLE_BEACON_OPCODE_REPORT_STATUS;
-    msg.opcode.company_id = SIMPLE_BEACON_COMPANY_ID;
-    msg.p_buffer = (const uint8_t *) &report_msg;
-    msg.length = sizeof(report_msg);
-    msg.force_segmented = false;
-    msg.transmic_size = NRF_MESH_TRANSMIC_SIZE_DEFAULT;
-    msg.access_token = nrf_mesh_unique_token_get();
+    config_status_msg_fill(p_server, &config, &msg);
     return access_model_publish(p_server->model_handle, &msg);
 }
+
+uint32_t simple_beacon_server_report_batch_publish(simple_beacon_server_t * p_server,
+                                                   const simple_beacon_report_entry_t * p_entries,
+                                                   uint32_t count,
+                                                   uint32_t base_time,
+                                                   uint32_t * p_published)
+{
+    if (p_server == NULL || p_entries == NULL || p_published == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (count == 0)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    uint8_t * p_block = report_block_alloc(p_server);
+    if (p_block == NULL)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    simple_beacon_msg_report_batch_t * p_batch = (simple_beacon_msg_report_batch_t *) p_block;
+    uint32_t length;
+    uint32_t encoded = simple_beacon_codec_encode(p_entries, MIN(count, UINT8_MAX), p_batch->data,
+                                                  SIMPLE_BEACON_REPORT_BATCH_DATA_MAX, &length);
+    p_batch->batch_seq = p_server->batch_seq;
+    p_batch->count = (uint8_t) encoded;
+    p_batch->base_time = base_time;
+
+    uint32_t status = report_msg_publish(p_server, SIMPLE_BEACON_OPCODE_REPORT_BATCH, p_block,
+                                         sizeof(simple_beacon_msg_report_batch_t) + length);
+    *p_published = (status == NRF_SUCCESS) ? encoded : 0;
+    return status;
+}
+
+uint32_t simple_beacon_server_presence_events_publish(simple_beacon_server_t * p_server,
+                                                      const simple_beacon_presence_event_t * p_events,
+                                                      uint32_t count,
+                                                      uint32_t * p_published)
+{
+    if (p_server == NULL || p_events == NULL || p_published == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (count == 0)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    uint8_t * p_block = report_block_alloc(p_server);
+    if (p_block == NULL)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    simple_beacon_msg_presence_events_t * p_msg = (simple_beacon_msg_presence_events_t *) p_block;
+    uint32_t included = MIN(count, SIMPLE_BEACON_PRESENCE_EVENTS_MAX);
+    p_msg->batch_seq = p_server->batch_seq;
+    p_msg->count = (uint8_t) included;
+    memcpy(p_msg->events, p_events, included * sizeof(simple_beacon_presence_event_t));
+
+    uint32_t status = report_msg_publish(p_server, SIMPLE_BEACON_OPCODE_PRESENCE_EVENTS, p_block,
+                                         sizeof(simple_beacon_msg_presence_events_t) +
+                                         included * sizeof(simple_beacon_presence_event_t));
+    *p_published = (status == NRF_SUCCESS) ? included : 0;
+    return status;
+}
+
+uint32_t simple_beacon_server_presence_digest_publish(simple_beacon_server_t * p_server,
+                                                      uint16_t present_count,
+                                                      uint32_t fingerprint)
+{
+    if (p_server == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    uint8_t * p_block = report_block_alloc(p_server);
+    if (p_block == NULL)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    simple_beacon_msg_presence_digest_t * p_digest = (simple_beacon_msg_presence_digest_t *) p_block;
+    p_digest->batch_seq = p_server->batch_seq;
+    p_digest->present_count = present_count;
+    p_digest->fingerprint = fingerprint;
+    return report_msg_publish(p_server, SIMPLE_BEACON_OPCODE_PRESENCE_DIGEST, p_block, sizeof(*p_digest));
+}
+
+uint32_t simple_beacon_server_report_retransmit(simple_beacon_server_t * p_server, uint32_t timeout_ms)
+{
+    if (p_server == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (p_server->p_report_window == NULL)
+    {
+        /* Without a send window nothing is kept for retransmission. */
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    uint32_t now = report_window_now();
+    report_window_expire(p_server, now, timeout_ms);
+    simple_beacon_report_slot_t * p_slot =
+        simple_beacon_report_window_retransmit_get(p_server->p_report_window, now, MS_TO_US(timeout_ms));
+    if (p_slot == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    uint32_t status = block_send(p_server, p_slot->opcode, p_slot->p_data, p_slot->length, &p_server->batch_token);
+    if (status == NRF_SUCCESS)
+    {
+        simple_beacon_report_window_sent(p_server->p_report_window, p_slot, now);
+    }
+    return status;
+}
+
+bool simple_beacon_server_report_retransmit_due(simple_beacon_server_t * p_server, uint32_t timeout_ms)
+{
+    if (p_server == NULL || p_server->p_report_window == NULL)
+    {
+        return false;
+    }
+
+    uint32_t now = report_window_now();
+    return (simple_beacon_report_window_retransmit_get(p_server->p_report_window, now, MS_TO_US(timeout_ms)) != NULL ||
+            simple_beacon_report_window_expired_get(p_server->p_report_window, now, MS_TO_US(timeout_ms)) != NULL);
+}
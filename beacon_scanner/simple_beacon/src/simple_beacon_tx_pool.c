@@ -0,0 +1,139 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "simple_beacon_tx_pool.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "nrf_mesh_assert.h"
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static simple_beacon_tx_block_t * block_get(simple_beacon_tx_pool_t * p_pool, const uint8_t * p_data)
+{
+    /* The data is the first member of the block, it must be the start of one of the pool's blocks. */
+    const uint8_t * p_first = (const uint8_t *) &p_pool->blocks[0];
+    NRF_MESH_ASSERT(p_data >= p_first && p_data < (const uint8_t *) &p_pool->blocks[SIMPLE_BEACON_TX_POOL_SIZE]);
+    NRF_MESH_ASSERT((size_t) (p_data - p_first) % sizeof(p_pool->blocks[0]) == 0);
+    return (simple_beacon_tx_block_t *) p_data;
+}
+
+static void tx_remove(simple_beacon_tx_pool_t * p_pool, uint32_t index)
+{
+    p_pool->tx[index].p_block->refs--;
+    p_pool->tx_count--;
+    memmove(&p_pool->tx[index], &p_pool->tx[index + 1], (p_pool->tx_count - index) * sizeof(p_pool->tx[0]));
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void simple_beacon_tx_pool_init(simple_beacon_tx_pool_t * p_pool)
+{
+    memset(p_pool, 0, sizeof(*p_pool));
+}
+
+uint8_t * simple_beacon_tx_pool_alloc(simple_beacon_tx_pool_t * p_pool)
+{
+    for (uint32_t i = 0; i < SIMPLE_BEACON_TX_POOL_SIZE; i++)
+    {
+        if (p_pool->blocks[i].refs == 0)
+        {
+            p_pool->blocks[i].refs = 1;
+            return p_pool->blocks[i].data;
+        }
+    }
+    p_pool->alloc_fail_count++;
+    return NULL;
+}
+
+void simple_beacon_tx_pool_ref(simple_beacon_tx_pool_t * p_pool, const uint8_t * p_data)
+{
+    block_get(p_pool, p_data)->refs++;
+}
+
+void simple_beacon_tx_pool_unref(simple_beacon_tx_pool_t * p_pool, const uint8_t * p_data)
+{
+    simple_beacon_tx_block_t * p_block = block_get(p_pool, p_data);
+    if (p_block->refs > 0)
+    {
+        p_block->refs--;
+    }
+}
+
+void simple_beacon_tx_pool_tx_hold(simple_beacon_tx_pool_t * p_pool, const uint8_t * p_data, uint32_t token)
+{
+    if (p_pool->tx_count >= SIMPLE_BEACON_TX_POOL_TX_MAX)
+    {
+        /* The oldest transmission is long done, its event was lost. */
+        tx_remove(p_pool, 0);
+    }
+    p_pool->tx[p_pool->tx_count].token = token;
+    p_pool->tx[p_pool->tx_count].p_block = block_get(p_pool, p_data);
+    p_pool->tx_count++;
+    simple_beacon_tx_pool_ref(p_pool, p_data);
+}
+
+void simple_beacon_tx_pool_tx_complete(simple_beacon_tx_pool_t * p_pool, uint32_t token)
+{
+    for (uint32_t i = 0; i < p_pool->tx_count; i++)
+    {
+        if (p_pool->tx[i].token == token)
+        {
+            tx_remove(p_pool, i);
+            return;
+        }
+    }
+}
+
+uint32_t simple_beacon_tx_pool_free_count(const simple_beacon_tx_pool_t * p_pool)
+{
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < SIMPLE_BEACON_TX_POOL_SIZE; i++)
+    {
+        if (p_pool->blocks[i].refs == 0)
+        {
+            count++;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,152 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dfu_policy.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** FNV-1a parameters. */
+#define FNV_OFFSET_BASIS    (0x811C9DC5u)
+#define FNV_PRIME           (0x01000193u)
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static inline uint32_t fnv_byte_add(uint32_t hash, uint8_t byte)
+{
+    return (hash ^ byte) * FNV_PRIME;
+}
+
+static bool version_is_blocked(const dfu_policy_t * p_policy, uint32_t version)
+{
+    for (uint32_t i = 0; i < p_policy->blocked_count && i < DFU_POLICY_BLOCKED_MAX; i++)
+    {
+        if (p_policy->blocked[i] == version)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+uint8_t dfu_policy_cohort_get(const uint8_t * p_uuid, uint32_t length, uint16_t salt)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+    hash = fnv_byte_add(hash, (uint8_t) salt);
+    hash = fnv_byte_add(hash, (uint8_t) (salt >> 8));
+    for (uint32_t i = 0; i < length; i++)
+    {
+        hash = fnv_byte_add(hash, p_uuid[i]);
+    }
+    return (uint8_t) (hash % DFU_POLICY_COHORT_COUNT);
+}
+
+dfu_policy_verdict_t dfu_policy_app_check(const dfu_policy_t * p_policy,
+                                          uint8_t cohort,
+                                          const dfu_policy_fwid_t * p_current,
+                                          const dfu_policy_fwid_t * p_offered)
+{
+    if (p_offered->company_id != p_current->company_id || p_offered->id != p_current->id)
+    {
+        return DFU_POLICY_REJECT_ID;
+    }
+    if (!dfu_policy_in_cohort(p_policy, cohort))
+    {
+        return DFU_POLICY_REJECT_COHORT;
+    }
+    if (p_offered->version == p_current->version ||
+        (p_offered->version < p_current->version && !(p_policy->flags & DFU_POLICY_FLAG_DOWNGRADE)))
+    {
+        return DFU_POLICY_REJECT_VERSION;
+    }
+    if (p_offered->version < p_policy->version_min || p_offered->version > p_policy->version_max)
+    {
+        return DFU_POLICY_REJECT_WINDOW;
+    }
+    if (version_is_blocked(p_policy, p_offered->version))
+    {
+        return DFU_POLICY_REJECT_BLOCKED;
+    }
+    return DFU_POLICY_ACCEPT;
+}
+
+dfu_policy_verdict_t dfu_policy_bootloader_check(const dfu_policy_t * p_policy,
+                                                 uint8_t cohort,
+                                                 const dfu_policy_fwid_t * p_current,
+                                                 const dfu_policy_fwid_t * p_offered)
+{
+    if (p_offered->company_id != p_current->company_id)
+    {
+        return DFU_POLICY_REJECT_ID;
+    }
+    if (!dfu_policy_in_cohort(p_policy, cohort))
+    {
+        return DFU_POLICY_REJECT_COHORT;
+    }
+    if (p_offered->version <= p_current->version)
+    {
+        return DFU_POLICY_REJECT_VERSION;
+    }
+    return DFU_POLICY_ACCEPT;
+}
+
+dfu_policy_verdict_t dfu_policy_softdevice_check(const dfu_policy_t * p_policy,
+                                                 uint8_t cohort,
+                                                 uint16_t current,
+                                                 uint16_t offered)
+{
+    if (!(p_policy->flags & DFU_POLICY_FLAG_SOFTDEVICE))
+    {
+        return DFU_POLICY_REJECT_TYPE;
+    }
+    if (!dfu_policy_in_cohort(p_policy, cohort))
+    {
+        return DFU_POLICY_REJECT_COHORT;
+    }
+    /* SoftDevice FWIDs are not ordered. */
+    if (offered == current)
+    {
+        return DFU_POLICY_REJECT_VERSION;
+    }
+    return DFU_POLICY_ACCEPT;
+}
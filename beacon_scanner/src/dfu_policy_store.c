@@ -0,0 +1,244 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dfu_policy_store.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "mesh_flash.h"
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+
+/** Record magic, "PL". */
+#define RECORD_MAGIC        (0x4C50)
+/** Erased flash word. */
+#define FLASH_ERASED_WORD   (0xFFFFFFFF)
+
+/** Number of flash operations needed for a write that erases the page first. */
+#define SAVE_OPS_MAX        (2)
+
+typedef struct
+{
+    uint16_t magic;    /**< @ref RECORD_MAGIC. */
+    uint16_t length;   /**< Length of the policy, a record of another layout is not restored. */
+    uint32_t seq;      /**< Record sequence number. */
+    dfu_policy_t policy;
+    uint32_t checksum; /**< Checksum over the fields above. */
+} record_t;
+
+NRF_MESH_STATIC_ASSERT(sizeof(record_t) % sizeof(uint32_t) == 0);
+
+static uint32_t m_page_addr;
+static uint32_t m_page_size;
+
+/* Next record is written at this offset, the page is erased first when it is past the end. */
+static uint32_t m_write_offset;
+static uint32_t m_seq;
+/* Newest valid record, NULL if none. */
+static const record_t * mp_newest;
+
+static bool m_write_busy;
+static uint16_t m_write_token;
+static bool m_save_pending;
+static dfu_policy_t m_pending_policy;
+
+/* Flash operation sources must stay valid until the operation is done. */
+static record_t m_write_buffer;
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static inline const record_t * record_get(uint32_t offset)
+{
+    return (const record_t *) (m_page_addr + offset);
+}
+
+static uint32_t record_checksum(const record_t * p_record)
+{
+    const uint32_t * p_words = (const uint32_t *) p_record;
+    uint32_t checksum = 0;
+    for (uint32_t i = 0; i < offsetof(record_t, checksum) / sizeof(uint32_t); i++)
+    {
+        checksum = ((checksum << 5) | (checksum >> 27)) ^ p_words[i];
+    }
+    return checksum;
+}
+
+static bool record_is_valid(const record_t * p_record)
+{
+    return (p_record->magic == RECORD_MAGIC &&
+            p_record->length == sizeof(dfu_policy_t) &&
+            p_record->checksum == record_checksum(p_record));
+}
+
+static bool record_is_erased(uint32_t offset)
+{
+    const uint32_t * p_words = (const uint32_t *) record_get(offset);
+    for (uint32_t i = 0; i < sizeof(record_t) / sizeof(uint32_t); i++)
+    {
+        if (p_words[i] != FLASH_ERASED_WORD)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Finds the newest record and the write position. Anything but records and erased flash makes the next write erase the page. */
+static void page_scan(void)
+{
+    mp_newest = NULL;
+    m_seq = 0;
+    m_write_offset = 0;
+    while (m_write_offset + sizeof(record_t) <= m_page_size && !record_is_erased(m_write_offset))
+    {
+        const record_t * p_record = record_get(m_write_offset);
+        if (p_record->magic != RECORD_MAGIC)
+        {
+            m_write_offset = m_page_size;
+            break;
+        }
+        if (record_is_valid(p_record) && (mp_newest == NULL || (int32_t) (p_record->seq - m_seq) >= 0))
+        {
+            mp_newest = p_record;
+            m_seq = p_record->seq + 1;
+        }
+        m_write_offset += sizeof(record_t);
+    }
+}
+
+static uint32_t record_write(const dfu_policy_t * p_policy)
+{
+    uint32_t op_count;
+    uint32_t op_bytes;
+    uint32_t status = mesh_flash_op_available(MESH_FLASH_USER_APP, &op_count, &op_bytes);
+    if (status != NRF_SUCCESS || op_count < SAVE_OPS_MAX)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    flash_operation_t op;
+    uint16_t token;
+    if (m_write_offset + sizeof(record_t) > m_page_size)
+    {
+        op.type = FLASH_OP_TYPE_ERASE;
+        op.params.erase.p_start_addr = (uint32_t *) m_page_addr;
+        op.params.erase.length = m_page_size;
+        status = mesh_flash_op_push(MESH_FLASH_USER_APP, &op, &token);
+        if (status != NRF_SUCCESS)
+        {
+            return status;
+        }
+        m_write_offset = 0;
+        mp_newest = NULL;
+    }
+
+    memset(&m_write_buffer, 0, sizeof(m_write_buffer));
+    m_write_buffer.magic = RECORD_MAGIC;
+    m_write_buffer.length = sizeof(dfu_policy_t);
+    m_write_buffer.seq = m_seq;
+    m_write_buffer.policy = *p_policy;
+    m_write_buffer.checksum = record_checksum(&m_write_buffer);
+
+    op.type = FLASH_OP_TYPE_WRITE;
+    op.params.write.p_start_addr = (uint32_t *) record_get(m_write_offset);
+    op.params.write.p_data = (const uint32_t *) &m_write_buffer;
+    op.params.write.length = sizeof(m_write_buffer);
+    status = mesh_flash_op_push(MESH_FLASH_USER_APP, &op, &m_write_token);
+    if (status == NRF_SUCCESS)
+    {
+        m_write_busy = true;
+        m_write_offset += sizeof(record_t);
+        m_seq++;
+    }
+    return status;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void dfu_policy_store_init(uint32_t page_addr, uint32_t page_size)
+{
+    NRF_MESH_ASSERT(sizeof(record_t) <= page_size);
+
+    m_page_addr = page_addr;
+    m_page_size = page_size;
+    m_write_busy = false;
+    m_save_pending = false;
+    page_scan();
+}
+
+uint32_t dfu_policy_store_load(dfu_policy_t * p_policy)
+{
+    if (mp_newest == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+    *p_policy = mp_newest->policy;
+    return NRF_SUCCESS;
+}
+
+uint32_t dfu_policy_store_save(const dfu_policy_t * p_policy)
+{
+    if (m_write_busy)
+    {
+        m_pending_policy = *p_policy;
+        m_save_pending = true;
+        return NRF_SUCCESS;
+    }
+    return record_write(p_policy);
+}
+
+void dfu_policy_store_flash_op_cb(mesh_flash_user_t user, const flash_operation_t * p_op, uint16_t token)
+{
+    if (user != MESH_FLASH_USER_APP || !m_write_busy || token != m_write_token)
+    {
+        return;
+    }
+
+    m_write_busy = false;
+    mp_newest = record_get(m_write_offset - sizeof(record_t));
+    if (m_save_pending)
+    {
+        /* If the queue is full, the policy is still applied, and stored with the next save. */
+        m_save_pending = (record_write(&m_pending_policy) != NRF_SUCCESS);
+    }
+}
@@ -0,0 +1,229 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dfu_progress.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/** AD type of 16-bit UUID service data. */
+#define AD_TYPE_SERVICE_DATA    (0x16)
+
+/** Service UUID of the mesh DFU packets. */
+#define DFU_SERVICE_UUID        (0xFEE4)
+
+/** DFU packet types carrying a segment. */
+#define DFU_PACKET_TYPE_DATA        (0xFFFC)
+#define DFU_PACKET_TYPE_DATA_RSP    (0xFFFA)
+
+/* Offsets within the service data AD structure, counted from the length field. */
+#define OFFSET_AD_TYPE          (1)
+#define OFFSET_UUID             (2)
+#define OFFSET_PACKET_TYPE      (4)
+#define OFFSET_SEGMENT          (6)
+#define OFFSET_TRANSACTION_ID   (8)
+#define OFFSET_START_ADDRESS    (12)
+#define OFFSET_START_LENGTH     (16)
+#define OFFSET_SIGNATURE_LENGTH (20)
+
+/** Length of the AD structure up to the end of the start segment fields used. */
+#define START_SEGMENT_AD_LENGTH (OFFSET_SIGNATURE_LENGTH + 2)
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static inline uint16_t le16_get(const uint8_t * p_data)
+{
+    return (uint16_t) (p_data[0] | (p_data[1] << 8));
+}
+
+static inline uint32_t le32_get(const uint8_t * p_data)
+{
+    return (uint32_t) le16_get(p_data) | ((uint32_t) le16_get(&p_data[2]) << 16);
+}
+
+static inline bool segment_is_received(const dfu_progress_t * p_progress, uint32_t segment)
+{
+    return (p_progress->bitmap[(segment - 1) / 8] & (1 << ((segment - 1) % 8))) != 0;
+}
+
+static void bitmap_reset(dfu_progress_t * p_progress, uint32_t transaction_id)
+{
+    p_progress->transaction_id = transaction_id;
+    p_progress->start_address = 0;
+    p_progress->image_length = 0;
+    p_progress->segment_count = 0;
+    p_progress->received_count = 0;
+    p_progress->highest_segment = 0;
+    memset(p_progress->bitmap, 0, sizeof(p_progress->bitmap));
+}
+
+/* Reads the image target and length from the start segment. */
+static void start_segment_read(dfu_progress_t * p_progress, const uint8_t * p_ad)
+{
+    uint32_t start_address = le32_get(&p_ad[OFFSET_START_ADDRESS]);
+    uint32_t length_bytes = le32_get(&p_ad[OFFSET_START_LENGTH]) * sizeof(uint32_t);
+    uint32_t signature_length = le16_get(&p_ad[OFFSET_SIGNATURE_LENGTH]);
+
+    /* The first segment starts at the segment boundary below the start address. */
+    uint32_t count = ((start_address % DFU_PROGRESS_SEGMENT_SIZE) + length_bytes + DFU_PROGRESS_SEGMENT_SIZE - 1) /
+                     DFU_PROGRESS_SEGMENT_SIZE;
+    count += (signature_length + DFU_PROGRESS_SEGMENT_SIZE - 1) / DFU_PROGRESS_SEGMENT_SIZE;
+    p_progress->start_address = start_address;
+    p_progress->image_length = length_bytes;
+    p_progress->segment_count = (uint16_t) ((count > DFU_PROGRESS_SEGMENT_MAX) ? DFU_PROGRESS_SEGMENT_MAX : count);
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void dfu_progress_init(dfu_progress_t * p_progress)
+{
+    memset(p_progress, 0, sizeof(*p_progress));
+    p_progress->state = DFU_PROGRESS_STATE_IDLE;
+}
+
+void dfu_progress_start(dfu_progress_t * p_progress, bool relay, uint8_t dfu_type, uint32_t fw_version)
+{
+    p_progress->state = relay ? DFU_PROGRESS_STATE_RELAY : DFU_PROGRESS_STATE_TARGET;
+    p_progress->dfu_type = dfu_type;
+    p_progress->fw_version = fw_version;
+    if (relay)
+    {
+        p_progress->relay_count++;
+    }
+}
+
+void dfu_progress_end(dfu_progress_t * p_progress, bool success, uint8_t end_reason)
+{
+    p_progress->state = success ? DFU_PROGRESS_STATE_COMPLETE : DFU_PROGRESS_STATE_FAILED;
+    p_progress->end_reason = end_reason;
+}
+
+void dfu_progress_banked(dfu_progress_t * p_progress)
+{
+    p_progress->state = DFU_PROGRESS_STATE_BANKED;
+}
+
+bool dfu_progress_packet_add(dfu_progress_t * p_progress, const uint8_t * p_data, uint8_t length)
+{
+    /* Walk the AD structures for the DFU service data. */
+    for (uint32_t offset = 0; offset + OFFSET_TRANSACTION_ID + 4 <= length; offset += p_data[offset] + 1u)
+    {
+        const uint8_t * p_ad = &p_data[offset];
+        uint32_t ad_length = p_ad[0] + 1u;
+        if (ad_length < OFFSET_TRANSACTION_ID + 4 || offset + ad_length > length ||
+            p_ad[OFFSET_AD_TYPE] != AD_TYPE_SERVICE_DATA ||
+            le16_get(&p_ad[OFFSET_UUID]) != DFU_SERVICE_UUID)
+        {
+            continue;
+        }
+
+        uint16_t packet_type = le16_get(&p_ad[OFFSET_PACKET_TYPE]);
+        if (packet_type != DFU_PACKET_TYPE_DATA && packet_type != DFU_PACKET_TYPE_DATA_RSP)
+        {
+            return false;
+        }
+
+        uint32_t segment = le16_get(&p_ad[OFFSET_SEGMENT]);
+        uint32_t transaction_id = le32_get(&p_ad[OFFSET_TRANSACTION_ID]);
+        if (transaction_id != p_progress->transaction_id)
+        {
+            bitmap_reset(p_progress, transaction_id);
+        }
+
+        if (segment == 0)
+        {
+            if (ad_length >= START_SEGMENT_AD_LENGTH)
+            {
+                start_segment_read(p_progress, p_ad);
+            }
+        }
+        else if (segment <= DFU_PROGRESS_SEGMENT_MAX)
+        {
+            if (segment_is_received(p_progress, segment))
+            {
+                p_progress->duplicate_count++;
+            }
+            else
+            {
+                p_progress->bitmap[(segment - 1) / 8] |= (uint8_t) (1 << ((segment - 1) % 8));
+                p_progress->received_count++;
+                if (segment > p_progress->highest_segment)
+                {
+                    p_progress->highest_segment = (uint16_t) segment;
+                }
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+uint32_t dfu_progress_missing_get(const dfu_progress_t * p_progress, dfu_progress_range_t * p_ranges, uint32_t max_count)
+{
+    uint32_t last = (p_progress->segment_count > 0) ? p_progress->segment_count : p_progress->highest_segment;
+    uint32_t count = 0;
+    uint32_t segment = 1;
+    while (segment <= last && count < max_count)
+    {
+        /* Skip fully received bytes of the bitmap. */
+        if ((segment - 1) % 8 == 0 && segment + 7 <= last && p_progress->bitmap[(segment - 1) / 8] == 0xFF)
+        {
+            segment += 8;
+            continue;
+        }
+        if (segment_is_received(p_progress, segment))
+        {
+            segment++;
+            continue;
+        }
+
+        uint32_t first = segment;
+        while (segment <= last && !segment_is_received(p_progress, segment))
+        {
+            segment++;
+        }
+        p_ranges[count].first = (uint16_t) first;
+        p_ranges[count].count = (uint16_t) (segment - first);
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,268 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dfu_relay.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/** AD types of mesh packets. */
+#define AD_TYPE_MESH_MESSAGE    (0x2A)
+#define AD_TYPE_MESH_BEACON     (0x2B)
+
+/** AD type of 16-bit UUID service data, and the service UUID of the mesh DFU packets. */
+#define AD_TYPE_SERVICE_DATA    (0x16)
+#define DFU_SERVICE_UUID        (0xFEE4)
+
+/** Full relay probability, in 1/256 units. */
+#define PROBABILITY_ONE         (256)
+
+/** Kind of packet, for the neighbour table. */
+typedef enum
+{
+    PACKET_OTHER,
+    PACKET_MESH,
+    PACKET_DFU
+} packet_kind_t;
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static uint32_t random_get(dfu_relay_t * p_relay)
+{
+    uint32_t x = p_relay->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p_relay->seed = x;
+    return x;
+}
+
+static packet_kind_t packet_kind_get(const uint8_t * p_data, uint8_t length)
+{
+    packet_kind_t kind = PACKET_OTHER;
+    for (uint32_t offset = 0; offset + 2 <= length; offset += p_data[offset] + 1u)
+    {
+        const uint8_t * p_ad = &p_data[offset];
+        if (p_ad[0] == 0 || offset + p_ad[0] + 1u > length)
+        {
+            break;
+        }
+
+        if (p_ad[1] == AD_TYPE_SERVICE_DATA && p_ad[0] >= 3 &&
+            (uint16_t) (p_ad[2] | (p_ad[3] << 8)) == DFU_SERVICE_UUID)
+        {
+            return PACKET_DFU;
+        }
+        if (p_ad[1] == AD_TYPE_MESH_MESSAGE || p_ad[1] == AD_TYPE_MESH_BEACON)
+        {
+            kind = PACKET_MESH;
+        }
+    }
+    return kind;
+}
+
+/* Finds the entry of a neighbour, or takes a free or the least recently heard one. */
+static dfu_relay_neighbour_t * neighbour_get(dfu_relay_t * p_relay, const uint8_t * p_addr)
+{
+    dfu_relay_neighbour_t * p_oldest = NULL;
+    for (uint32_t i = 0; i < p_relay->neighbour_count; i++)
+    {
+        dfu_relay_neighbour_t * p_neighbour = &p_relay->neighbours[i];
+        if (memcmp(p_neighbour->addr, p_addr, DFU_RELAY_ADDR_LEN) == 0)
+        {
+            return p_neighbour;
+        }
+        if (p_oldest == NULL || (int32_t) (p_neighbour->timestamp - p_oldest->timestamp) < 0)
+        {
+            p_oldest = p_neighbour;
+        }
+    }
+
+    dfu_relay_neighbour_t * p_neighbour = (p_relay->neighbour_count < DFU_RELAY_NEIGHBOURS_MAX) ?
+                                          &p_relay->neighbours[p_relay->neighbour_count++] :
+                                          p_oldest;
+    memcpy(p_neighbour->addr, p_addr, DFU_RELAY_ADDR_LEN);
+    p_neighbour->dfu = false;
+    return p_neighbour;
+}
+
+static void inputs_get(const dfu_relay_t * p_relay, uint32_t now, dfu_relay_inputs_t * p_inputs)
+{
+    p_inputs->density = 0;
+    p_inputs->transmitter_count = 0;
+    p_inputs->upstream_rssi = INT8_MIN;
+    p_inputs->hops = p_relay->hops;
+    /* The offer that opened the window came just before it. */
+    uint32_t window_start = p_relay->listen_timestamp - p_relay->config.listen_ms;
+
+    for (uint32_t i = 0; i < p_relay->neighbour_count; i++)
+    {
+        const dfu_relay_neighbour_t * p_neighbour = &p_relay->neighbours[i];
+        if (now - p_neighbour->timestamp < p_relay->config.neighbour_timeout_ms &&
+            p_neighbour->rssi >= p_relay->config.neighbour_rssi)
+        {
+            p_inputs->density++;
+        }
+        if (p_neighbour->dfu && (int32_t) (p_neighbour->dfu_timestamp - window_start) >= 0)
+        {
+            p_inputs->transmitter_count++;
+            if (p_neighbour->rssi > p_inputs->upstream_rssi)
+            {
+                p_inputs->upstream_rssi = p_neighbour->rssi;
+            }
+        }
+    }
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void dfu_relay_init(dfu_relay_t * p_relay, const dfu_relay_config_t * p_config, uint32_t seed)
+{
+    memset(p_relay, 0, sizeof(*p_relay));
+    p_relay->config = *p_config;
+    p_relay->hops = DFU_RELAY_HOPS_UNKNOWN;
+    /* Xorshift state must not be zero. */
+    p_relay->seed = seed | 1;
+}
+
+void dfu_relay_packet_add(dfu_relay_t * p_relay,
+                          const uint8_t * p_data,
+                          uint8_t length,
+                          const uint8_t * p_addr,
+                          int8_t rssi,
+                          uint32_t now)
+{
+    packet_kind_t kind = packet_kind_get(p_data, length);
+    if (kind == PACKET_OTHER)
+    {
+        return;
+    }
+
+    dfu_relay_neighbour_t * p_neighbour = neighbour_get(p_relay, p_addr);
+    p_neighbour->rssi = rssi;
+    p_neighbour->timestamp = now;
+    if (kind == PACKET_DFU)
+    {
+        p_neighbour->dfu = true;
+        p_neighbour->dfu_timestamp = now;
+    }
+}
+
+void dfu_relay_hops_set(dfu_relay_t * p_relay, uint8_t hops)
+{
+    p_relay->hops = hops;
+}
+
+bool dfu_relay_listen_start(dfu_relay_t * p_relay, uint32_t now, uint32_t * p_window_ms)
+{
+    if (p_relay->holdoff && (int32_t) (now - p_relay->holdoff_timestamp) < 0)
+    {
+        return false;
+    }
+    if (p_relay->listening)
+    {
+        return false;
+    }
+
+    p_relay->holdoff = false;
+    p_relay->listening = true;
+    p_relay->listen_timestamp = now;
+    *p_window_ms = p_relay->config.listen_ms +
+                   ((p_relay->config.listen_ms > 0) ? random_get(p_relay) % p_relay->config.listen_ms : 0);
+    return true;
+}
+
+void dfu_relay_listen_cancel(dfu_relay_t * p_relay)
+{
+    p_relay->listening = false;
+}
+
+dfu_relay_decision_t dfu_relay_decide(dfu_relay_t * p_relay, uint32_t now, dfu_relay_inputs_t * p_inputs)
+{
+    dfu_relay_inputs_t inputs;
+    inputs_get(p_relay, now, &inputs);
+    p_relay->listening = false;
+
+    /* The source itself is one of the transmitters heard. */
+    uint32_t relays_heard = (inputs.transmitter_count > 0) ? inputs.transmitter_count - 1 : 0;
+    if (inputs.upstream_rssi < p_relay->config.edge_rssi)
+    {
+        inputs.probability = PROBABILITY_ONE;
+    }
+    else if (relays_heard >= p_relay->config.target_count)
+    {
+        inputs.probability = 0;
+    }
+    else if (inputs.density <= p_relay->config.target_count)
+    {
+        inputs.probability = PROBABILITY_ONE;
+    }
+    else
+    {
+        inputs.probability = (PROBABILITY_ONE * p_relay->config.target_count) / inputs.density;
+        if (inputs.hops == 1)
+        {
+            /* The source covers the same neighbourhood. */
+            inputs.probability /= 2;
+        }
+    }
+
+    dfu_relay_decision_t decision;
+    if (inputs.probability >= PROBABILITY_ONE || random_get(p_relay) % PROBABILITY_ONE < inputs.probability)
+    {
+        decision = DFU_RELAY_DECISION_RELAY;
+        p_relay->relay_count++;
+    }
+    else
+    {
+        decision = DFU_RELAY_DECISION_SUPPRESS;
+        p_relay->suppress_count++;
+        p_relay->holdoff = true;
+        p_relay->holdoff_timestamp = now + p_relay->config.holdoff_ms;
+    }
+
+    if (p_inputs != NULL)
+    {
+        *p_inputs = inputs;
+    }
+    return decision;
+}
@@ -0,0 +1,130 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "eartag_adv.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/** AD type of manufacturer specific data. */
+#define AD_TYPE_MANUFACTURER_SPECIFIC_DATA  (0xFF)
+
+/* Offsets within the manufacturer specific AD structure, counted from the length field. */
+#define OFFSET_UUID             (6)
+#define OFFSET_MAJOR            (OFFSET_UUID + EARTAG_UUID_LEN)
+#define OFFSET_MINOR            (OFFSET_MAJOR + 2)
+#define OFFSET_TX_POWER         (OFFSET_MINOR + 2)
+
+/** Number of 32-bit words compared by the prefilter, covering the AD header and the first UUID bytes. */
+#define PREFILTER_WORD_COUNT    (3)
+
+/** Number of UUID bytes covered by the prefilter words. */
+#define PREFILTER_UUID_LEN      (PREFILTER_WORD_COUNT * sizeof(uint32_t) - OFFSET_UUID)
+
+/* Packet bytes as a little endian word, so the match words are folded by the compiler. */
+#define MATCH_WORD(B0, B1, B2, B3) \
+    ((uint32_t) (B0) | ((uint32_t) (B1) << 8) | ((uint32_t) (B2) << 16) | ((uint32_t) (B3) << 24))
+
+#define UUID_MATCH_WORDS_(U0, U1, U2, U3, U4, U5, ...) \
+    MATCH_WORD(EARTAG_BEACON_TYPE, EARTAG_BEACON_DATA_LENGTH, U0, U1), MATCH_WORD(U2, U3, U4, U5)
+#define UUID_MATCH_WORDS(...) UUID_MATCH_WORDS_(__VA_ARGS__)
+
+/* Expected first words of the manufacturer specific AD structure of an eartag. */
+static const uint32_t m_match_words[PREFILTER_WORD_COUNT] =
+{
+    MATCH_WORD(EARTAG_ADV_AD_LENGTH, AD_TYPE_MANUFACTURER_SPECIFIC_DATA,
+               EARTAG_COMPANY_ID & 0xFF, EARTAG_COMPANY_ID >> 8),
+    UUID_MATCH_WORDS(EARTAG_UUID_BYTES)
+};
+
+static const uint8_t m_eartag_uuid[EARTAG_UUID_LEN] = EARTAG_UUID;
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static inline uint32_t word_load(const uint8_t * p_data)
+{
+    /* Compiles to a single unaligned load on Cortex-M4. */
+    uint32_t word;
+    memcpy(&word, p_data, sizeof(word));
+    return word;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+bool eartag_adv_prefilter(const uint8_t * p_data, uint8_t length)
+{
+    if (length != EARTAG_ADV_PACKET_LENGTH)
+    {
+        return false;
+    }
+
+    const uint8_t * p_ad = &p_data[EARTAG_ADV_PREFIX_LEN];
+    for (uint32_t i = 0; i < PREFILTER_WORD_COUNT; i++)
+    {
+        if (word_load(&p_ad[i * sizeof(uint32_t)]) != m_match_words[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool eartag_adv_parse(const uint8_t * p_data, uint8_t length, eartag_sighting_t * p_sighting)
+{
+    if (!eartag_adv_prefilter(p_data, length))
+    {
+        return false;
+    }
+
+    const uint8_t * p_ad = &p_data[EARTAG_ADV_PREFIX_LEN];
+    if (memcmp(&p_ad[OFFSET_UUID + PREFILTER_UUID_LEN], &m_eartag_uuid[PREFILTER_UUID_LEN],
+               EARTAG_UUID_LEN - PREFILTER_UUID_LEN) != 0)
+    {
+        return false;
+    }
+
+    /* Major and minor are big endian, as in iBeacon. */
+    p_sighting->major = (uint16_t) ((p_ad[OFFSET_MAJOR] << 8) | p_ad[OFFSET_MAJOR + 1]);
+    p_sighting->minor = (uint16_t) ((p_ad[OFFSET_MINOR] << 8) | p_ad[OFFSET_MINOR + 1]);
+    p_sighting->tx_power = (int8_t) p_ad[OFFSET_TX_POWER];
+    return true;
+}
@@ -0,0 +1,148 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "eartag_scanner.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "nrf_mesh.h"
+#include "nrf_mesh_assert.h"
+#include "timer.h"
+
+static bool m_enabled;
+static int8_t m_rssi_floor = INT8_MIN;
+static eartag_scanner_sighting_cb_t m_sighting_cb;
+static eartag_scanner_packet_cb_t m_packet_cb;
+static eartag_scanner_stats_t m_stats;
+
+/* Millisecond clock, extended from the 32-bit microsecond mesh timer. */
+static uint32_t m_clock_ms;
+static timestamp_t m_clock_last_us;
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static uint32_t clock_ms_update(timestamp_t now_us)
+{
+    /* Packet timestamps may be slightly older than the last clock update. */
+    int32_t elapsed_us = (int32_t) (now_us - m_clock_last_us);
+    if (elapsed_us >= 1000)
+    {
+        uint32_t elapsed_ms = (uint32_t) elapsed_us / 1000;
+        m_clock_ms += elapsed_ms;
+        m_clock_last_us += elapsed_ms * 1000;
+    }
+    return m_clock_ms;
+}
+
+static void scanner_rx_cb(const nrf_mesh_adv_packet_rx_data_t * p_rx_data)
+{
+    if (p_rx_data->p_metadata->source != NRF_MESH_RX_SOURCE_SCANNER)
+    {
+        return;
+    }
+
+    const nrf_mesh_rx_metadata_scanner_t * p_scanner = &p_rx_data->p_metadata->params.scanner;
+    eartag_sighting_t sighting;
+    bool is_eartag = eartag_adv_parse(p_rx_data->p_payload, p_rx_data->length, &sighting);
+    if (!is_eartag && m_packet_cb != NULL)
+    {
+        m_packet_cb(p_rx_data->p_payload, p_rx_data->length, p_scanner->adv_addr.addr, p_scanner->rssi);
+    }
+
+    if (!m_enabled)
+    {
+        return;
+    }
+    m_stats.rx_count++;
+    if (!is_eartag)
+    {
+        return;
+    }
+    m_stats.sighting_count++;
+    if (p_scanner->rssi < m_rssi_floor)
+    {
+        m_stats.weak_count++;
+        return;
+    }
+
+    memcpy(sighting.addr, p_scanner->adv_addr.addr, EARTAG_ADDR_LEN);
+    sighting.rssi = p_scanner->rssi;
+    sighting.timestamp = clock_ms_update(p_scanner->timestamp);
+    m_sighting_cb(&sighting);
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void eartag_scanner_init(eartag_scanner_sighting_cb_t sighting_cb)
+{
+    NRF_MESH_ASSERT(sighting_cb != NULL);
+    m_sighting_cb = sighting_cb;
+    m_enabled = false;
+    m_clock_last_us = timer_now();
+    nrf_mesh_rx_cb_set(scanner_rx_cb);
+}
+
+void eartag_scanner_packet_cb_set(eartag_scanner_packet_cb_t packet_cb)
+{
+    m_packet_cb = packet_cb;
+}
+
+void eartag_scanner_enable(bool enable)
+{
+    m_enabled = enable;
+}
+
+void eartag_scanner_rssi_floor_set(int8_t rssi_floor)
+{
+    m_rssi_floor = rssi_floor;
+}
+
+uint32_t eartag_scanner_time_ms_get(void)
+{
+    return clock_ms_update(timer_now());
+}
+
+void eartag_scanner_stats_get(eartag_scanner_stats_t * p_stats)
+{
+    *p_stats = m_stats;
+}
@@ -0,0 +1,186 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "flash_layout.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "nrf_error.h"
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static inline uint32_t page_floor(const flash_layout_t * p_layout, uint32_t addr)
+{
+    return addr - (addr % p_layout->page_size);
+}
+
+static inline uint32_t page_ceil(const flash_layout_t * p_layout, uint32_t addr)
+{
+    return page_floor(p_layout, addr + p_layout->page_size - 1);
+}
+
+static inline bool ranges_overlap(uint32_t start_a, uint32_t end_a, uint32_t start_b, uint32_t end_b)
+{
+    return start_a < end_b && start_b < end_a;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void flash_layout_init(flash_layout_t * p_layout, uint32_t flash_start, uint32_t flash_end, uint32_t page_size)
+{
+    p_layout->flash_start = flash_start;
+    p_layout->flash_end = flash_end;
+    p_layout->page_size = page_size;
+    p_layout->region_count = 0;
+    p_layout->bank_start = 0;
+    p_layout->bank_end = 0;
+}
+
+uint32_t flash_layout_region_add(flash_layout_t * p_layout, const char * p_name, uint32_t start, uint32_t end, bool keep)
+{
+    if (start >= end || start < p_layout->flash_start || end > p_layout->flash_end)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (p_layout->region_count == FLASH_LAYOUT_REGIONS_MAX)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    /* Insertion sort, keeping the regions lowest first. */
+    uint32_t index = p_layout->region_count;
+    for (uint32_t i = 0; i < p_layout->region_count; i++)
+    {
+        const flash_layout_region_t * p_region = &p_layout->regions[i];
+        if (ranges_overlap(start, end, p_region->start, p_region->end))
+        {
+            return NRF_ERROR_INVALID_STATE;
+        }
+        if (index == p_layout->region_count && start < p_region->start)
+        {
+            index = i;
+        }
+    }
+    for (uint32_t i = p_layout->region_count; i > index; i--)
+    {
+        p_layout->regions[i] = p_layout->regions[i - 1];
+    }
+
+    p_layout->regions[index].p_name = p_name;
+    p_layout->regions[index].start = start;
+    p_layout->regions[index].end = end;
+    p_layout->regions[index].keep = keep;
+    p_layout->region_count++;
+    return NRF_SUCCESS;
+}
+
+uint32_t flash_layout_bank_plan(flash_layout_t * p_layout)
+{
+    uint32_t best_start = 0;
+    uint32_t best_size = 0;
+    uint32_t cursor = p_layout->flash_start;
+
+    /* Walk the gaps between the regions, and the one after the last. */
+    for (uint32_t i = 0; i <= p_layout->region_count; i++)
+    {
+        uint32_t gap_end = (i < p_layout->region_count) ? p_layout->regions[i].start : p_layout->flash_end;
+        uint32_t start = page_ceil(p_layout, cursor);
+        uint32_t end = page_floor(p_layout, gap_end);
+        if (end > start && end - start > best_size)
+        {
+            best_start = start;
+            best_size = end - start;
+        }
+        if (i < p_layout->region_count)
+        {
+            cursor = p_layout->regions[i].end;
+        }
+    }
+
+    if (best_size == 0)
+    {
+        p_layout->bank_start = 0;
+        p_layout->bank_end = 0;
+        return NRF_ERROR_NO_MEM;
+    }
+    p_layout->bank_start = best_start;
+    p_layout->bank_end = best_start + best_size;
+    return NRF_SUCCESS;
+}
+
+uint32_t flash_layout_bank_check(const flash_layout_t * p_layout, uint32_t length)
+{
+    if (p_layout->bank_end == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    return (length <= flash_layout_bank_size(p_layout)) ? NRF_SUCCESS : NRF_ERROR_NO_MEM;
+}
+
+uint32_t flash_layout_target_check(const flash_layout_t * p_layout, uint32_t start, uint32_t length)
+{
+    if (p_layout->bank_end == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if (start < p_layout->flash_start || start > p_layout->flash_end || length > p_layout->flash_end - start)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    /* Whole pages are erased before the copy. */
+    uint32_t end = page_ceil(p_layout, start + length);
+    start = page_floor(p_layout, start);
+    if (ranges_overlap(start, end, p_layout->bank_start, p_layout->bank_end))
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+    for (uint32_t i = 0; i < p_layout->region_count; i++)
+    {
+        const flash_layout_region_t * p_region = &p_layout->regions[i];
+        if (p_region->keep && ranges_overlap(start, end, p_region->start, p_region->end))
+        {
+            return NRF_ERROR_INVALID_ADDR;
+        }
+    }
+    return NRF_SUCCESS;
+}
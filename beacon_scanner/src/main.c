@@ -36,6 +36,7 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* HAL */
@@ -49,6 +50,7 @@
 #include "mesh_stack.h"
 #include "device_state_manager.h"
 #include "access_config.h"
+#include "timer.h"
 
 /* Provisioning and configuration */
 #include "mesh_provisionee.h"
@@ -68,21 +70,163 @@
 #include "nrf_mesh_config_examples.h"
 #include "light_switch_example_common.h"
 #include "simple_beacon_server.h"
+#include "simple_beacon_common.h"
+#include "eartag_scanner.h"
+#include "scan_scheduler.h"
+#include "sighting_table.h"
+#include "presence.h"
+#include "watchlist.h"
+#include "report_scheduler.h"
+#include "report_phase.h"
+#include "report_backlog.h"
+#include "time_sync.h"
+#include "tx_priority.h"
+#include "dfu_progress.h"
+#include "dfu_status_server.h"
+#include "flash_layout.h"
+#include "dfu_relay.h"
+#include "dfu_policy.h"
+#include "dfu_policy_store.h"
+
+/* Bearer */
+#include "scanner.h"
 
 /* DFU module */
 #include "nrf_mesh_dfu.h"
 #include "nrf_mesh_events.h"
+#include "nrf_mesh_config_core.h"
+#if NRF_FSTORAGE_ENABLED
+#include "nrf_fstorage.h"
+#endif
 
 #define ONOFF_SERVER_0_LED          (BSP_LED_0)
 
 static bool m_device_provisioned;
 static bool m_beacon_report_enabled = 0;
 static nrf_mesh_evt_handler_t m_evt_handler;
-static simple_beacon_server_t m_beacon_server;
+static simple_beacon_server_t m_beacon_servers[SIMPLE_BEACON_SERVER_SHARD_COUNT];
+static simple_beacon_config_t m_scanner_config =
+{
+    .version         = SIMPLE_BEACON_CONFIG_VERSION,
+    .report_interval = APP_CONFIG_REPORT_INTERVAL_MS / 100,
+    .batch_size_max  = APP_CONFIG_REPORT_BATCH_ENTRIES_MAX,
+    .rssi_floor      = APP_CONFIG_RSSI_FLOOR,
+    .scan_interval   = APP_CONFIG_SCAN_INTERVAL_MS,
+    .scan_window     = APP_CONFIG_SCAN_WINDOW_MS,
+    .filter_mode     = SIMPLE_BEACON_FILTER_MODE_NONE,
+    .mesh_share      = APP_CONFIG_SCAN_MESH_SHARE,
+    .report_mode     = SIMPLE_BEACON_REPORT_MODE_SIGHTINGS
+};
+
+/* Sightings aggregated per eartag between two reports. */
+static sighting_table_t m_sighting_table;
+
+/* Entries of the report batch being assembled. */
+static sighting_entry_t m_batch_entries[APP_CONFIG_REPORT_BATCH_ENTRIES_MAX];
+static simple_beacon_report_entry_t m_batch_report[APP_CONFIG_REPORT_BATCH_ENTRIES_MAX];
+
+/* Message buffers of the beacon server, and the report messages waiting for the gateway's acknowledgement. */
+static simple_beacon_tx_pool_t m_tx_pool;
+#if APP_CONFIG_REPORT_SACK_ENABLED
+static simple_beacon_report_window_t m_report_windows[SIMPLE_BEACON_SERVER_SHARD_COUNT];
+#endif
+
+/* Number of report publishes that failed in a row. Reports spill to the backlog after a few. */
+static uint32_t m_publish_fail_streak;
+/* Number of entries of the oldest backlog record already published. */
+static uint32_t m_backlog_replay_cursor;
+static uint32_t m_backlog_drain_timestamp;
+/* The gateway pulls the backlog with Reports Get messages, the backlog is not pushed meanwhile. */
+static bool m_backlog_pulled;
+static uint32_t m_backlog_pull_timestamp;
+
+/* Eartags the gateway is interested in, used in the watchlist filter mode. */
+static watchlist_t m_watchlist;
+static uint32_t m_watchlist_drop_count;
+
+/* Network time estimated from the gateway's time beacons, the base time of the report batches. */
+static time_sync_t m_time_sync;
+
+/* Presence state of every eartag in range, used in the presence report mode. */
+static presence_tracker_t m_presence;
+
+/* DFU transfer telemetry. */
+static dfu_progress_t m_dfu_progress;
+static dfu_status_server_t m_dfu_status_server;
+APP_TIMER_DEF(m_dfu_status_timer);
+static flash_layout_t m_flash_layout;
+static dfu_relay_t m_dfu_relay;
+static nrf_mesh_dfu_transfer_t m_dfu_relay_transfer;
+APP_TIMER_DEF(m_dfu_relay_timer);
+/* Until the gateway pushes a policy, every newer image is accepted. The last policy pushed is
+ * restored from flash at boot. */
+static dfu_policy_t m_dfu_policy =
+{
+    .rollout_percent = DFU_POLICY_COHORT_COUNT,
+    .version_max     = UINT32_MAX
+};
+/* Presence events waiting to be reported, oldest first. */
+static simple_beacon_presence_event_t m_presence_events[APP_CONFIG_PRESENCE_EVENTS_MAX];
+static uint32_t m_presence_event_count;
+/* Every server reports the eartags of its shard, and sends the digest of those eartags. */
+static struct
+{
+    uint16_t present_count;
+    uint32_t fingerprint;
+    /* A digest is sent early when events were lost, so the receiver can resynchronize. */
+    bool digest_due;
+} m_presence_shards[SIMPLE_BEACON_SERVER_SHARD_COUNT];
+static uint32_t m_presence_digest_timestamp;
+
+static void presence_event_cb(const presence_event_t * p_event);
+static uint32_t report_shard_get(const uint8_t * p_addr);
+
+static void presence_start(void)
+{
+    presence_config_t config =
+    {
+        .enter_rssi = APP_CONFIG_PRESENCE_ENTER_RSSI,
+        .leave_rssi = APP_CONFIG_PRESENCE_LEAVE_RSSI,
+        .enter_ms   = APP_CONFIG_PRESENCE_ENTER_MS,
+        .leave_ms   = APP_CONFIG_PRESENCE_LEAVE_MS,
+        .event_cb   = presence_event_cb
+    };
+    presence_init(&m_presence, &config);
+    m_presence_event_count = 0;
+    memset(m_presence_shards, 0, sizeof(m_presence_shards));
+    for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+    {
+        m_presence_shards[i].digest_due = true;
+    }
+}
+
+static void report_start(void)
+{
+    dsm_local_unicast_address_t node_address;
+    dsm_local_unicast_addresses_get(&node_address);
+
+    /* The provisioner hands out consecutive addresses, one per element, so consecutive nodes get
+     * consecutive phases. */
+    report_phase_t phase;
+    report_phase_init(&phase, (uint16_t) (node_address.address_start / ACCESS_ELEMENT_COUNT),
+                      m_scanner_config.report_interval * 100, SERVER_NODE_COUNT);
+    report_scheduler_start(&phase);
+}
 
 static bool simple_beacon_server_set_cb(const simple_beacon_server_t * p_self, bool beacon)
 {
+    if (beacon && !m_beacon_report_enabled)
+    {
+        /* Restart the interval at this node's phase, every scanner in the group gets this message at once. */
+        report_start();
+    }
+    else if (!beacon && m_beacon_report_enabled)
+    {
+        /* Control messages do not need the scheduler, they go on every TX complete event. */
+        report_scheduler_stop();
+    }
     m_beacon_report_enabled = beacon;
+    scan_scheduler_enable(m_beacon_report_enabled);
     hal_led_pin_set(LED_1, m_beacon_report_enabled);
     return m_beacon_report_enabled;
 }
@@ -92,16 +236,823 @@ static bool simple_beacon_server_get_cb(const simple_beacon_server_t * p_self)
     return m_beacon_report_enabled;
 }
 
+static uint16_t clamp_u16(uint16_t value, uint16_t min, uint16_t max)
+{
+    return (value < min) ? min : ((value > max) ? max : value);
+}
+
+static void scanner_config_apply(void)
+{
+    eartag_scanner_rssi_floor_set(m_scanner_config.rssi_floor);
+    scan_scheduler_capture_scan_time_set(m_scanner_config.scan_interval, m_scanner_config.scan_window);
+    report_scheduler_interval_set(m_scanner_config.report_interval * 100);
+    scan_scheduler_mesh_share_set(m_scanner_config.mesh_share);
+}
+
+static void simple_beacon_server_config_get_cb(const simple_beacon_server_t * p_self, simple_beacon_config_t * p_config)
+{
+    *p_config = m_scanner_config;
+}
+
+static void simple_beacon_server_config_set_cb(const simple_beacon_server_t * p_self, const simple_beacon_config_t * p_config)
+{
+    bool interval_changed = (p_config->report_interval != m_scanner_config.report_interval);
+    bool presence_started = (p_config->report_mode == SIMPLE_BEACON_REPORT_MODE_PRESENCE &&
+                             m_scanner_config.report_mode != SIMPLE_BEACON_REPORT_MODE_PRESENCE);
+
+    m_scanner_config.report_interval = (p_config->report_interval > 0) ? p_config->report_interval : 1;
+    m_scanner_config.batch_size_max = (uint8_t) clamp_u16(p_config->batch_size_max, 1, APP_CONFIG_REPORT_BATCH_ENTRIES_MAX);
+    m_scanner_config.rssi_floor = p_config->rssi_floor;
+    m_scanner_config.scan_interval = clamp_u16(p_config->scan_interval, APP_CONFIG_SCAN_TIME_MIN_MS, APP_CONFIG_SCAN_TIME_MAX_MS);
+    m_scanner_config.scan_window = clamp_u16(p_config->scan_window, APP_CONFIG_SCAN_TIME_MIN_MS, m_scanner_config.scan_interval);
+    m_scanner_config.filter_mode = (p_config->filter_mode <= SIMPLE_BEACON_FILTER_MODE_WATCHLIST) ?
+                                   p_config->filter_mode : SIMPLE_BEACON_FILTER_MODE_NONE;
+    m_scanner_config.mesh_share = (p_config->mesh_share > 100) ? 100 : p_config->mesh_share;
+    m_scanner_config.report_mode = (p_config->report_mode <= SIMPLE_BEACON_REPORT_MODE_PRESENCE) ?
+                                   p_config->report_mode : SIMPLE_BEACON_REPORT_MODE_SIGHTINGS;
+    if (presence_started)
+    {
+        /* Start from an empty present set, the first digest tells the receiver to drop its old view. */
+        presence_start();
+    }
+    scanner_config_apply();
+
+    if (interval_changed && m_beacon_report_enabled)
+    {
+        report_start();
+    }
+    __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Scanner config: report %u00 ms, batch %u, floor %d dBm, scan %u/%u ms\n",
+          m_scanner_config.report_interval, m_scanner_config.batch_size_max, m_scanner_config.rssi_floor,
+          m_scanner_config.scan_window, m_scanner_config.scan_interval);
+}
+
+
+/*************************************************************************************************/
+
+static void presence_event_cb(const presence_event_t * p_event)
+{
+    /* The shard digests follow the tracker, whether the event is queued or not. */
+    uint32_t shard = report_shard_get(p_event->addr);
+    m_presence_shards[shard].fingerprint ^= presence_addr_fingerprint(p_event->addr);
+    if (p_event->type == PRESENCE_EVENT_ENTER)
+    {
+        m_presence_shards[shard].present_count++;
+    }
+    else
+    {
+        m_presence_shards[shard].present_count--;
+    }
+
+    if (m_presence_event_count == APP_CONFIG_PRESENCE_EVENTS_MAX)
+    {
+        m_presence_shards[shard].digest_due = true;
+        return;
+    }
+
+    simple_beacon_presence_event_t * p_report = &m_presence_events[m_presence_event_count++];
+    memcpy(p_report->addr, p_event->addr, EARTAG_ADDR_LEN);
+    p_report->type = (p_event->type == PRESENCE_EVENT_ENTER) ? SIMPLE_BEACON_PRESENCE_ENTER : SIMPLE_BEACON_PRESENCE_LEAVE;
+    p_report->rssi = p_event->rssi;
+    if (m_presence_event_count >= APP_CONFIG_PRESENCE_EVENTS_MAX / 2)
+    {
+        report_scheduler_batch_full();
+    }
+}
+
+static void simple_beacon_server_watchlist_chunk_cb(const simple_beacon_server_t * p_self,
+                                                    const simple_beacon_msg_watchlist_chunk_t * p_chunk,
+                                                    uint16_t data_length,
+                                                    simple_beacon_msg_watchlist_status_t * p_status)
+{
+    /* The watchlist status codes and formats have the same values as on the wire. */
+    watchlist_status_t status = watchlist_chunk_add(&m_watchlist, p_chunk->transfer_id, p_chunk->format,
+                                                    p_chunk->hash_count, p_chunk->total_length,
+                                                    p_chunk->offset, p_chunk->data, data_length);
+    p_status->status = (uint8_t) status;
+    p_status->received_length = watchlist_received_get(&m_watchlist);
+    if (status == WATCHLIST_STATUS_COMPLETE)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Watchlist %u active, %u bytes\n", p_chunk->transfer_id, p_chunk->total_length);
+    }
+}
+
+static void simple_beacon_server_report_ack_cb(const simple_beacon_server_t * p_self, uint32_t acked_count)
+{
+    if (acked_count > 0)
+    {
+        /* Room in the send window, a publish that failed on a full window can go now. */
+        report_scheduler_resume();
+    }
+}
+
+static void simple_beacon_server_report_expired_cb(const simple_beacon_server_t * p_self,
+                                                  uint8_t opcode,
+                                                  const uint8_t * p_data,
+                                                  uint16_t length,
+                                                  uint32_t age_ms)
+{
+    /* Room in the send window again. */
+    report_scheduler_resume();
+
+    /* Sightings the gateway never acknowledged go to the backlog, to be pulled or drained later.
+     * Presence messages are superseded by the next digest. The batch buffer is free here, the
+     * messages are given up before the report flush fills it. */
+    const simple_beacon_msg_report_batch_t * p_batch = (const simple_beacon_msg_report_batch_t *) p_data;
+    uint32_t status = NRF_ERROR_INVALID_DATA;
+    if (opcode == SIMPLE_BEACON_OPCODE_REPORT_BATCH &&
+        length >= sizeof(*p_batch) &&
+        p_batch->count <= APP_CONFIG_REPORT_BATCH_ENTRIES_MAX &&
+        simple_beacon_codec_decode(p_batch->data, length - sizeof(*p_batch), m_batch_report, p_batch->count))
+    {
+        status = report_backlog_write(m_batch_report, p_batch->count, eartag_scanner_time_ms_get() - age_ms);
+    }
+    if (status != NRF_SUCCESS)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "Report 0x%02x unacknowledged after %u ms, dropped (%u)\n",
+              opcode, age_ms, status);
+    }
+}
+
+static bool simple_beacon_server_reports_get_cb(const simple_beacon_server_t * p_self,
+                                                uint32_t since_seq,
+                                                simple_beacon_report_record_t * p_record)
+{
+    uint32_t now = eartag_scanner_time_ms_get();
+    m_backlog_pulled = true;
+    m_backlog_pull_timestamp = now;
+
+    /* The cursor acknowledges the records before it. */
+    if (report_backlog_drain_before(since_seq) > 0)
+    {
+        m_backlog_replay_cursor = 0;
+    }
+
+    report_backlog_record_t record;
+    if (report_backlog_find(since_seq, &record) != NRF_SUCCESS)
+    {
+        return false;
+    }
+
+    uint32_t age = (now - record.timestamp) / 100;
+    p_record->p_entries = record.p_entries;
+    p_record->count = record.count;
+    p_record->seq = record.seq;
+    p_record->age = (record.stale || age > UINT16_MAX) ? UINT16_MAX : (uint16_t) age;
+    return true;
+}
+
+static void simple_beacon_server_time_beacon_cb(const simple_beacon_server_t * p_self,
+                                                uint32_t network_time,
+                                                uint32_t hops,
+                                                uint32_t hop_delay,
+                                                uint32_t rx_age_ms)
+{
+    bool synced = m_time_sync.synced;
+    time_sync_sample_add(&m_time_sync, eartag_scanner_time_ms_get() - rx_age_ms, network_time, hops, hop_delay);
+    if (!synced)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Network time acquired, %u hops\n", hops);
+    }
+}
+
+static uint32_t report_base_time_get(uint32_t now)
+{
+    uint32_t network_time;
+    return time_sync_network_time_get(&m_time_sync, now, &network_time) ? network_time : SIMPLE_BEACON_TIME_UNKNOWN;
+}
+
+static void sighting_cb(const eartag_sighting_t * p_sighting)
+{
+    if (m_scanner_config.filter_mode == SIMPLE_BEACON_FILTER_MODE_WATCHLIST &&
+        !watchlist_match(&m_watchlist, p_sighting->addr))
+    {
+        m_watchlist_drop_count++;
+        return;
+    }
+
+    if (m_scanner_config.report_mode == SIMPLE_BEACON_REPORT_MODE_PRESENCE)
+    {
+        presence_sighting_add(&m_presence, p_sighting);
+        return;
+    }
+
+    (void) sighting_table_insert(&m_sighting_table, p_sighting, NULL);
+    if (sighting_table_count(&m_sighting_table) >= m_scanner_config.batch_size_max)
+    {
+        report_scheduler_batch_full();
+    }
+}
+
+static void report_entry_fill(simple_beacon_report_entry_t * p_report, const sighting_entry_t * p_entry, uint32_t now)
+{
+    uint32_t age = (now - p_entry->last_timestamp) / 100;
+
+    memcpy(p_report->addr, p_entry->addr, EARTAG_ADDR_LEN);
+    p_report->count = p_entry->count;
+    p_report->rssi_avg = (int8_t) (p_entry->rssi_sum / (int32_t) p_entry->count);
+    p_report->rssi_max = p_entry->rssi_max;
+    p_report->age = (age > UINT16_MAX) ? UINT16_MAX : (uint16_t) age;
+}
+
+/* The server instance reporting an eartag, the same for all reports of the eartag. */
+static uint32_t report_shard_get(const uint8_t * p_addr)
+{
+    return presence_addr_fingerprint(p_addr) % SIMPLE_BEACON_SERVER_SHARD_COUNT;
+}
+
+static int sighting_entry_addr_compare(const void * p_a, const void * p_b)
+{
+    const uint8_t * p_addr_a = ((const sighting_entry_t *) p_a)->addr;
+    const uint8_t * p_addr_b = ((const sighting_entry_t *) p_b)->addr;
+    uint32_t shard_a = report_shard_get(p_addr_a);
+    uint32_t shard_b = report_shard_get(p_addr_b);
+    if (shard_a != shard_b)
+    {
+        return (shard_a < shard_b) ? -1 : 1;
+    }
+    /* Addresses are little endian, compare from the most significant byte. */
+    for (uint32_t i = EARTAG_ADDR_LEN; i > 0; i--)
+    {
+        if (p_addr_a[i - 1] != p_addr_b[i - 1])
+        {
+            return (int) p_addr_a[i - 1] - (int) p_addr_b[i - 1];
+        }
+    }
+    return 0;
+}
+
+static bool presence_digest_pending(uint32_t now)
+{
+    for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+    {
+        if (m_presence_shards[i].digest_due)
+        {
+            return true;
+        }
+    }
+    return (now - m_presence_digest_timestamp >= APP_CONFIG_PRESENCE_DIGEST_INTERVAL_MS);
+}
+
+/* Sorts the queued events by shard. The sort is stable, so the events of an eartag, all in the
+ * same shard, stay in order. */
+static void presence_events_sort(void)
+{
+    for (uint32_t i = 1; i < m_presence_event_count; i++)
+    {
+        simple_beacon_presence_event_t event = m_presence_events[i];
+        uint32_t shard = report_shard_get(event.addr);
+        uint32_t j = i;
+        while (j > 0 && report_shard_get(m_presence_events[j - 1].addr) > shard)
+        {
+            m_presence_events[j] = m_presence_events[j - 1];
+            j--;
+        }
+        m_presence_events[j] = event;
+    }
+}
+
+static uint32_t presence_events_flush(nrf_mesh_tx_token_t * p_token)
+{
+    presence_events_sort();
+
+    /* One message per shard, each on its own server so the transfers run in parallel. The
+     * published events are removed, the rest move up for the next flush. */
+    uint32_t status = NRF_ERROR_INVALID_LENGTH;
+    uint32_t kept = 0;
+    uint32_t start = 0;
+    while (start < m_presence_event_count)
+    {
+        uint32_t shard = report_shard_get(m_presence_events[start].addr);
+        uint32_t end = start + 1;
+        while (end < m_presence_event_count && report_shard_get(m_presence_events[end].addr) == shard)
+        {
+            end++;
+        }
+
+        uint32_t published;
+        uint32_t shard_status = simple_beacon_server_presence_events_publish(&m_beacon_servers[shard],
+                                                                             &m_presence_events[start], end - start,
+                                                                             &published);
+        memmove(&m_presence_events[kept], &m_presence_events[start + published],
+                (end - start - published) * sizeof(m_presence_events[0]));
+        kept += end - start - published;
+
+        if (shard_status == NRF_SUCCESS)
+        {
+            *p_token = m_beacon_servers[shard].batch_token;
+            status = NRF_SUCCESS;
+        }
+        else if (status != NRF_SUCCESS)
+        {
+            status = shard_status;
+        }
+        start = end;
+    }
+    m_presence_event_count = kept;
+    return status;
+}
+
+static uint32_t presence_digests_flush(nrf_mesh_tx_token_t * p_token, uint32_t now)
+{
+    if (now - m_presence_digest_timestamp >= APP_CONFIG_PRESENCE_DIGEST_INTERVAL_MS)
+    {
+        for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+        {
+            m_presence_shards[i].digest_due = true;
+        }
+        m_presence_digest_timestamp = now;
+    }
+
+    uint32_t status = NRF_ERROR_INVALID_LENGTH;
+    for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+    {
+        if (!m_presence_shards[i].digest_due)
+        {
+            continue;
+        }
+
+        uint32_t shard_status = simple_beacon_server_presence_digest_publish(&m_beacon_servers[i],
+                                                                             m_presence_shards[i].present_count,
+                                                                             m_presence_shards[i].fingerprint);
+        if (shard_status == NRF_SUCCESS)
+        {
+            m_presence_shards[i].digest_due = false;
+            *p_token = m_beacon_servers[i].batch_token;
+            status = NRF_SUCCESS;
+        }
+        else if (status != NRF_SUCCESS)
+        {
+            status = shard_status;
+        }
+    }
+    return status;
+}
+
+static uint32_t presence_flush(nrf_mesh_tx_token_t * p_token)
+{
+    if (m_presence_event_count > 0)
+    {
+        return presence_events_flush(p_token);
+    }
+    return presence_digests_flush(p_token, eartag_scanner_time_ms_get());
+}
+
+static void publish_result_track(uint32_t status)
+{
+    m_publish_fail_streak = (status == NRF_SUCCESS) ? 0 : m_publish_fail_streak + 1;
+}
+
+static uint32_t backlog_flush(nrf_mesh_tx_token_t * p_token, uint32_t * p_wait_ms)
+{
+    uint32_t now = eartag_scanner_time_ms_get();
+    const simple_beacon_report_entry_t * p_entries;
+    uint32_t count;
+    uint32_t timestamp;
+    bool stale;
+    if (report_backlog_peek(&p_entries, &count, &timestamp, &stale) != NRF_SUCCESS)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    /* The entries of a record are grouped by shard, as they were spilled. Each group goes on the
+     * server of its shard, the one that reports those eartags live. */
+    uint32_t shard = report_shard_get(p_entries[m_backlog_replay_cursor].addr);
+    uint32_t remaining = 1;
+    while (m_backlog_replay_cursor + remaining < count &&
+           report_shard_get(p_entries[m_backlog_replay_cursor + remaining].addr) == shard)
+    {
+        remaining++;
+    }
+
+    /* Age the entries by the time they spent in flash. Time before a reset is unknown. */
+    uint32_t elapsed = (now - timestamp) / 100;
+    for (uint32_t i = 0; i < remaining; i++)
+    {
+        uint32_t age = p_entries[m_backlog_replay_cursor + i].age + elapsed;
+        m_batch_report[i] = p_entries[m_backlog_replay_cursor + i];
+        m_batch_report[i].age = (stale || age > UINT16_MAX) ? UINT16_MAX : (uint16_t) age;
+    }
+
+    uint32_t published;
+    uint32_t status = simple_beacon_server_report_batch_publish(&m_beacon_servers[shard], m_batch_report, remaining,
+                                                                report_base_time_get(now), &published);
+    publish_result_track(status);
+    if (status == NRF_SUCCESS)
+    {
+        m_backlog_drain_timestamp = now;
+        m_backlog_replay_cursor += published;
+        if (m_backlog_replay_cursor == count)
+        {
+            (void) report_backlog_pop();
+            m_backlog_replay_cursor = 0;
+        }
+    }
+    *p_token = m_beacon_servers[shard].batch_token;
+    *p_wait_ms = stale ? TX_PRIORITY_WAIT_UNKNOWN : now - timestamp;
+    return status;
+}
+
+static uint32_t sightings_flush(nrf_mesh_tx_token_t * p_token, uint32_t * p_wait_ms)
+{
+    uint32_t now = eartag_scanner_time_ms_get();
+    uint32_t count = sighting_table_drain(&m_sighting_table, m_batch_entries, m_scanner_config.batch_size_max);
+    if (count == 0)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    /* Grouped by shard, and sorted addresses give the smallest deltas in the encoded batch. */
+    qsort(m_batch_entries, count, sizeof(m_batch_entries[0]), sighting_entry_addr_compare);
+
+    /* The entries waited from their first sighting since the last report. */
+    *p_wait_ms = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        report_entry_fill(&m_batch_report[i], &m_batch_entries[i], now);
+        if (now - m_batch_entries[i].first_timestamp > *p_wait_ms)
+        {
+            *p_wait_ms = now - m_batch_entries[i].first_timestamp;
+        }
+    }
+
+    /* One batch per shard, each on its own server so the transfers run in parallel. */
+    uint32_t base_time = report_base_time_get(now);
+    uint32_t status = NRF_ERROR_INVALID_LENGTH;
+    uint32_t start = 0;
+    while (start < count)
+    {
+        uint32_t shard = report_shard_get(m_batch_entries[start].addr);
+        uint32_t end = start + 1;
+        while (end < count && report_shard_get(m_batch_entries[end].addr) == shard)
+        {
+            end++;
+        }
+
+        uint32_t published;
+        uint32_t shard_status = simple_beacon_server_report_batch_publish(&m_beacon_servers[shard],
+                                                                          &m_batch_report[start], end - start,
+                                                                          base_time, &published);
+        publish_result_track(shard_status);
+
+        if (shard_status != NRF_SUCCESS &&
+            m_publish_fail_streak >= APP_CONFIG_BACKLOG_SPILL_FAILURES &&
+            report_backlog_write(&m_batch_report[start], end - start, now) == NRF_SUCCESS)
+        {
+            /* Spilled to flash, nothing to put back. */
+            published = end - start;
+        }
+
+        /* Put the entries that did not make it into the batch back for the next flush. */
+        for (uint32_t i = start + published; i < end; i++)
+        {
+            (void) sighting_table_merge(&m_sighting_table, &m_batch_entries[i], NULL);
+        }
+
+        if (shard_status == NRF_SUCCESS)
+        {
+            *p_token = m_beacon_servers[shard].batch_token;
+            status = NRF_SUCCESS;
+        }
+        else if (status != NRF_SUCCESS)
+        {
+            status = shard_status;
+        }
+        start = end;
+    }
+
+    return status;
+}
+
+/* Control class: Status publications that found the TX queue full. */
+static uint32_t control_depth_cb(void)
+{
+    uint32_t depth = 0;
+    for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+    {
+        if (m_beacon_servers[i].status_publish_pending)
+        {
+            depth++;
+        }
+    }
+    return depth;
+}
+
+static uint32_t control_send_cb(nrf_mesh_tx_token_t * p_token, uint32_t * p_wait_ms)
+{
+    for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+    {
+        simple_beacon_server_t * p_server = &m_beacon_servers[i];
+        if (p_server->status_publish_pending)
+        {
+            uint32_t status = simple_beacon_server_status_publish(p_server, p_server->get_cb(p_server));
+            if (status == NRF_SUCCESS)
+            {
+                *p_token = p_server->status_token;
+                *p_wait_ms = (timer_now() - p_server->status_pending_timestamp) / 1000;
+            }
+            else if (status != NRF_ERROR_NO_MEM)
+            {
+                /* Cannot be published at all, drop it rather than hold back the reports. */
+                p_server->status_publish_pending = false;
+            }
+            return status;
+        }
+    }
+    return NRF_ERROR_INVALID_LENGTH;
+}
+
+/* Report class: retransmissions, then live reports. */
+static uint32_t report_depth_cb(void)
+{
+    if (!m_beacon_report_enabled)
+    {
+        /* Neither new reports nor retransmissions while reporting is off. */
+        return 0;
+    }
+
+    uint32_t depth = 0;
+    for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+    {
+        if (simple_beacon_server_report_retransmit_due(&m_beacon_servers[i], APP_CONFIG_REPORT_ACK_TIMEOUT_MS))
+        {
+            depth++;
+        }
+    }
+
+    if (m_scanner_config.report_mode == SIMPLE_BEACON_REPORT_MODE_PRESENCE)
+    {
+        bool digest_due = presence_digest_pending(eartag_scanner_time_ms_get());
+        return depth + ((m_presence_event_count > 0) ? 1 : 0) + (digest_due ? 1 : 0);
+    }
+    return depth + (sighting_table_count(&m_sighting_table) + m_scanner_config.batch_size_max - 1) /
+                   m_scanner_config.batch_size_max;
+}
+
+static uint32_t report_send_cb(nrf_mesh_tx_token_t * p_token, uint32_t * p_wait_ms)
+{
+    /* Messages the gateway missed go before new reports. */
+    for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+    {
+        uint32_t status = simple_beacon_server_report_retransmit(&m_beacon_servers[i], APP_CONFIG_REPORT_ACK_TIMEOUT_MS);
+        if (status != NRF_ERROR_NOT_FOUND)
+        {
+            publish_result_track(status);
+            *p_token = m_beacon_servers[i].batch_token;
+            return status;
+        }
+    }
+
+    if (m_scanner_config.report_mode == SIMPLE_BEACON_REPORT_MODE_PRESENCE)
+    {
+        return presence_flush(p_token);
+    }
+    return sightings_flush(p_token, p_wait_ms);
+}
+
+/* Backlog class: records replayed from flash. */
+static uint32_t backlog_depth_cb(void)
+{
+    uint32_t now = eartag_scanner_time_ms_get();
+    if (m_backlog_pulled && now - m_backlog_pull_timestamp >= APP_CONFIG_BACKLOG_PULL_HOLDOFF_MS)
+    {
+        m_backlog_pulled = false;
+    }
+
+    /* Drained at a limited pace, and only while reporting, publishing works and the gateway is not pulling it. */
+    if (!m_beacon_report_enabled ||
+        m_scanner_config.report_mode == SIMPLE_BEACON_REPORT_MODE_PRESENCE ||
+        m_publish_fail_streak > 0 ||
+        m_backlog_pulled ||
+        now - m_backlog_drain_timestamp < APP_CONFIG_BACKLOG_DRAIN_INTERVAL_MS)
+    {
+        return 0;
+    }
+    return report_backlog_count();
+}
+
+static uint32_t report_flush_cb(nrf_mesh_tx_token_t * p_token, bool * p_more)
+{
+    if (m_scanner_config.report_mode == SIMPLE_BEACON_REPORT_MODE_PRESENCE)
+    {
+        presence_tick(&m_presence, eartag_scanner_time_ms_get());
+    }
+    return tx_priority_flush(p_token, p_more);
+}
+
+static uint8_t dfu_cohort_get(void)
+{
+    return dfu_policy_cohort_get(nrf_mesh_configure_device_uuid_get(), NRF_MESH_UUID_SIZE, m_dfu_policy.cohort_salt);
+}
+
+static void dfu_status_get_cb(const dfu_status_server_t * p_self, dfu_status_msg_status_t * p_status)
+{
+    p_status->state = m_dfu_progress.state;
+    p_status->dfu_type = m_dfu_progress.dfu_type;
+    p_status->end_reason = m_dfu_progress.end_reason;
+    p_status->fw_version = m_dfu_progress.fw_version;
+    p_status->segment_count = m_dfu_progress.segment_count;
+    p_status->received_count = m_dfu_progress.received_count;
+    p_status->relay_count = m_dfu_progress.relay_count;
+    p_status->policy_id = m_dfu_policy.policy_id;
+    p_status->in_cohort = dfu_policy_in_cohort(&m_dfu_policy, dfu_cohort_get()) ? 1 : 0;
+
+    dfu_progress_range_t ranges[DFU_STATUS_MISSING_RANGES_MAX];
+    p_status->missing_count = (uint8_t) dfu_progress_missing_get(&m_dfu_progress, ranges, DFU_STATUS_MISSING_RANGES_MAX);
+    for (uint32_t i = 0; i < p_status->missing_count; i++)
+    {
+        p_status->missing[i].first = ranges[i].first;
+        p_status->missing[i].count = ranges[i].count;
+    }
+}
+
+/* Checks the image against the flash layout as soon as the start segment gives its size, and
+ * aborts a transfer that could never be flashed, instead of failing it after the whole image. */
+static void dfu_image_check(void)
+{
+    uint32_t status = flash_layout_bank_check(&m_flash_layout, m_dfu_progress.image_length);
+    if (status == NRF_SUCCESS && m_dfu_progress.dfu_type == NRF_MESH_DFU_TYPE_APPLICATION)
+    {
+        status = flash_layout_target_check(&m_flash_layout, m_dfu_progress.start_address, m_dfu_progress.image_length);
+    }
+
+    if (status == NRF_SUCCESS)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "DFU image of %u bytes fits the bank of %u bytes\n",
+              m_dfu_progress.image_length, flash_layout_bank_size(&m_flash_layout));
+    }
+    else
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "DFU image of %u bytes at 0x%08x does not fit the flash layout (%u), aborting\n",
+              m_dfu_progress.image_length, m_dfu_progress.start_address, status);
+        (void) nrf_mesh_dfu_abort();
+    }
+}
+
+static void dfu_status_policy_set_cb(const dfu_status_server_t * p_self,
+                                     const dfu_status_msg_policy_set_t * p_policy,
+                                     dfu_status_msg_policy_status_t * p_status)
+{
+    NRF_MESH_STATIC_ASSERT(DFU_POLICY_BLOCKED_MAX == DFU_STATUS_POLICY_BLOCKED_MAX);
+    NRF_MESH_STATIC_ASSERT(DFU_POLICY_FLAG_SOFTDEVICE == DFU_STATUS_POLICY_FLAG_SOFTDEVICE &&
+                           DFU_POLICY_FLAG_DOWNGRADE == DFU_STATUS_POLICY_FLAG_DOWNGRADE);
+
+    m_dfu_policy.policy_id = p_policy->policy_id;
+    m_dfu_policy.flags = p_policy->flags;
+    m_dfu_policy.rollout_percent = p_policy->rollout_percent;
+    m_dfu_policy.cohort_salt = p_policy->cohort_salt;
+    m_dfu_policy.version_min = p_policy->version_min;
+    m_dfu_policy.version_max = p_policy->version_max;
+    m_dfu_policy.blocked_count = p_policy->blocked_count;
+    for (uint32_t i = 0; i < p_policy->blocked_count; i++)
+    {
+        m_dfu_policy.blocked[i] = p_policy->blocked[i];
+    }
+
+    uint32_t status = dfu_policy_store_save(&m_dfu_policy);
+    if (status != NRF_SUCCESS)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "DFU policy not stored (%u), lost at the next reset\n", status);
+    }
+
+    uint8_t cohort = dfu_cohort_get();
+    p_status->policy_id = m_dfu_policy.policy_id;
+    p_status->in_cohort = dfu_policy_in_cohort(&m_dfu_policy, cohort) ? 1 : 0;
+    p_status->cohort = cohort;
+    __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "DFU policy %u: rollout %u%% (cohort %u), versions %u-%u, %u blocked, flags 0x%02x\n",
+          m_dfu_policy.policy_id, m_dfu_policy.rollout_percent, cohort, m_dfu_policy.version_min,
+          m_dfu_policy.version_max, m_dfu_policy.blocked_count, m_dfu_policy.flags);
+}
+
+static void dfu_packet_cb(const uint8_t * p_data, uint8_t length, const uint8_t * p_addr, int8_t rssi)
+{
+    dfu_relay_packet_add(&m_dfu_relay, p_data, length, p_addr, rssi, eartag_scanner_time_ms_get());
+
+    if (m_dfu_progress.state == DFU_PROGRESS_STATE_TARGET || m_dfu_progress.state == DFU_PROGRESS_STATE_RELAY)
+    {
+        bool image_sized = (m_dfu_progress.image_length > 0);
+        (void) dfu_progress_packet_add(&m_dfu_progress, p_data, length);
+        if (!image_sized && m_dfu_progress.image_length > 0 && m_dfu_progress.state == DFU_PROGRESS_STATE_TARGET)
+        {
+            dfu_image_check();
+        }
+    }
+}
+
+static void dfu_status_publish(void)
+{
+    uint32_t status = dfu_status_server_publish(&m_dfu_status_server);
+    if (status != NRF_SUCCESS)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "DFU status publish failed: %u\n", status);
+    }
+}
+
+static void dfu_status_timer_handler(void * p_context)
+{
+    if (m_dfu_progress.state == DFU_PROGRESS_STATE_TARGET || m_dfu_progress.state == DFU_PROGRESS_STATE_RELAY)
+    {
+        dfu_status_publish();
+        ERROR_CHECK(app_timer_start(m_dfu_status_timer, APP_TIMER_TICKS(APP_CONFIG_DFU_STATUS_INTERVAL_MS), NULL));
+    }
+}
+
+/* Publishes the DFU status now, and periodically while the transfer runs. The periodic statuses
+ * are spread over the interval by node address, so the gateway is not flooded. */
+static void dfu_status_start(void)
+{
+    dfu_status_publish();
+
+    dsm_local_unicast_address_t node_address;
+    dsm_local_unicast_addresses_get(&node_address);
+    report_phase_t phase;
+    report_phase_init(&phase, node_address.address_start, APP_CONFIG_DFU_STATUS_INTERVAL_MS, SERVER_NODE_COUNT);
+    (void) app_timer_stop(m_dfu_status_timer);
+    ERROR_CHECK(app_timer_start(m_dfu_status_timer,
+                                APP_TIMER_TICKS(APP_CONFIG_DFU_STATUS_INTERVAL_MS + phase.offset_ms), NULL));
+}
+
+/* Listens to the neighbourhood before relaying a transfer offered to this node, see @ref DFU_RELAY. */
+static void dfu_relay_offer(const nrf_mesh_dfu_transfer_t * p_transfer)
+{
+    uint32_t window_ms;
+    if (dfu_relay_listen_start(&m_dfu_relay, eartag_scanner_time_ms_get(), &window_ms))
+    {
+        m_dfu_relay_transfer = *p_transfer;
+        ERROR_CHECK(app_timer_start(m_dfu_relay_timer, APP_TIMER_TICKS(window_ms), NULL));
+    }
+}
+
+static void dfu_relay_timer_handler(void * p_context)
+{
+    dfu_relay_inputs_t inputs;
+    dfu_relay_decision_t decision = dfu_relay_decide(&m_dfu_relay, eartag_scanner_time_ms_get(), &inputs);
+    __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "DFU relay %s: %u neighbours, %u DFU transmitters, upstream RSSI %d, %u hops, p %u/256\n",
+          (decision == DFU_RELAY_DECISION_RELAY) ? "accepted" : "suppressed",
+          inputs.density, inputs.transmitter_count, inputs.upstream_rssi, inputs.hops, inputs.probability);
+
+    if (decision == DFU_RELAY_DECISION_RELAY)
+    {
+        /* The stack may have moved on to another transfer while listening. */
+        uint32_t status = nrf_mesh_dfu_relay(m_dfu_relay_transfer.dfu_type, &m_dfu_relay_transfer.id);
+        if (status != NRF_SUCCESS)
+        {
+            __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "DFU relay request failed: %u\n", status);
+        }
+    }
+    else
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "DFU relays suppressed: %u\n", m_dfu_relay.suppress_count);
+    }
+}
+
+static uint32_t dfu_fw_version_get(const nrf_mesh_dfu_transfer_t * p_transfer)
+{
+    switch (p_transfer->dfu_type)
+    {
+        case NRF_MESH_DFU_TYPE_APPLICATION:
+            return p_transfer->id.application.app_version;
+        case NRF_MESH_DFU_TYPE_BOOTLOADER:
+            return p_transfer->id.bootloader.bl_version;
+        case NRF_MESH_DFU_TYPE_SOFTDEVICE:
+            return p_transfer->id.softdevice;
+        default:
+            return 0;
+    }
+}
 
 /*************************************************************************************************/
 
 static void app_model_init(void)
 {
-    /* Instantiate beacon server on element index 0 */
-    m_beacon_server.set_cb = simple_beacon_server_set_cb;
-    m_beacon_server.get_cb = simple_beacon_server_get_cb;
-    ERROR_CHECK(simple_beacon_server_init(&m_beacon_server, 0));
-    access_model_subscription_list_alloc(m_beacon_server.model_handle);
+    /* Instantiate a beacon server on each element, sharing the message buffers. Any of them
+     * accepts the control messages. */
+    simple_beacon_tx_pool_init(&m_tx_pool);
+    for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+    {
+        simple_beacon_server_t * p_server = &m_beacon_servers[i];
+        p_server->set_cb = simple_beacon_server_set_cb;
+        p_server->get_cb = simple_beacon_server_get_cb;
+        p_server->config_get_cb = simple_beacon_server_config_get_cb;
+        p_server->config_set_cb = simple_beacon_server_config_set_cb;
+        p_server->watchlist_chunk_cb = simple_beacon_server_watchlist_chunk_cb;
+        p_server->p_tx_pool = &m_tx_pool;
+#if APP_CONFIG_REPORT_SACK_ENABLED
+        p_server->p_report_window = &m_report_windows[i];
+#else
+        p_server->p_report_window = NULL;
+#endif
+        p_server->report_ack_cb = simple_beacon_server_report_ack_cb;
+        p_server->report_expired_cb = simple_beacon_server_report_expired_cb;
+        p_server->reports_get_cb = simple_beacon_server_reports_get_cb;
+        p_server->time_beacon_cb = simple_beacon_server_time_beacon_cb;
+        ERROR_CHECK(simple_beacon_server_init(p_server, (uint16_t) i));
+        access_model_subscription_list_alloc(p_server->model_handle);
+    }
+
+    m_dfu_status_server.get_cb = dfu_status_get_cb;
+    m_dfu_status_server.policy_set_cb = dfu_status_policy_set_cb;
+    ERROR_CHECK(dfu_status_server_init(&m_dfu_status_server, 0));
+    access_model_subscription_list_alloc(m_dfu_status_server.model_handle);
 }
 
 /*************************************************************************************************/
@@ -113,46 +1064,147 @@ static void app_model_init(void)
     #define FLASH_PAGE_MASK             (0xFFFFF000)
 #endif
 
+/* Pages of the mesh flash manager, right below the bootloader: the access, DSM and network state
+ * areas, and the flash manager recovery page. */
+#define MESH_FLASH_PAGE_COUNT       (ACCESS_FLASH_PAGE_COUNT + DSM_FLASH_PAGE_COUNT + NET_FLASH_PAGE_COUNT + 1)
+
+/* UICR value of the bootloader address when there is no bootloader. */
+#define BOOTLOADER_ADDR_NONE        (0xFFFFFFFF)
+
 #if defined(_lint)
     const volatile uint32_t * rom_base   = NULL;
     const volatile uint32_t * rom_length = NULL;
     uint32_t rom_end;
-    uint32_t bank_addr;
+    uint32_t image_end;
 #elif defined ( __CC_ARM )
     extern uint32_t Image$$ER_IROM1$$Base;
     extern uint32_t Image$$ER_IROM1$$Length;
     const volatile uint32_t * rom_base   = &Image$$ER_IROM1$$Base;
     const volatile uint32_t * rom_length = &Image$$ER_IROM1$$Length;
     uint32_t rom_end;
-    uint32_t bank_addr;
+    uint32_t image_end;
 #elif defined   ( __GNUC__ )
     extern uint32_t _start;
     extern uint32_t __exidx_end;
+    extern uint32_t __data_start__;
+    extern uint32_t __data_end__;
+    extern uint32_t __stop_nrf_mesh_flash;
     const volatile uint32_t rom_base   = (uint32_t) &_start;
     const volatile uint32_t rom_end    = (uint32_t) &__exidx_end;
     uint32_t rom_length;
-    uint32_t bank_addr;
+    uint32_t image_end;
 #endif
 
+static uint32_t bootloader_addr_get(void)
+{
+    uint32_t bootloader_addr = NRF_UICR->NRFFW[0];
+    return (bootloader_addr == BOOTLOADER_ADDR_NONE) ? NRF_FICR->CODEPAGESIZE * NRF_FICR->CODESIZE : bootloader_addr;
+}
+
+/* The mesh flash user of the application has a single callback, shared by the backlog and the
+ * DFU policy store. Each of them only acts on the tokens of its own operations. */
+static void app_flash_op_cb(mesh_flash_user_t user, const flash_operation_t * p_op, uint16_t token)
+{
+    report_backlog_flash_op_cb(user, p_op, token);
+    dfu_policy_store_flash_op_cb(user, p_op, token);
+}
+
+/* Maps the application flash and places the DFU bank in the largest free gap. */
+static void flash_layout_plan(uint32_t backlog_addr, uint32_t policy_addr)
+{
+    uint32_t flash_end = NRF_FICR->CODEPAGESIZE * NRF_FICR->CODESIZE;
+    uint32_t bootloader_addr = bootloader_addr_get();
+    uint32_t mesh_flash_addr = bootloader_addr - MESH_FLASH_PAGE_COUNT * FLASH_PAGE_SIZE;
+
+    flash_layout_init(&m_flash_layout, (uint32_t) rom_base, flash_end, FLASH_PAGE_SIZE);
+    ERROR_CHECK(flash_layout_region_add(&m_flash_layout, "application", (uint32_t) rom_base, image_end, false));
+    /* The backlog moves with the end of the image, a new image may take its pages. */
+    ERROR_CHECK(flash_layout_region_add(&m_flash_layout, "backlog", backlog_addr,
+                                        backlog_addr + APP_CONFIG_BACKLOG_PAGE_COUNT * FLASH_PAGE_SIZE, false));
+#if NRF_FSTORAGE_ENABLED
+    for (uint32_t i = 0; i < NRF_FSTORAGE_INSTANCE_CNT; i++)
+    {
+        const nrf_fstorage_t * p_fstorage = NRF_FSTORAGE_INSTANCE_GET(i);
+        ERROR_CHECK(flash_layout_region_add(&m_flash_layout, "fstorage", p_fstorage->start_addr, p_fstorage->end_addr, true));
+    }
+#endif
+    /* The policy must survive a DFU, it does not move with the image. */
+    ERROR_CHECK(flash_layout_region_add(&m_flash_layout, "policy", policy_addr, policy_addr + FLASH_PAGE_SIZE, true));
+    ERROR_CHECK(flash_layout_region_add(&m_flash_layout, "mesh", mesh_flash_addr, bootloader_addr, true));
+    if (bootloader_addr < flash_end)
+    {
+        ERROR_CHECK(flash_layout_region_add(&m_flash_layout, "bootloader", bootloader_addr, flash_end, true));
+    }
+    ERROR_CHECK(flash_layout_bank_plan(&m_flash_layout));
+
+    for (uint32_t i = 0; i < m_flash_layout.region_count; i++)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_DBG2, "%-11s %X-%X\n", m_flash_layout.regions[i].p_name,
+              m_flash_layout.regions[i].start, m_flash_layout.regions[i].end);
+    }
+    __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "DFU bank %X-%X, %u bytes\n",
+          m_flash_layout.bank_start, m_flash_layout.bank_end, flash_layout_bank_size(&m_flash_layout));
+    if (flash_layout_bank_size(&m_flash_layout) < image_end - (uint32_t) rom_base)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "DFU bank is smaller than the running image\n");
+    }
+}
+
 static bool fw_updated_event_is_for_me(const nrf_mesh_evt_dfu_t * p_evt)
 {
+    const nrf_mesh_fwid_t * p_current = &p_evt->fw_outdated.current;
+    const nrf_mesh_fwid_t * p_offered = &p_evt->fw_outdated.transfer.id;
+    uint8_t cohort = dfu_cohort_get();
+    dfu_policy_verdict_t verdict;
+
     switch (p_evt->fw_outdated.transfer.dfu_type)
     {
         case NRF_MESH_DFU_TYPE_APPLICATION:
-            return (p_evt->fw_outdated.current.application.app_id == p_evt->fw_outdated.transfer.id.application.app_id &&
-                    p_evt->fw_outdated.current.application.company_id == p_evt->fw_outdated.transfer.id.application.company_id &&
-                    p_evt->fw_outdated.current.application.app_version < p_evt->fw_outdated.transfer.id.application.app_version);
+        {
+            dfu_policy_fwid_t current = {p_current->application.company_id, p_current->application.app_id,
+                                         p_current->application.app_version};
+            dfu_policy_fwid_t offered = {p_offered->application.company_id, p_offered->application.app_id,
+                                         p_offered->application.app_version};
+            verdict = dfu_policy_app_check(&m_dfu_policy, cohort, &current, &offered);
+            break;
+        }
 
         case NRF_MESH_DFU_TYPE_BOOTLOADER:
-            return (p_evt->fw_outdated.current.bootloader.bl_id == p_evt->fw_outdated.transfer.id.bootloader.bl_id &&
-                    p_evt->fw_outdated.current.bootloader.bl_version < p_evt->fw_outdated.transfer.id.bootloader.bl_version);
+        {
+            dfu_policy_fwid_t current = {p_current->bootloader.bl_id, 0, p_current->bootloader.bl_version};
+            dfu_policy_fwid_t offered = {p_offered->bootloader.bl_id, 0, p_offered->bootloader.bl_version};
+            verdict = dfu_policy_bootloader_check(&m_dfu_policy, cohort, &current, &offered);
+            break;
+        }
 
         case NRF_MESH_DFU_TYPE_SOFTDEVICE:
-            return false;
+            verdict = dfu_policy_softdevice_check(&m_dfu_policy, cohort, p_current->softdevice, p_offered->softdevice);
+            break;
 
         default:
             return false;
     }
+
+    __LOG(LOG_SRC_APP, LOG_LEVEL_DBG1, "DFU offer of type %u, policy %u verdict %u\n",
+          p_evt->fw_outdated.transfer.dfu_type, m_dfu_policy.policy_id, verdict);
+    return (verdict == DFU_POLICY_ACCEPT);
+}
+
+/* The gateway is the DFU source, and its heartbeats give the distance to it. Heartbeats reach the
+ * application once a heartbeat subscription is configured on the node, see the ReadMe. The
+ * subscription may take heartbeats from any node, so only those from the gateway, the publish
+ * address of the beacon server, are used. */
+static void heartbeat_handle(const nrf_mesh_evt_hb_message_t * p_hb)
+{
+    dsm_handle_t publish_handle;
+    nrf_mesh_address_t gateway;
+    if (access_model_publish_address_get(m_beacon_servers[0].model_handle, &publish_handle) == NRF_SUCCESS &&
+        dsm_address_get(publish_handle, &gateway) == NRF_SUCCESS &&
+        gateway.type == NRF_MESH_ADDRESS_TYPE_UNICAST &&
+        gateway.value == p_hb->src)
+    {
+        dfu_relay_hops_set(&m_dfu_relay, p_hb->hops);
+    }
 }
 
 static void mesh_evt_handler(const nrf_mesh_evt_t* p_evt)
@@ -165,27 +1217,56 @@ static void mesh_evt_handler(const nrf_mesh_evt_t* p_evt)
             {
                 ERROR_CHECK(nrf_mesh_dfu_request(p_evt->params.dfu.fw_outdated.transfer.dfu_type,
                                                  &p_evt->params.dfu.fw_outdated.transfer.id,
-                                                 (uint32_t*) bank_addr));
+                                                 (uint32_t*) m_flash_layout.bank_start));
                 hal_led_mask_set(LEDS_MASK, false); /* Turn off all LEDs */
             }
             else
             {
-                ERROR_CHECK(nrf_mesh_dfu_relay(p_evt->params.dfu.fw_outdated.transfer.dfu_type,
-                                               &p_evt->params.dfu.fw_outdated.transfer.id));
+                dfu_relay_offer(&p_evt->params.dfu.fw_outdated.transfer);
             }
             break;
 
+        case NRF_MESH_EVT_HB_MESSAGE_RECEIVED:
+            heartbeat_handle(&p_evt->params.hb_message);
+            break;
+
+        case NRF_MESH_EVT_TX_COMPLETE:
+            /* The servers share the buffer pool, one of them returns the buffer. */
+            simple_beacon_server_tx_complete(&m_beacon_servers[0], p_evt->params.tx_complete.token);
+            /* Room in the TX queue goes to waiting control messages before the reports. */
+            (void) tx_priority_control_flush();
+            report_scheduler_tx_complete(p_evt->params.tx_complete.token);
+            break;
+
+        case NRF_MESH_EVT_SAR_FAILED:
+            simple_beacon_server_tx_complete(&m_beacon_servers[0], p_evt->params.sar_failed.token);
+            break;
+
         case NRF_MESH_EVT_DFU_START:
+            (void) app_timer_stop(m_dfu_relay_timer);
+            dfu_relay_listen_cancel(&m_dfu_relay);
+            scan_scheduler_dfu_active_set(true);
             hal_led_mask_set(BSP_LED_0_MASK | BSP_LED_2_MASK, true);
+            dfu_progress_start(&m_dfu_progress, p_evt->params.dfu.start.role == NRF_MESH_DFU_ROLE_RELAY,
+                               (uint8_t) p_evt->params.dfu.start.transfer.dfu_type,
+                               dfu_fw_version_get(&p_evt->params.dfu.start.transfer));
+            dfu_status_start();
             break;
 
         case NRF_MESH_EVT_DFU_END:
+            scan_scheduler_dfu_active_set(false);
             hal_led_mask_set(LEDS_MASK, false); /* Turn off all LEDs */
             hal_led_mask_set(BSP_LED_0_MASK | BSP_LED_1_MASK, true); /* Yellow */
+            dfu_progress_end(&m_dfu_progress, p_evt->params.dfu.end.end_reason == NRF_MESH_DFU_END_SUCCESS,
+                             (uint8_t) p_evt->params.dfu.end.end_reason);
+            dfu_status_publish();
             break;
 
         case NRF_MESH_EVT_DFU_BANK_AVAILABLE:
             hal_led_mask_set(LEDS_MASK, false); /* Turn off all LEDs */
+            /* Flashing the bank resets the node, the status may not make it out. */
+            dfu_progress_banked(&m_dfu_progress);
+            dfu_status_publish();
             ERROR_CHECK(nrf_mesh_dfu_bank_flash(p_evt->params.dfu.bank.transfer.dfu_type));
             break;
 
@@ -221,8 +1302,50 @@ static void button_event_handler(uint32_t button_number)
         state change publication due to local event. */
         case 0:
         {
-            uint8_t test_report[16] = "Hello world !!!";
-            simple_beacon_server_report_publish(&m_beacon_server, test_report);
+            simple_beacon_msg_report_t * p_report = (simple_beacon_msg_report_t *) simple_beacon_server_tx_block_alloc(&m_beacon_servers[0]);
+            if (p_report == NULL)
+            {
+                __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "No TX buffer for the test report\n");
+                break;
+            }
+            memcpy(p_report->custome_data, "Hello world !!!", sizeof(p_report->custome_data));
+            uint32_t status = simple_beacon_server_tx_block_publish(&m_beacon_servers[0], SIMPLE_BEACON_OPCODE_REPORT_STATUS,
+                                                                    (uint8_t *) p_report, sizeof(*p_report));
+            if (status != NRF_SUCCESS)
+            {
+                __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "Test report publish failed: %u\n", status);
+            }
+            break;
+        }
+
+        /* Log the scan time counters, used to size the mesh share for a site. */
+        case 1:
+        {
+            scan_scheduler_stats_t stats;
+            scan_scheduler_stats_get(&stats);
+            __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Scan time: mesh %u ms, capture %u ms, DFU %u ms, %u switches\n",
+                  stats.mesh_ms, stats.capture_ms, stats.dfu_ms, stats.switch_count);
+            __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Sightings dropped by the watchlist: %u\n", m_watchlist_drop_count);
+            uint32_t suppressed_count = 0;
+            for (uint32_t i = 0; i < SIMPLE_BEACON_SERVER_SHARD_COUNT; i++)
+            {
+                suppressed_count += m_beacon_servers[i].status_suppressed_count;
+            }
+            __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Redundant status publications suppressed: %u\n", suppressed_count);
+            __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Time sync: %u samples, last error %d ms, drift %d ppb, %u outliers, %u steps\n",
+                  m_time_sync.sample_count, m_time_sync.last_error_ms, m_time_sync.drift_ppb,
+                  m_time_sync.outlier_count, m_time_sync.step_count);
+            static const char * const tx_class_names[TX_PRIORITY_CLASS_COUNT] = {"control", "report", "backlog"};
+            for (uint32_t i = 0; i < TX_PRIORITY_CLASS_COUNT; i++)
+            {
+                tx_priority_stats_t tx_stats;
+                tx_priority_stats_get((tx_priority_class_t) i, &tx_stats);
+                __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "TX %s: depth %u (max %u), %u sent, wait %u ms (avg %u, max %u)\n",
+                      tx_class_names[i], tx_stats.depth, tx_stats.depth_max, tx_stats.sent_count,
+                      tx_stats.wait_ms, tx_stats.wait_avg_ms, tx_stats.wait_max_ms);
+            }
+            __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "DFU relays: %u accepted, %u suppressed\n",
+                  m_dfu_relay.relay_count, m_dfu_relay.suppress_count);
             break;
         }
 
@@ -293,15 +1416,28 @@ static void initialize(void)
 
 #if defined ( __CC_ARM )
     rom_end    = (uint32_t) rom_base + (uint32_t) rom_length;
+    image_end  = rom_end;
 #elif defined   ( __GNUC__ )
     rom_length = (uint32_t) rom_end - rom_base;
+    /* The .data initializers are loaded after the read-only sections, and .nrf_mesh_flash holds
+     * the mesh config entries. Both are part of the image. */
+    image_end  = rom_end + ((uint32_t) &__data_end__ - (uint32_t) &__data_start__);
+    if ((uint32_t) &__stop_nrf_mesh_flash > image_end)
+    {
+        image_end = (uint32_t) &__stop_nrf_mesh_flash;
+    }
 #endif
-    /* Take the next available page address */
-    bank_addr  = (uint32_t) (rom_end & FLASH_PAGE_MASK) + FLASH_PAGE_SIZE;
+    /* Take the next available page address for the report backlog and the page below the mesh
+     * flash for the DFU policy, and put the DFU bank in the largest gap left */
+    uint32_t backlog_addr = (uint32_t) (image_end & FLASH_PAGE_MASK) + FLASH_PAGE_SIZE;
+    uint32_t policy_addr = bootloader_addr_get() - (MESH_FLASH_PAGE_COUNT + 1) * FLASH_PAGE_SIZE;
     __LOG(LOG_SRC_APP, LOG_LEVEL_DBG2, "rom_base   %X\n", rom_base);
     __LOG(LOG_SRC_APP, LOG_LEVEL_DBG2, "rom_end    %X\n", rom_end);
     __LOG(LOG_SRC_APP, LOG_LEVEL_DBG2, "rom_length %X\n", rom_length);
-    __LOG(LOG_SRC_APP, LOG_LEVEL_DBG2, "bank_addr   %X\n", bank_addr);
+    __LOG(LOG_SRC_APP, LOG_LEVEL_DBG2, "image_end  %X\n", image_end);
+    __LOG(LOG_SRC_APP, LOG_LEVEL_DBG2, "backlog_addr %X\n", backlog_addr);
+    __LOG(LOG_SRC_APP, LOG_LEVEL_DBG2, "policy_addr %X\n", policy_addr);
+    flash_layout_plan(backlog_addr, policy_addr);
 
     ERROR_CHECK(app_timer_init());
     hal_leds_init();
@@ -316,6 +1452,64 @@ static void initialize(void)
     m_evt_handler.evt_cb = mesh_evt_handler;
     nrf_mesh_evt_handler_add(&m_evt_handler);
 
+    mesh_flash_user_callback_set(MESH_FLASH_USER_APP, app_flash_op_cb);
+    report_backlog_init(backlog_addr, FLASH_PAGE_SIZE, APP_CONFIG_BACKLOG_PAGE_COUNT);
+    dfu_policy_store_init(policy_addr, FLASH_PAGE_SIZE);
+    if (dfu_policy_store_load(&m_dfu_policy) == NRF_SUCCESS)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "DFU policy %u restored: rollout %u%%, versions %u-%u\n",
+              m_dfu_policy.policy_id, m_dfu_policy.rollout_percent, m_dfu_policy.version_min, m_dfu_policy.version_max);
+    }
+    sighting_table_init(&m_sighting_table);
+    presence_start();
+    watchlist_init(&m_watchlist);
+    time_sync_init(&m_time_sync);
+    eartag_scanner_init(sighting_cb);
+    dfu_progress_init(&m_dfu_progress);
+    eartag_scanner_packet_cb_set(dfu_packet_cb);
+    ERROR_CHECK(app_timer_create(&m_dfu_status_timer, APP_TIMER_MODE_SINGLE_SHOT, dfu_status_timer_handler));
+
+    static const dfu_relay_config_t relay_config =
+    {
+        .listen_ms            = APP_CONFIG_DFU_RELAY_LISTEN_MS,
+        .holdoff_ms           = APP_CONFIG_DFU_RELAY_HOLDOFF_MS,
+        .neighbour_timeout_ms = APP_CONFIG_DFU_RELAY_NEIGHBOUR_TIMEOUT_MS,
+        .target_count         = APP_CONFIG_DFU_RELAY_TARGET_COUNT,
+        .neighbour_rssi       = APP_CONFIG_DFU_RELAY_NEIGHBOUR_RSSI,
+        .edge_rssi            = APP_CONFIG_DFU_RELAY_EDGE_RSSI
+    };
+    dfu_relay_init(&m_dfu_relay, &relay_config, NRF_FICR->DEVICEID[0]);
+    ERROR_CHECK(app_timer_create(&m_dfu_relay_timer, APP_TIMER_MODE_SINGLE_SHOT, dfu_relay_timer_handler));
+
+    report_scheduler_config_t report_config =
+    {
+        .interval_ms    = APP_CONFIG_REPORT_INTERVAL_MS,
+        .backoff_min_ms = APP_CONFIG_REPORT_BACKOFF_MIN_MS,
+        .backoff_max_ms = APP_CONFIG_REPORT_BACKOFF_MAX_MS,
+        .flush_cb       = report_flush_cb
+    };
+    report_scheduler_init(&report_config);
+
+    static const tx_priority_class_config_t tx_classes[TX_PRIORITY_CLASS_COUNT] =
+    {
+        [TX_PRIORITY_CLASS_CONTROL] = {.depth_cb = control_depth_cb, .send_cb = control_send_cb},
+        [TX_PRIORITY_CLASS_REPORT]  = {.depth_cb = report_depth_cb,  .send_cb = report_send_cb},
+        [TX_PRIORITY_CLASS_BACKLOG] = {.depth_cb = backlog_depth_cb, .send_cb = backlog_flush}
+    };
+    tx_priority_init(tx_classes);
+
+    scan_scheduler_config_t scan_config =
+    {
+        .period_ms                = APP_CONFIG_SCAN_SLOT_PERIOD_MS,
+        .mesh_share               = APP_CONFIG_SCAN_MESH_SHARE,
+        .dfu_mesh_share           = APP_CONFIG_SCAN_DFU_MESH_SHARE,
+        .mesh_scan_interval_ms    = APP_CONFIG_SCAN_MESH_INTERVAL_MS,
+        .mesh_scan_window_ms      = APP_CONFIG_SCAN_MESH_WINDOW_MS,
+        .capture_scan_interval_ms = APP_CONFIG_SCAN_INTERVAL_MS,
+        .capture_scan_window_ms   = APP_CONFIG_SCAN_WINDOW_MS
+    };
+    scan_scheduler_init(&scan_config);
+    scanner_config_apply();
 }
 
 static void start(void)
@@ -0,0 +1,277 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "presence.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/** Slot states. Deleted slots keep the probe sequence of later entries intact. */
+#define SLOT_EMPTY      (0)
+#define SLOT_USED       (1)
+#define SLOT_DELETED    (2)
+
+#define SLOT_MASK       (PRESENCE_TABLE_SIZE - 1)
+
+/** Fixed point scale of the filtered RSSI. */
+#define RSSI_SCALE_LOG2 (4)
+
+/** Weight of a new sample in the RSSI filter, as a shift. */
+#define RSSI_FILTER_LOG2 (2)
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static inline uint32_t addr_hash(const uint8_t * p_addr)
+{
+    return presence_addr_fingerprint(p_addr) >> (32 - PRESENCE_TABLE_SIZE_LOG2);
+}
+
+static inline int8_t rssi_get(const presence_entry_t * p_entry)
+{
+    return (int8_t) (p_entry->rssi_filtered / (1 << RSSI_SCALE_LOG2));
+}
+
+static presence_entry_t * entry_find(presence_tracker_t * p_tracker, const uint8_t * p_addr, uint32_t now, presence_entry_t ** pp_free)
+{
+    uint32_t index = addr_hash(p_addr);
+    presence_entry_t * p_entering = NULL;
+
+    *pp_free = NULL;
+    for (uint32_t i = 0; i < PRESENCE_TABLE_PROBE_MAX; i++)
+    {
+        presence_entry_t * p_slot = &p_tracker->entries[(index + i) & SLOT_MASK];
+        if (p_slot->slot == SLOT_USED)
+        {
+            if (memcmp(p_slot->addr, p_addr, EARTAG_ADDR_LEN) == 0)
+            {
+                return p_slot;
+            }
+            /* Entering eartags have not been reported, so they can be given up to make room. Only
+             * those not heard for the enter time are, or eartags in range would keep evicting each
+             * other before any of them is present. */
+            if (p_slot->state == PRESENCE_STATE_ENTERING &&
+                (int32_t) (now - p_slot->heard_timestamp) >= (int32_t) p_tracker->config.enter_ms &&
+                (p_entering == NULL || (int32_t) (p_slot->heard_timestamp - p_entering->heard_timestamp) < 0))
+            {
+                p_entering = p_slot;
+            }
+        }
+        else
+        {
+            if (*pp_free == NULL)
+            {
+                *pp_free = p_slot;
+            }
+            if (p_slot->slot == SLOT_EMPTY)
+            {
+                break;
+            }
+        }
+    }
+
+    if (*pp_free == NULL)
+    {
+        *pp_free = p_entering;
+    }
+    return NULL;
+}
+
+static void entry_remove(presence_tracker_t * p_tracker, presence_entry_t * p_entry)
+{
+    uint32_t index = (uint32_t) (p_entry - p_tracker->entries);
+    /* A deleted marker is only needed when a later entry may have probed past this slot. */
+    p_entry->slot = (p_tracker->entries[(index + 1) & SLOT_MASK].slot == SLOT_EMPTY) ? SLOT_EMPTY : SLOT_DELETED;
+    p_entry->state = PRESENCE_STATE_ABSENT;
+}
+
+static void event_report(presence_tracker_t * p_tracker, const presence_entry_t * p_entry, presence_event_type_t type, uint32_t now)
+{
+    p_tracker->fingerprint ^= presence_addr_fingerprint(p_entry->addr);
+    if (type == PRESENCE_EVENT_ENTER)
+    {
+        p_tracker->present_count++;
+    }
+    else
+    {
+        p_tracker->present_count--;
+    }
+
+    presence_event_t event;
+    memcpy(event.addr, p_entry->addr, EARTAG_ADDR_LEN);
+    event.type = (uint8_t) type;
+    event.rssi = rssi_get(p_entry);
+    event.timestamp = now;
+    p_tracker->config.event_cb(&event);
+}
+
+static void state_set(presence_entry_t * p_entry, presence_state_t state, uint32_t now)
+{
+    p_entry->state = (uint8_t) state;
+    p_entry->state_timestamp = now;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void presence_init(presence_tracker_t * p_tracker, const presence_config_t * p_config)
+{
+    memset(p_tracker, 0, sizeof(*p_tracker));
+    p_tracker->config = *p_config;
+}
+
+void presence_sighting_add(presence_tracker_t * p_tracker, const eartag_sighting_t * p_sighting)
+{
+    const presence_config_t * p_config = &p_tracker->config;
+    uint32_t now = p_sighting->timestamp;
+    presence_entry_t * p_free;
+    presence_entry_t * p_entry = entry_find(p_tracker, p_sighting->addr, now, &p_free);
+
+    if (p_entry == NULL)
+    {
+        if (p_sighting->rssi < p_config->enter_rssi)
+        {
+            return;
+        }
+        if (p_free == NULL)
+        {
+            p_tracker->drop_count++;
+            return;
+        }
+        p_entry = p_free;
+        memcpy(p_entry->addr, p_sighting->addr, EARTAG_ADDR_LEN);
+        p_entry->slot = SLOT_USED;
+        p_entry->rssi_filtered = (int16_t) (p_sighting->rssi * (1 << RSSI_SCALE_LOG2));
+        p_entry->heard_timestamp = now;
+        state_set(p_entry, PRESENCE_STATE_ENTERING, now);
+    }
+    else
+    {
+        int32_t sample = p_sighting->rssi * (1 << RSSI_SCALE_LOG2);
+        p_entry->rssi_filtered += (int16_t) ((sample - p_entry->rssi_filtered) / (1 << RSSI_FILTER_LOG2));
+    }
+
+    int8_t rssi = rssi_get(p_entry);
+    switch (p_entry->state)
+    {
+        case PRESENCE_STATE_ENTERING:
+            if (rssi >= p_config->enter_rssi)
+            {
+                p_entry->heard_timestamp = now;
+                if (now - p_entry->state_timestamp >= p_config->enter_ms)
+                {
+                    state_set(p_entry, PRESENCE_STATE_PRESENT, now);
+                    event_report(p_tracker, p_entry, PRESENCE_EVENT_ENTER, now);
+                }
+            }
+            break;
+
+        case PRESENCE_STATE_PRESENT:
+            if (rssi >= p_config->leave_rssi)
+            {
+                p_entry->heard_timestamp = now;
+            }
+            break;
+
+        case PRESENCE_STATE_LEAVING:
+            if (rssi >= p_config->leave_rssi)
+            {
+                p_entry->heard_timestamp = now;
+                state_set(p_entry, PRESENCE_STATE_PRESENT, now);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void presence_tick(presence_tracker_t * p_tracker, uint32_t now)
+{
+    const presence_config_t * p_config = &p_tracker->config;
+
+    for (uint32_t i = 0; i < PRESENCE_TABLE_SIZE; i++)
+    {
+        presence_entry_t * p_entry = &p_tracker->entries[i];
+        if (p_entry->slot != SLOT_USED)
+        {
+            continue;
+        }
+
+        /* Sighting timestamps may be slightly ahead of the tick time. */
+        int32_t silent_ms = (int32_t) (now - p_entry->heard_timestamp);
+        switch (p_entry->state)
+        {
+            case PRESENCE_STATE_ENTERING:
+                if (silent_ms >= (int32_t) p_config->leave_ms)
+                {
+                    entry_remove(p_tracker, p_entry);
+                }
+                break;
+
+            case PRESENCE_STATE_PRESENT:
+                if (silent_ms >= (int32_t) p_config->leave_ms)
+                {
+                    state_set(p_entry, PRESENCE_STATE_LEAVING, now);
+                }
+                break;
+
+            case PRESENCE_STATE_LEAVING:
+                if ((int32_t) (now - p_entry->state_timestamp) >= (int32_t) p_config->leave_ms)
+                {
+                    event_report(p_tracker, p_entry, PRESENCE_EVENT_LEAVE, now);
+                    entry_remove(p_tracker, p_entry);
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+uint32_t presence_addr_fingerprint(const uint8_t * p_addr)
+{
+    uint32_t low = (uint32_t) p_addr[0] | ((uint32_t) p_addr[1] << 8) |
+                   ((uint32_t) p_addr[2] << 16) | ((uint32_t) p_addr[3] << 24);
+    uint32_t high = (uint32_t) p_addr[4] | ((uint32_t) p_addr[5] << 8);
+    /* Fibonacci hashing, the top bits are the best mixed. */
+    return (low ^ (high * 0x9E37u)) * 0x9E3779B1u;
+}
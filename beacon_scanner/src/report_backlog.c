@@ -0,0 +1,530 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "report_backlog.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "mesh_flash.h"
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+#include "log.h"
+
+/** Page header magic, "BKLG". */
+#define PAGE_MAGIC          (0x474C4B42)
+/** Record header magic. */
+#define RECORD_MAGIC        (0xB10C)
+
+/** Record states. A record is written pending, and drained by clearing the state word. */
+#define RECORD_STATE_PENDING    (0xFFFFFFFF)
+#define RECORD_STATE_DRAINED    (0x00000000)
+
+/** Number of flash operations needed for a record write that opens a new page. */
+#define RECORD_WRITE_OPS_MAX    (3)
+
+typedef struct
+{
+    uint32_t magic; /**< @ref PAGE_MAGIC. */
+    uint32_t seq;   /**< Page sequence number, incremented every time a page is opened. */
+} page_header_t;
+
+typedef struct
+{
+    uint16_t magic;     /**< @ref RECORD_MAGIC. */
+    uint16_t length;    /**< Length of the entries following the header, in bytes. */
+    uint32_t seq;       /**< Record sequence number. */
+    uint32_t timestamp; /**< Time the record was written, in milliseconds. */
+    uint32_t checksum;  /**< Checksum over the fields above and the entries. */
+    uint32_t state;     /**< Record state, the only word written after the record. */
+} record_header_t;
+
+NRF_MESH_STATIC_ASSERT(sizeof(simple_beacon_report_entry_t) % sizeof(uint32_t) == 0);
+
+#define RECORD_SIZE_MAX     (sizeof(record_header_t) + REPORT_BACKLOG_RECORD_ENTRIES_MAX * sizeof(simple_beacon_report_entry_t))
+
+static uint32_t m_start_addr;
+static uint32_t m_page_size;
+static uint32_t m_page_count;
+
+/* Next record is written at this offset of the write page. */
+static uint32_t m_write_page;
+static uint32_t m_write_offset;
+static uint32_t m_page_seq;
+/* Oldest record that may still be pending. */
+static uint32_t m_read_page;
+static uint32_t m_read_offset;
+
+static uint32_t m_record_seq;
+/* Records with a lower sequence number were written before the last reset. */
+static uint32_t m_boot_seq;
+
+static bool m_write_busy;
+static uint16_t m_write_token;
+static report_backlog_stats_t m_stats;
+
+/* Flash operation sources must stay valid until the operation is done. */
+static uint32_t m_write_buffer[RECORD_SIZE_MAX / sizeof(uint32_t)];
+static page_header_t m_page_header;
+static uint32_t m_drained_state = RECORD_STATE_DRAINED;
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static inline uint32_t page_next(uint32_t page)
+{
+    return (page + 1) % m_page_count;
+}
+
+static inline const page_header_t * page_header_get(uint32_t page)
+{
+    return (const page_header_t *) (m_start_addr + page * m_page_size);
+}
+
+static inline const record_header_t * record_get(uint32_t page, uint32_t offset)
+{
+    return (const record_header_t *) (m_start_addr + page * m_page_size + offset);
+}
+
+static inline uint32_t record_size(const record_header_t * p_record)
+{
+    return sizeof(record_header_t) + p_record->length;
+}
+
+static uint32_t record_checksum(const record_header_t * p_record)
+{
+    const uint32_t * p_words = (const uint32_t *) (p_record + 1);
+    uint32_t checksum = ((uint32_t) p_record->length << 16) ^ p_record->magic;
+    checksum = ((checksum << 5) | (checksum >> 27)) ^ p_record->seq;
+    checksum = ((checksum << 5) | (checksum >> 27)) ^ p_record->timestamp;
+    for (uint32_t i = 0; i < p_record->length / sizeof(uint32_t); i++)
+    {
+        checksum = ((checksum << 5) | (checksum >> 27)) ^ p_words[i];
+    }
+    return checksum;
+}
+
+/** Checks whether the record header at @p offset is the start of a record. Erased flash is not. */
+static bool record_is_present(uint32_t page, uint32_t offset)
+{
+    if (offset + sizeof(record_header_t) > m_page_size)
+    {
+        return false;
+    }
+    const record_header_t * p_record = record_get(page, offset);
+    return (p_record->magic == RECORD_MAGIC &&
+            p_record->length > 0 &&
+            p_record->length <= RECORD_SIZE_MAX - sizeof(record_header_t) &&
+            p_record->length % sizeof(simple_beacon_report_entry_t) == 0 &&
+            offset + record_size(p_record) <= m_page_size);
+}
+
+static bool record_is_pending(const record_header_t * p_record)
+{
+    return (p_record->state == RECORD_STATE_PENDING && record_checksum(p_record) == p_record->checksum);
+}
+
+static void record_fill(const record_header_t * p_record, report_backlog_record_t * p_out)
+{
+    p_out->p_entries = (const simple_beacon_report_entry_t *) (p_record + 1);
+    p_out->count = p_record->length / sizeof(simple_beacon_report_entry_t);
+    p_out->seq = p_record->seq;
+    p_out->timestamp = p_record->timestamp;
+    p_out->stale = (int32_t) (p_record->seq - m_boot_seq) < 0;
+}
+
+/** Finds the oldest pending record, moving the read position past drained and torn records. */
+static const record_header_t * head_get(void)
+{
+    if (m_stats.pending_count == 0)
+    {
+        return NULL;
+    }
+
+    for (uint32_t pages = 0; pages <= m_page_count; )
+    {
+        if (page_header_get(m_read_page)->magic == PAGE_MAGIC && record_is_present(m_read_page, m_read_offset))
+        {
+            const record_header_t * p_record = record_get(m_read_page, m_read_offset);
+            if (record_is_pending(p_record))
+            {
+                return p_record;
+            }
+            m_read_offset += record_size(p_record);
+        }
+        else if (m_read_page == m_write_page)
+        {
+            break;
+        }
+        else
+        {
+            m_read_page = page_next(m_read_page);
+            m_read_offset = sizeof(page_header_t);
+            pages++;
+        }
+    }
+
+    /* The count does not match the flash contents, trust the flash. */
+    m_stats.pending_count = 0;
+    return NULL;
+}
+
+/** Counts the pending records from an offset to the end of a page. */
+static uint32_t page_pending_count(uint32_t page, uint32_t offset)
+{
+    uint32_t count = 0;
+    if (page_header_get(page)->magic != PAGE_MAGIC)
+    {
+        return 0;
+    }
+    while (record_is_present(page, offset))
+    {
+        const record_header_t * p_record = record_get(page, offset);
+        if (record_is_pending(p_record))
+        {
+            count++;
+        }
+        offset += record_size(p_record);
+    }
+    return count;
+}
+
+static uint32_t page_open(void)
+{
+    uint32_t page = page_next(m_write_page);
+
+    if (m_stats.pending_count == 0)
+    {
+        /* Nothing pending, keep the read position at the write position. */
+        m_read_page = page;
+        m_read_offset = sizeof(page_header_t);
+    }
+    else if (m_read_page == page)
+    {
+        /* The oldest page is reused, its pending records are lost. */
+        uint32_t lost = page_pending_count(page, m_read_offset);
+        m_stats.pending_count -= lost;
+        m_stats.lost_count += lost;
+        m_read_page = page_next(page);
+        m_read_offset = sizeof(page_header_t);
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "Backlog full, %u records lost\n", lost);
+    }
+
+    flash_operation_t op;
+    op.type = FLASH_OP_TYPE_ERASE;
+    op.params.erase.p_start_addr = (uint32_t *) page_header_get(page);
+    op.params.erase.length = m_page_size;
+    uint16_t token;
+    uint32_t status = mesh_flash_op_push(MESH_FLASH_USER_APP, &op, &token);
+    if (status != NRF_SUCCESS)
+    {
+        return status;
+    }
+
+    m_page_header.magic = PAGE_MAGIC;
+    m_page_header.seq = ++m_page_seq;
+    op.type = FLASH_OP_TYPE_WRITE;
+    op.params.write.p_start_addr = (uint32_t *) page_header_get(page);
+    op.params.write.p_data = (const uint32_t *) &m_page_header;
+    op.params.write.length = sizeof(m_page_header);
+    status = mesh_flash_op_push(MESH_FLASH_USER_APP, &op, &token);
+    if (status != NRF_SUCCESS)
+    {
+        return status;
+    }
+
+    m_write_page = page;
+    m_write_offset = sizeof(page_header_t);
+    return NRF_SUCCESS;
+}
+
+/** Recovers the write position, the read position and the pending count from the flash contents. */
+static void region_scan(void)
+{
+    bool found = false;
+    uint32_t newest_page = 0;
+
+    for (uint32_t page = 0; page < m_page_count; page++)
+    {
+        const page_header_t * p_header = page_header_get(page);
+        if (p_header->magic == PAGE_MAGIC && (!found || (int32_t) (p_header->seq - m_page_seq) > 0))
+        {
+            found = true;
+            newest_page = page;
+            m_page_seq = p_header->seq;
+        }
+    }
+
+    if (!found)
+    {
+        /* Fresh region, the first write opens the first page. */
+        m_page_seq = 0;
+        m_write_page = m_page_count - 1;
+        m_write_offset = m_page_size;
+        m_read_page = m_write_page;
+        m_read_offset = m_write_offset;
+        return;
+    }
+
+    m_write_page = newest_page;
+    m_write_offset = sizeof(page_header_t);
+    while (record_is_present(m_write_page, m_write_offset))
+    {
+        m_write_offset += record_size(record_get(m_write_page, m_write_offset));
+    }
+    if (m_write_offset + sizeof(record_header_t) <= m_page_size &&
+        record_get(m_write_page, m_write_offset)->magic != 0xFFFF)
+    {
+        /* Garbage after the last record, start a new page with the next write. */
+        m_write_offset = m_page_size;
+    }
+
+    /* Walk the ring from the oldest page, which follows the newest one. */
+    bool read_found = false;
+    uint32_t page = page_next(newest_page);
+    for (uint32_t i = 0; i < m_page_count; i++, page = page_next(page))
+    {
+        if (page_header_get(page)->magic != PAGE_MAGIC)
+        {
+            continue;
+        }
+        uint32_t offset = sizeof(page_header_t);
+        while (record_is_present(page, offset))
+        {
+            const record_header_t * p_record = record_get(page, offset);
+            if (record_is_pending(p_record))
+            {
+                if (!read_found)
+                {
+                    read_found = true;
+                    m_read_page = page;
+                    m_read_offset = offset;
+                }
+                m_stats.pending_count++;
+            }
+            if ((int32_t) (p_record->seq - m_record_seq) >= 0)
+            {
+                m_record_seq = p_record->seq + 1;
+            }
+            offset += record_size(p_record);
+        }
+    }
+
+    if (!read_found)
+    {
+        m_read_page = m_write_page;
+        m_read_offset = m_write_offset;
+    }
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void report_backlog_init(uint32_t start_addr, uint32_t page_size, uint32_t page_count)
+{
+    NRF_MESH_ASSERT(page_count >= 2 && RECORD_SIZE_MAX + sizeof(page_header_t) <= page_size);
+
+    m_start_addr = start_addr;
+    m_page_size = page_size;
+    m_page_count = page_count;
+    m_record_seq = 0;
+    m_write_busy = false;
+    memset(&m_stats, 0, sizeof(m_stats));
+
+    region_scan();
+    m_boot_seq = m_record_seq;
+
+    if (m_stats.pending_count > 0)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Backlog: %u records pending\n", m_stats.pending_count);
+    }
+}
+
+uint32_t report_backlog_write(const simple_beacon_report_entry_t * p_entries, uint32_t count, uint32_t timestamp)
+{
+    if (count == 0 || count > REPORT_BACKLOG_RECORD_ENTRIES_MAX)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+    if (m_write_busy)
+    {
+        return NRF_ERROR_BUSY;
+    }
+
+    uint32_t op_count;
+    uint32_t op_bytes;
+    uint32_t status = mesh_flash_op_available(MESH_FLASH_USER_APP, &op_count, &op_bytes);
+    if (status != NRF_SUCCESS || op_count < RECORD_WRITE_OPS_MAX)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    record_header_t * p_record = (record_header_t *) m_write_buffer;
+    p_record->magic = RECORD_MAGIC;
+    p_record->length = (uint16_t) (count * sizeof(simple_beacon_report_entry_t));
+    p_record->seq = m_record_seq;
+    p_record->timestamp = timestamp;
+    p_record->state = RECORD_STATE_PENDING;
+    memcpy(p_record + 1, p_entries, p_record->length);
+    p_record->checksum = record_checksum(p_record);
+
+    if (m_write_offset + record_size(p_record) > m_page_size)
+    {
+        status = page_open();
+        if (status != NRF_SUCCESS)
+        {
+            return status;
+        }
+    }
+
+    flash_operation_t op;
+    op.type = FLASH_OP_TYPE_WRITE;
+    op.params.write.p_start_addr = (uint32_t *) record_get(m_write_page, m_write_offset);
+    op.params.write.p_data = m_write_buffer;
+    op.params.write.length = record_size(p_record);
+    status = mesh_flash_op_push(MESH_FLASH_USER_APP, &op, &m_write_token);
+    if (status == NRF_SUCCESS)
+    {
+        m_write_busy = true;
+        m_write_offset += record_size(p_record);
+        m_record_seq++;
+    }
+    return status;
+}
+
+uint32_t report_backlog_peek(const simple_beacon_report_entry_t ** pp_entries,
+                             uint32_t * p_count,
+                             uint32_t * p_timestamp,
+                             bool * p_stale)
+{
+    const record_header_t * p_record = head_get();
+    if (p_record == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    report_backlog_record_t record;
+    record_fill(p_record, &record);
+    *pp_entries = record.p_entries;
+    *p_count = record.count;
+    *p_timestamp = record.timestamp;
+    *p_stale = record.stale;
+    return NRF_SUCCESS;
+}
+
+uint32_t report_backlog_pop(void)
+{
+    const record_header_t * p_record = head_get();
+    if (p_record == NULL)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    flash_operation_t op;
+    op.type = FLASH_OP_TYPE_WRITE;
+    op.params.write.p_start_addr = (uint32_t *) &p_record->state;
+    op.params.write.p_data = &m_drained_state;
+    op.params.write.length = sizeof(m_drained_state);
+    uint16_t token;
+    /* If the state can not be cleared, the record is sent again after a reset. */
+    (void) mesh_flash_op_push(MESH_FLASH_USER_APP, &op, &token);
+
+    m_read_offset += record_size(p_record);
+    m_stats.pending_count--;
+    m_stats.drained_count++;
+    return NRF_SUCCESS;
+}
+
+uint32_t report_backlog_find(uint32_t seq, report_backlog_record_t * p_record)
+{
+    /* Records are in sequence order from the oldest page, which follows the write page. */
+    uint32_t page = page_next(m_write_page);
+    for (uint32_t i = 0; i < m_page_count; i++, page = page_next(page))
+    {
+        if (page_header_get(page)->magic != PAGE_MAGIC)
+        {
+            continue;
+        }
+        for (uint32_t offset = sizeof(page_header_t);
+             record_is_present(page, offset);
+             offset += record_size(record_get(page, offset)))
+        {
+            const record_header_t * p_found = record_get(page, offset);
+            if ((int32_t) (p_found->seq - seq) >= 0 && record_checksum(p_found) == p_found->checksum)
+            {
+                record_fill(p_found, p_record);
+                return NRF_SUCCESS;
+            }
+        }
+    }
+    return NRF_ERROR_NOT_FOUND;
+}
+
+uint32_t report_backlog_drain_before(uint32_t seq)
+{
+    uint32_t count = 0;
+    const record_header_t * p_record;
+    while ((p_record = head_get()) != NULL && (int32_t) (p_record->seq - seq) < 0)
+    {
+        (void) report_backlog_pop();
+        count++;
+    }
+    return count;
+}
+
+uint32_t report_backlog_count(void)
+{
+    return m_stats.pending_count;
+}
+
+void report_backlog_flash_op_cb(mesh_flash_user_t user, const flash_operation_t * p_op, uint16_t token)
+{
+    if (user == MESH_FLASH_USER_APP && m_write_busy && token == m_write_token)
+    {
+        m_write_busy = false;
+        m_stats.pending_count++;
+        m_stats.written_count++;
+    }
+}
+
+void report_backlog_stats_get(report_backlog_stats_t * p_stats)
+{
+    *p_stats = m_stats;
+}
@@ -0,0 +1,72 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "report_phase.h"
+
+#include <stdint.h>
+
+/** 2^32 divided by the golden ratio. */
+#define GOLDEN_RATIO_32     (0x9E3779B9u)
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void report_phase_init(report_phase_t * p_phase, uint16_t address, uint32_t interval_ms, uint32_t node_count)
+{
+    uint32_t fraction = (uint32_t) address * GOLDEN_RATIO_32;
+
+    p_phase->offset_ms = (uint32_t) (((uint64_t) fraction * interval_ms) >> 32);
+    p_phase->jitter_ms = (node_count > 0) ? interval_ms / node_count / 2 : 0;
+    /* Xorshift state must not be zero. */
+    p_phase->seed = fraction | 1;
+}
+
+uint32_t report_phase_jitter_get(report_phase_t * p_phase)
+{
+    if (p_phase->jitter_ms == 0)
+    {
+        return 0;
+    }
+
+    uint32_t x = p_phase->seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    p_phase->seed = x;
+    return x % p_phase->jitter_ms;
+}
@@ -0,0 +1,246 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "report_scheduler.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "app_timer.h"
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+#include "log.h"
+
+static report_scheduler_config_t m_config;
+static report_scheduler_stats_t m_stats;
+static report_phase_t m_phase;
+
+static nrf_mesh_tx_token_t m_inflight_tokens[REPORT_SCHEDULER_INFLIGHT_MAX];
+static uint32_t m_inflight_count;
+/* Current backoff delay, zero when not backing off. */
+static uint32_t m_backoff_ms;
+/* A flush is scheduled at the minimum timer timeout. */
+static bool m_flush_pending;
+/* Between report_scheduler_start() and report_scheduler_stop(). */
+static bool m_running;
+/* TX complete events counted at the last interval tick. */
+static uint32_t m_tick_tx_complete_count;
+
+APP_TIMER_DEF(m_flush_timer);
+APP_TIMER_DEF(m_interval_timer);
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static void timer_schedule(uint32_t delay_ms)
+{
+    if (!m_running)
+    {
+        return;
+    }
+
+    uint32_t ticks = APP_TIMER_TICKS(delay_ms);
+    if (ticks < APP_TIMER_MIN_TIMEOUT_TICKS)
+    {
+        ticks = APP_TIMER_MIN_TIMEOUT_TICKS;
+    }
+    m_flush_pending = (delay_ms == 0);
+    (void) app_timer_stop(m_flush_timer);
+    ERROR_CHECK(app_timer_start(m_flush_timer, ticks, NULL));
+}
+
+static void flush(void)
+{
+    nrf_mesh_tx_token_t token;
+    bool more = false;
+    uint32_t status = m_config.flush_cb(&token, &more);
+
+    switch (status)
+    {
+        case NRF_SUCCESS:
+            m_stats.flush_count++;
+            m_inflight_tokens[m_inflight_count++] = token;
+            m_backoff_ms = 0;
+            /* Keep going while there is room in the TX queue, otherwise wait for a TX complete event,
+             * with the next interval as a safety net. */
+            if (more && m_inflight_count < REPORT_SCHEDULER_INFLIGHT_MAX)
+            {
+                timer_schedule(0);
+            }
+            break;
+
+        case NRF_ERROR_INVALID_LENGTH:
+            /* Nothing to report until the next interval. */
+            break;
+
+        case NRF_ERROR_NO_MEM:
+            m_stats.no_mem_count++;
+            m_backoff_ms = (m_backoff_ms == 0) ? m_config.backoff_min_ms : m_backoff_ms * 2;
+            if (m_backoff_ms > m_config.backoff_max_ms)
+            {
+                m_backoff_ms = m_config.backoff_max_ms;
+            }
+            __LOG(LOG_SRC_APP, LOG_LEVEL_DBG1, "TX queue full, backing off %u ms\n", m_backoff_ms);
+            timer_schedule(m_backoff_ms);
+            break;
+
+        default:
+            m_stats.error_count++;
+            __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "Report flush failed: %u\n", status);
+            break;
+    }
+}
+
+static void flush_timer_handler(void * p_context)
+{
+    m_flush_pending = false;
+    flush();
+}
+
+/* Ticks on a fixed grid from the start, so the phase of the flushes does not drift however
+ * many early flushes and backoffs there were in between. */
+static void interval_timer_handler(void * p_context)
+{
+    if (m_inflight_count >= REPORT_SCHEDULER_INFLIGHT_MAX && m_stats.tx_complete_count == m_tick_tx_complete_count)
+    {
+        /* A full interval without TX complete events, the tokens are stale. */
+        m_inflight_count = 0;
+    }
+    m_tick_tx_complete_count = m_stats.tx_complete_count;
+
+    /* A pending flush or backoff covers this interval, as does a TX complete event. */
+    if (!m_flush_pending && m_backoff_ms == 0 && m_inflight_count < REPORT_SCHEDULER_INFLIGHT_MAX)
+    {
+        /* Jitter centred on the phase offset, wrapped into the interval so that the flush is
+         * made before the next tick. */
+        uint32_t jitter_ms = report_phase_jitter_get(&m_phase);
+        timer_schedule((m_phase.offset_ms + m_config.interval_ms - m_phase.jitter_ms / 2 + jitter_ms) %
+                       m_config.interval_ms);
+    }
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void report_scheduler_init(const report_scheduler_config_t * p_config)
+{
+    NRF_MESH_ASSERT(p_config != NULL && p_config->flush_cb != NULL);
+    m_config = *p_config;
+    m_inflight_count = 0;
+    m_backoff_ms = 0;
+    m_flush_pending = false;
+    m_running = false;
+    ERROR_CHECK(app_timer_create(&m_flush_timer, APP_TIMER_MODE_SINGLE_SHOT, flush_timer_handler));
+    ERROR_CHECK(app_timer_create(&m_interval_timer, APP_TIMER_MODE_REPEATED, interval_timer_handler));
+}
+
+void report_scheduler_start(const report_phase_t * p_phase)
+{
+    m_phase = *p_phase;
+    if (m_phase.jitter_ms > m_config.interval_ms)
+    {
+        m_phase.jitter_ms = m_config.interval_ms;
+    }
+    (void) app_timer_stop(m_flush_timer);
+    (void) app_timer_stop(m_interval_timer);
+    m_flush_pending = false;
+    m_backoff_ms = 0;
+    m_running = true;
+    m_tick_tx_complete_count = m_stats.tx_complete_count;
+    ERROR_CHECK(app_timer_start(m_interval_timer, APP_TIMER_TICKS(m_config.interval_ms), NULL));
+    interval_timer_handler(NULL);
+}
+
+void report_scheduler_stop(void)
+{
+    m_running = false;
+    m_flush_pending = false;
+    m_backoff_ms = 0;
+    m_inflight_count = 0;
+    (void) app_timer_stop(m_flush_timer);
+    (void) app_timer_stop(m_interval_timer);
+}
+
+void report_scheduler_interval_set(uint32_t interval_ms)
+{
+    m_config.interval_ms = interval_ms;
+}
+
+void report_scheduler_batch_full(void)
+{
+    if (!m_flush_pending && m_backoff_ms == 0 && m_inflight_count < REPORT_SCHEDULER_INFLIGHT_MAX)
+    {
+        timer_schedule(0);
+    }
+}
+
+void report_scheduler_tx_complete(nrf_mesh_tx_token_t token)
+{
+    bool was_blocked = (m_backoff_ms != 0 || m_inflight_count >= REPORT_SCHEDULER_INFLIGHT_MAX);
+
+    for (uint32_t i = 0; i < m_inflight_count; i++)
+    {
+        if (m_inflight_tokens[i] == token)
+        {
+            m_stats.tx_complete_count++;
+            m_inflight_tokens[i] = m_inflight_tokens[--m_inflight_count];
+            break;
+        }
+    }
+
+    /* Any completed transmission frees space in the TX queue. */
+    if (was_blocked && m_inflight_count < REPORT_SCHEDULER_INFLIGHT_MAX && !m_flush_pending)
+    {
+        timer_schedule(0);
+    }
+}
+
+void report_scheduler_resume(void)
+{
+    if (m_backoff_ms != 0 && !m_flush_pending)
+    {
+        m_backoff_ms = 0;
+        timer_schedule(0);
+    }
+}
+
+void report_scheduler_stats_get(report_scheduler_stats_t * p_stats)
+{
+    *p_stats = m_stats;
+}
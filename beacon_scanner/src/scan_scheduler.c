@@ -0,0 +1,234 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "scan_scheduler.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "app_timer.h"
+#include "nrf_mesh_assert.h"
+#include "eartag_scanner.h"
+#include "scanner.h"
+#include "log.h"
+
+static scan_scheduler_config_t m_config;
+static scan_scheduler_stats_t m_stats;
+static scan_scheduler_mode_t m_mode;
+static bool m_enabled;
+static bool m_dfu_active;
+/* Start of the current accounting period, on the eartag scanner millisecond clock. */
+static uint32_t m_account_start_ms;
+
+APP_TIMER_DEF(m_slot_timer);
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static void time_account(void)
+{
+    uint32_t now = eartag_scanner_time_ms_get();
+    uint32_t elapsed = now - m_account_start_ms;
+    m_account_start_ms = now;
+
+    if (m_dfu_active)
+    {
+        m_stats.dfu_ms += elapsed;
+    }
+    if (!m_enabled)
+    {
+        return;
+    }
+    if (m_mode == SCAN_SCHEDULER_MODE_MESH)
+    {
+        m_stats.mesh_ms += elapsed;
+    }
+    else
+    {
+        m_stats.capture_ms += elapsed;
+    }
+}
+
+static uint32_t slot_length_ms(scan_scheduler_mode_t mode)
+{
+    uint32_t share = m_dfu_active ? m_config.dfu_mesh_share : m_config.mesh_share;
+    uint32_t mesh_ms = (m_config.period_ms * share) / 100;
+    return (mode == SCAN_SCHEDULER_MODE_MESH) ? mesh_ms : m_config.period_ms - mesh_ms;
+}
+
+static void scan_time_apply(scan_scheduler_mode_t mode)
+{
+    if (mode == SCAN_SCHEDULER_MODE_CAPTURE)
+    {
+        scanner_config_scan_time_set(m_config.capture_scan_interval_ms * 1000, m_config.capture_scan_window_ms * 1000);
+    }
+    else
+    {
+        scanner_config_scan_time_set(m_config.mesh_scan_interval_ms * 1000, m_config.mesh_scan_window_ms * 1000);
+    }
+}
+
+static void mode_enter(scan_scheduler_mode_t mode)
+{
+    if (mode != m_mode)
+    {
+        m_stats.switch_count++;
+        scan_time_apply(mode);
+    }
+    m_mode = mode;
+    eartag_scanner_enable(mode == SCAN_SCHEDULER_MODE_CAPTURE);
+
+    uint32_t ticks = APP_TIMER_TICKS(slot_length_ms(mode));
+    if (ticks < APP_TIMER_MIN_TIMEOUT_TICKS)
+    {
+        ticks = APP_TIMER_MIN_TIMEOUT_TICKS;
+    }
+    (void) app_timer_stop(m_slot_timer);
+    ERROR_CHECK(app_timer_start(m_slot_timer, ticks, NULL));
+}
+
+static scan_scheduler_mode_t next_mode_get(void)
+{
+    scan_scheduler_mode_t next = (m_mode == SCAN_SCHEDULER_MODE_MESH) ?
+                                 SCAN_SCHEDULER_MODE_CAPTURE : SCAN_SCHEDULER_MODE_MESH;
+    /* A slot with no time, at 0 % or 100 % mesh share, is skipped. */
+    return (slot_length_ms(next) > 0) ? next : m_mode;
+}
+
+static void slot_timeout_handler(void * p_context)
+{
+    time_account();
+    if (m_enabled)
+    {
+        mode_enter(next_mode_get());
+    }
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void scan_scheduler_init(const scan_scheduler_config_t * p_config)
+{
+    NRF_MESH_ASSERT(p_config != NULL && p_config->period_ms > 0 &&
+                    p_config->mesh_share <= 100 && p_config->dfu_mesh_share <= 100 &&
+                    p_config->mesh_scan_window_ms <= p_config->mesh_scan_interval_ms &&
+                    p_config->capture_scan_window_ms <= p_config->capture_scan_interval_ms);
+
+    m_config = *p_config;
+    m_mode = SCAN_SCHEDULER_MODE_MESH;
+    m_enabled = false;
+    m_dfu_active = false;
+    m_account_start_ms = eartag_scanner_time_ms_get();
+    scan_time_apply(m_mode);
+    ERROR_CHECK(app_timer_create(&m_slot_timer, APP_TIMER_MODE_SINGLE_SHOT, slot_timeout_handler));
+}
+
+void scan_scheduler_enable(bool enable)
+{
+    if (enable == m_enabled)
+    {
+        return;
+    }
+
+    time_account();
+    m_enabled = enable;
+    if (enable)
+    {
+        /* Start with the mesh slot, unless the mesh has no share of the period. */
+        mode_enter((slot_length_ms(SCAN_SCHEDULER_MODE_MESH) > 0) ?
+                   SCAN_SCHEDULER_MODE_MESH : SCAN_SCHEDULER_MODE_CAPTURE);
+    }
+    else
+    {
+        (void) app_timer_stop(m_slot_timer);
+        if (m_mode != SCAN_SCHEDULER_MODE_MESH)
+        {
+            m_mode = SCAN_SCHEDULER_MODE_MESH;
+            scan_time_apply(m_mode);
+        }
+        eartag_scanner_enable(false);
+    }
+}
+
+void scan_scheduler_mesh_share_set(uint8_t mesh_share)
+{
+    m_config.mesh_share = (mesh_share > 100) ? 100 : mesh_share;
+}
+
+void scan_scheduler_capture_scan_time_set(uint16_t interval_ms, uint16_t window_ms)
+{
+    NRF_MESH_ASSERT(window_ms <= interval_ms);
+
+    m_config.capture_scan_interval_ms = interval_ms;
+    m_config.capture_scan_window_ms = window_ms;
+    if (m_enabled && m_mode == SCAN_SCHEDULER_MODE_CAPTURE)
+    {
+        scan_time_apply(m_mode);
+    }
+}
+
+void scan_scheduler_dfu_active_set(bool active)
+{
+    if (active == m_dfu_active)
+    {
+        return;
+    }
+
+    time_account();
+    m_dfu_active = active;
+    __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "DFU %s, mesh share %u %%\n", active ? "active" : "done",
+          active ? m_config.dfu_mesh_share : m_config.mesh_share);
+    if (m_enabled)
+    {
+        /* Switch to the DFU share right away instead of finishing the capture slot. */
+        mode_enter((slot_length_ms(SCAN_SCHEDULER_MODE_MESH) > 0) ?
+                   SCAN_SCHEDULER_MODE_MESH : SCAN_SCHEDULER_MODE_CAPTURE);
+    }
+}
+
+scan_scheduler_mode_t scan_scheduler_mode_get(void)
+{
+    return m_mode;
+}
+
+void scan_scheduler_stats_get(scan_scheduler_stats_t * p_stats)
+{
+    time_account();
+    *p_stats = m_stats;
+}
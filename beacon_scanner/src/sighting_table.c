@@ -0,0 +1,244 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sighting_table.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/** Slot states. Deleted slots keep the probe sequence of later entries intact. */
+#define SLOT_EMPTY      (0)
+#define SLOT_USED       (1)
+#define SLOT_DELETED    (2)
+
+#define SLOT_MASK       (SIGHTING_TABLE_SIZE - 1)
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static inline uint32_t addr_hash(const uint8_t * p_addr)
+{
+    uint32_t low = (uint32_t) p_addr[0] | ((uint32_t) p_addr[1] << 8) |
+                   ((uint32_t) p_addr[2] << 16) | ((uint32_t) p_addr[3] << 24);
+    uint32_t high = (uint32_t) p_addr[4] | ((uint32_t) p_addr[5] << 8);
+    /* Fibonacci hashing, the top bits are the best mixed. */
+    return ((low ^ (high * 0x9E37u)) * 0x9E3779B1u) >> (32 - SIGHTING_TABLE_SIZE_LOG2);
+}
+
+static inline bool addr_equal(const uint8_t * p_a, const uint8_t * p_b)
+{
+    return memcmp(p_a, p_b, EARTAG_ADDR_LEN) == 0;
+}
+
+/**
+ * Finds the slot for an address, making room for it if necessary.
+ *
+ * @returns The slot to aggregate into. The slot state is @ref SLOT_USED if it already holds the address.
+ */
+static sighting_entry_t * slot_get(sighting_table_t * p_table, const uint8_t * p_addr, sighting_entry_t * p_evicted, bool * p_did_evict)
+{
+    uint32_t index = addr_hash(p_addr);
+    sighting_entry_t * p_free = NULL;
+    sighting_entry_t * p_oldest = NULL;
+
+    *p_did_evict = false;
+    for (uint32_t i = 0; i < SIGHTING_TABLE_PROBE_MAX; i++)
+    {
+        sighting_entry_t * p_slot = &p_table->entries[(index + i) & SLOT_MASK];
+        if (p_slot->state == SLOT_USED)
+        {
+            if (addr_equal(p_slot->addr, p_addr))
+            {
+                return p_slot;
+            }
+            if (p_oldest == NULL || (int32_t) (p_slot->last_timestamp - p_oldest->last_timestamp) < 0)
+            {
+                p_oldest = p_slot;
+            }
+        }
+        else
+        {
+            if (p_free == NULL)
+            {
+                p_free = p_slot;
+            }
+            if (p_slot->state == SLOT_EMPTY)
+            {
+                /* The address can not be further along the probe sequence. */
+                break;
+            }
+        }
+    }
+
+    if (p_free == NULL)
+    {
+        if (p_evicted != NULL)
+        {
+            *p_evicted = *p_oldest;
+        }
+        *p_did_evict = true;
+        p_table->evict_count++;
+        p_table->count--;
+        p_free = p_oldest;
+    }
+    p_free->state = SLOT_EMPTY;
+    return p_free;
+}
+
+static bool entry_merge(sighting_table_t * p_table, const sighting_entry_t * p_entry, sighting_entry_t * p_evicted)
+{
+    bool did_evict;
+    sighting_entry_t * p_slot = slot_get(p_table, p_entry->addr, p_evicted, &did_evict);
+
+    if (p_slot->state != SLOT_USED)
+    {
+        *p_slot = *p_entry;
+        p_slot->state = SLOT_USED;
+        p_table->count++;
+        return did_evict;
+    }
+
+    uint32_t count = (uint32_t) p_slot->count + p_entry->count;
+    p_slot->count = (count > UINT16_MAX) ? UINT16_MAX : (uint16_t) count;
+    p_slot->rssi_sum += p_entry->rssi_sum;
+    if (p_entry->rssi_min < p_slot->rssi_min)
+    {
+        p_slot->rssi_min = p_entry->rssi_min;
+    }
+    if (p_entry->rssi_max > p_slot->rssi_max)
+    {
+        p_slot->rssi_max = p_entry->rssi_max;
+    }
+    if ((int32_t) (p_entry->first_timestamp - p_slot->first_timestamp) < 0)
+    {
+        p_slot->first_timestamp = p_entry->first_timestamp;
+    }
+    if ((int32_t) (p_entry->last_timestamp - p_slot->last_timestamp) > 0)
+    {
+        p_slot->last_timestamp = p_entry->last_timestamp;
+        p_slot->tx_power = p_entry->tx_power;
+        p_slot->major = p_entry->major;
+        p_slot->minor = p_entry->minor;
+    }
+    return did_evict;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void sighting_table_init(sighting_table_t * p_table)
+{
+    memset(p_table, 0, sizeof(*p_table));
+}
+
+bool sighting_table_insert(sighting_table_t * p_table,
+                           const eartag_sighting_t * p_sighting,
+                           sighting_entry_t * p_evicted)
+{
+    bool did_evict;
+    sighting_entry_t * p_slot = slot_get(p_table, p_sighting->addr, p_evicted, &did_evict);
+
+    if (p_slot->state != SLOT_USED)
+    {
+        memcpy(p_slot->addr, p_sighting->addr, EARTAG_ADDR_LEN);
+        p_slot->state = SLOT_USED;
+        p_slot->count = 0;
+        p_slot->rssi_min = p_sighting->rssi;
+        p_slot->rssi_max = p_sighting->rssi;
+        p_slot->rssi_sum = 0;
+        p_slot->first_timestamp = p_sighting->timestamp;
+        p_table->count++;
+    }
+
+    if (p_slot->count < UINT16_MAX)
+    {
+        p_slot->count++;
+    }
+    p_slot->rssi_sum += p_sighting->rssi;
+    if (p_sighting->rssi < p_slot->rssi_min)
+    {
+        p_slot->rssi_min = p_sighting->rssi;
+    }
+    if (p_sighting->rssi > p_slot->rssi_max)
+    {
+        p_slot->rssi_max = p_sighting->rssi;
+    }
+    p_slot->last_timestamp = p_sighting->timestamp;
+    p_slot->tx_power = p_sighting->tx_power;
+    p_slot->major = p_sighting->major;
+    p_slot->minor = p_sighting->minor;
+    return did_evict;
+}
+
+bool sighting_table_merge(sighting_table_t * p_table,
+                          const sighting_entry_t * p_entry,
+                          sighting_entry_t * p_evicted)
+{
+    return entry_merge(p_table, p_entry, p_evicted);
+}
+
+uint32_t sighting_table_drain(sighting_table_t * p_table, sighting_entry_t * p_entries, uint32_t max_count)
+{
+    uint32_t drained = 0;
+    for (uint32_t i = 0; i < SIGHTING_TABLE_SIZE && drained < max_count && p_table->count > 0; i++)
+    {
+        sighting_entry_t * p_slot = &p_table->entries[p_table->drain_cursor];
+        p_table->drain_cursor = (p_table->drain_cursor + 1) & SLOT_MASK;
+        if (p_slot->state == SLOT_USED)
+        {
+            p_entries[drained] = *p_slot;
+            p_entries[drained].state = SLOT_EMPTY;
+            p_slot->state = SLOT_DELETED;
+            p_table->count--;
+            drained++;
+        }
+    }
+
+    if (p_table->count == 0)
+    {
+        /* Nothing left to probe past, clear the deleted markers. */
+        for (uint32_t i = 0; i < SIGHTING_TABLE_SIZE; i++)
+        {
+            p_table->entries[i].state = SLOT_EMPTY;
+        }
+        p_table->drain_cursor = 0;
+    }
+    return drained;
+}
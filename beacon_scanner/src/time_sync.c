@@ -0,0 +1,155 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "time_sync.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/** Share of a drift measurement applied to the drift estimate, as a right shift. */
+#define DRIFT_SHIFT     (2)
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static uint32_t network_time_estimate(const time_sync_t * p_sync, uint32_t local_ms)
+{
+    uint32_t elapsed = local_ms - p_sync->local_ref;
+    int32_t correction = (int32_t) (((int64_t) elapsed * p_sync->drift_ppb) / 1000000000);
+    return p_sync->network_ref + elapsed + (uint32_t) correction;
+}
+
+static void restart(time_sync_t * p_sync, uint32_t local_ms, uint32_t network_ms)
+{
+    p_sync->local_ref = local_ms;
+    p_sync->network_ref = network_ms;
+    p_sync->window_count = 0;
+    p_sync->prev_valid = false;
+}
+
+static void drift_update(time_sync_t * p_sync)
+{
+    uint32_t span = p_sync->window_local - p_sync->prev_local;
+    if (span == 0)
+    {
+        return;
+    }
+
+    int64_t measured = (int64_t) (int32_t) (p_sync->window_offset - p_sync->prev_offset) * 1000000000 / span;
+    int64_t drift = p_sync->drift_ppb + ((measured - p_sync->drift_ppb) >> DRIFT_SHIFT);
+    if (drift > TIME_SYNC_DRIFT_MAX_PPB)
+    {
+        drift = TIME_SYNC_DRIFT_MAX_PPB;
+    }
+    else if (drift < -TIME_SYNC_DRIFT_MAX_PPB)
+    {
+        drift = -TIME_SYNC_DRIFT_MAX_PPB;
+    }
+    p_sync->drift_ppb = (int32_t) drift;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void time_sync_init(time_sync_t * p_sync)
+{
+    memset(p_sync, 0, sizeof(*p_sync));
+}
+
+void time_sync_sample_add(time_sync_t * p_sync, uint32_t local_ms, uint32_t network_ms, uint32_t hops, uint32_t hop_delay_ms)
+{
+    network_ms += hops * hop_delay_ms;
+    p_sync->sample_count++;
+
+    if (!p_sync->synced)
+    {
+        p_sync->synced = true;
+        restart(p_sync, local_ms, network_ms);
+    }
+
+    int32_t error = (int32_t) (network_ms - network_time_estimate(p_sync, local_ms));
+    p_sync->last_error_ms = error;
+    if (error > TIME_SYNC_OUTLIER_MS || error < -TIME_SYNC_OUTLIER_MS)
+    {
+        p_sync->outlier_count++;
+        if (++p_sync->outlier_run < TIME_SYNC_OUTLIERS_STEP)
+        {
+            return;
+        }
+        /* The samples agree with each other, not with the estimate: the network time stepped. */
+        p_sync->step_count++;
+        restart(p_sync, local_ms, network_ms);
+    }
+    p_sync->outlier_run = 0;
+
+    /* Relay delays only make samples late, the sample with the highest offset was delayed the least. */
+    uint32_t offset = network_ms - local_ms;
+    if (p_sync->window_count == 0 || (int32_t) (offset - p_sync->window_offset) > 0)
+    {
+        p_sync->window_local = local_ms;
+        p_sync->window_offset = offset;
+    }
+
+    if (++p_sync->window_count < TIME_SYNC_WINDOW)
+    {
+        return;
+    }
+
+    if (p_sync->prev_valid)
+    {
+        drift_update(p_sync);
+    }
+    p_sync->prev_valid = true;
+    p_sync->prev_local = p_sync->window_local;
+    p_sync->prev_offset = p_sync->window_offset;
+    p_sync->local_ref = p_sync->window_local;
+    p_sync->network_ref = p_sync->window_local + p_sync->window_offset;
+    p_sync->window_count = 0;
+}
+
+bool time_sync_network_time_get(const time_sync_t * p_sync, uint32_t local_ms, uint32_t * p_network_ms)
+{
+    if (!p_sync->synced)
+    {
+        return false;
+    }
+    *p_network_ms = network_time_estimate(p_sync, local_ms);
+    return true;
+}
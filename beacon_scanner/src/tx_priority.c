@@ -0,0 +1,159 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tx_priority.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "nrf_error.h"
+#include "nrf_mesh_assert.h"
+
+/* Weight of the last sample in the average time waited, as a power of two. */
+#define WAIT_AVG_SHIFT  (3)
+
+static tx_priority_class_config_t m_classes[TX_PRIORITY_CLASS_COUNT];
+static tx_priority_stats_t m_stats[TX_PRIORITY_CLASS_COUNT];
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static uint32_t depth_sample(tx_priority_class_t traffic_class)
+{
+    tx_priority_stats_t * p_stats = &m_stats[traffic_class];
+    p_stats->depth = m_classes[traffic_class].depth_cb();
+    if (p_stats->depth > p_stats->depth_max)
+    {
+        p_stats->depth_max = p_stats->depth;
+    }
+    return p_stats->depth;
+}
+
+static void sent_record(tx_priority_class_t traffic_class, uint32_t wait_ms)
+{
+    tx_priority_stats_t * p_stats = &m_stats[traffic_class];
+    p_stats->sent_count++;
+    if (wait_ms == TX_PRIORITY_WAIT_UNKNOWN)
+    {
+        return;
+    }
+
+    p_stats->wait_ms = wait_ms;
+    if (wait_ms > p_stats->wait_max_ms)
+    {
+        p_stats->wait_max_ms = wait_ms;
+    }
+    if (p_stats->wait_samples++ == 0)
+    {
+        p_stats->wait_avg_ms = wait_ms;
+    }
+    else
+    {
+        /* Signed difference, the average moves down as well as up. */
+        p_stats->wait_avg_ms = (uint32_t) ((int32_t) p_stats->wait_avg_ms +
+                                           ((int32_t) (wait_ms - p_stats->wait_avg_ms) >> WAIT_AVG_SHIFT));
+    }
+}
+
+/* Sends the next message of a class. */
+static uint32_t class_send(tx_priority_class_t traffic_class, nrf_mesh_tx_token_t * p_token)
+{
+    uint32_t wait_ms = TX_PRIORITY_WAIT_UNKNOWN;
+    uint32_t status = m_classes[traffic_class].send_cb(p_token, &wait_ms);
+    if (status == NRF_SUCCESS)
+    {
+        sent_record(traffic_class, wait_ms);
+    }
+    return status;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void tx_priority_init(const tx_priority_class_config_t * p_classes)
+{
+    NRF_MESH_ASSERT(p_classes != NULL);
+    for (uint32_t i = 0; i < TX_PRIORITY_CLASS_COUNT; i++)
+    {
+        NRF_MESH_ASSERT(p_classes[i].depth_cb != NULL && p_classes[i].send_cb != NULL);
+        m_classes[i] = p_classes[i];
+    }
+    memset(m_stats, 0, sizeof(m_stats));
+}
+
+uint32_t tx_priority_flush(nrf_mesh_tx_token_t * p_token, bool * p_more)
+{
+    uint32_t status = NRF_ERROR_INVALID_LENGTH;
+    for (uint32_t i = 0; i < TX_PRIORITY_CLASS_COUNT && status == NRF_ERROR_INVALID_LENGTH; i++)
+    {
+        if (depth_sample((tx_priority_class_t) i) > 0)
+        {
+            status = class_send((tx_priority_class_t) i, p_token);
+        }
+    }
+
+    *p_more = false;
+    for (uint32_t i = 0; i < TX_PRIORITY_CLASS_COUNT && !*p_more; i++)
+    {
+        *p_more = (m_classes[i].depth_cb() > 0);
+    }
+    return status;
+}
+
+uint32_t tx_priority_control_flush(void)
+{
+    uint32_t status = NRF_ERROR_INVALID_LENGTH;
+    nrf_mesh_tx_token_t token;
+    while (depth_sample(TX_PRIORITY_CLASS_CONTROL) > 0)
+    {
+        status = class_send(TX_PRIORITY_CLASS_CONTROL, &token);
+        if (status != NRF_SUCCESS)
+        {
+            break;
+        }
+    }
+    return status;
+}
+
+void tx_priority_stats_get(tx_priority_class_t traffic_class, tx_priority_stats_t * p_stats)
+{
+    NRF_MESH_ASSERT(traffic_class < TX_PRIORITY_CLASS_COUNT && p_stats != NULL);
+    *p_stats = m_stats[traffic_class];
+}
@@ -0,0 +1,238 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "watchlist.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static inline uint64_t addr_value(const uint8_t * p_addr)
+{
+    uint64_t value = 0;
+    for (uint32_t i = EARTAG_ADDR_LEN; i > 0; i--)
+    {
+        value = (value << 8) | p_addr[i - 1];
+    }
+    return value;
+}
+
+static bool bloom_match(const watchlist_filter_t * p_filter, const uint8_t * p_addr)
+{
+    uint32_t bit_count = (uint32_t) p_filter->length * 8;
+    uint32_t h1;
+    uint32_t h2;
+    watchlist_addr_hash(p_addr, &h1, &h2);
+
+    for (uint32_t i = 0; i < p_filter->hash_count; i++)
+    {
+        uint32_t bit = (h1 + i * h2) % bit_count;
+        if ((p_filter->data[bit / 8] & (1u << (bit % 8))) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool sorted_match(const watchlist_filter_t * p_filter, const uint8_t * p_addr)
+{
+    uint64_t key = addr_value(p_addr);
+    uint32_t low = 0;
+    uint32_t high = p_filter->length / EARTAG_ADDR_LEN;
+
+    while (low < high)
+    {
+        uint32_t mid = low + (high - low) / 2;
+        uint64_t value = addr_value(&p_filter->data[mid * EARTAG_ADDR_LEN]);
+        if (value == key)
+        {
+            return true;
+        }
+        if (value < key)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    return false;
+}
+
+static bool filter_is_valid(const watchlist_filter_t * p_filter)
+{
+    switch (p_filter->format)
+    {
+        case WATCHLIST_FORMAT_BLOOM:
+            return (p_filter->length > 0 &&
+                    p_filter->hash_count > 0 &&
+                    p_filter->hash_count <= WATCHLIST_HASH_COUNT_MAX);
+
+        case WATCHLIST_FORMAT_SORTED:
+            if (p_filter->length % EARTAG_ADDR_LEN != 0)
+            {
+                return false;
+            }
+            /* Binary search needs strictly increasing addresses. */
+            for (uint32_t i = EARTAG_ADDR_LEN; i < p_filter->length; i += EARTAG_ADDR_LEN)
+            {
+                if (addr_value(&p_filter->data[i - EARTAG_ADDR_LEN]) >= addr_value(&p_filter->data[i]))
+                {
+                    return false;
+                }
+            }
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void watchlist_init(watchlist_t * p_watchlist)
+{
+    memset(p_watchlist, 0, sizeof(*p_watchlist));
+    p_watchlist->p_active = NULL;
+    p_watchlist->p_staging = &p_watchlist->filters[0];
+}
+
+watchlist_status_t watchlist_chunk_add(watchlist_t * p_watchlist,
+                                       uint8_t transfer_id,
+                                       uint8_t format,
+                                       uint8_t hash_count,
+                                       uint16_t total_length,
+                                       uint16_t offset,
+                                       const uint8_t * p_data,
+                                       uint16_t length)
+{
+    watchlist_filter_t * p_staging = p_watchlist->p_staging;
+
+    if (!p_watchlist->receiving &&
+        p_watchlist->p_active != NULL &&
+        p_watchlist->p_active->transfer_id == transfer_id &&
+        p_watchlist->p_active->length == total_length)
+    {
+        /* Retry of a chunk of the transfer that already completed. */
+        p_watchlist->received = total_length;
+        return WATCHLIST_STATUS_COMPLETE;
+    }
+
+    if (offset == 0)
+    {
+        if (total_length > WATCHLIST_SIZE_MAX)
+        {
+            p_watchlist->receiving = false;
+            p_watchlist->received = 0;
+            return WATCHLIST_STATUS_TOO_LARGE;
+        }
+        p_staging->transfer_id = transfer_id;
+        p_staging->format = format;
+        p_staging->hash_count = hash_count;
+        p_staging->length = total_length;
+        p_watchlist->received = 0;
+        p_watchlist->receiving = true;
+    }
+    else if (!p_watchlist->receiving || transfer_id != p_staging->transfer_id || offset > p_watchlist->received)
+    {
+        return WATCHLIST_STATUS_OUT_OF_ORDER;
+    }
+
+    if ((uint32_t) offset + length > p_staging->length)
+    {
+        return WATCHLIST_STATUS_OUT_OF_ORDER;
+    }
+
+    /* Chunks overlapping the received data are retries, only the new part is copied. */
+    uint32_t end = (uint32_t) offset + length;
+    if (end > p_watchlist->received)
+    {
+        memcpy(&p_staging->data[p_watchlist->received],
+               &p_data[p_watchlist->received - offset],
+               end - p_watchlist->received);
+        p_watchlist->received = (uint16_t) end;
+    }
+
+    if (p_watchlist->received < p_staging->length)
+    {
+        return WATCHLIST_STATUS_IN_PROGRESS;
+    }
+
+    p_watchlist->receiving = false;
+    if (!filter_is_valid(p_staging))
+    {
+        p_watchlist->received = 0;
+        return WATCHLIST_STATUS_INVALID;
+    }
+
+    /* Single store, the ingestion path sees either the old or the new watchlist. */
+    p_watchlist->p_staging = (p_staging == &p_watchlist->filters[0]) ? &p_watchlist->filters[1] : &p_watchlist->filters[0];
+    p_watchlist->p_active = p_staging;
+    return WATCHLIST_STATUS_COMPLETE;
+}
+
+void watchlist_clear(watchlist_t * p_watchlist)
+{
+    p_watchlist->p_active = NULL;
+}
+
+bool watchlist_match(const watchlist_t * p_watchlist, const uint8_t * p_addr)
+{
+    const watchlist_filter_t * p_filter = p_watchlist->p_active;
+    if (p_filter == NULL)
+    {
+        return true;
+    }
+    return (p_filter->format == WATCHLIST_FORMAT_BLOOM) ? bloom_match(p_filter, p_addr) : sorted_match(p_filter, p_addr);
+}
+
+void watchlist_addr_hash(const uint8_t * p_addr, uint32_t * p_h1, uint32_t * p_h2)
+{
+    uint32_t low = (uint32_t) p_addr[0] | ((uint32_t) p_addr[1] << 8) |
+                   ((uint32_t) p_addr[2] << 16) | ((uint32_t) p_addr[3] << 24);
+    uint32_t high = (uint32_t) p_addr[4] | ((uint32_t) p_addr[5] << 8);
+    *p_h1 = (low ^ (high * 0x9E37u)) * 0x9E3779B1u;
+    *p_h2 = (((low * 0x85EBCA6Bu) ^ (high * 0xC2B2u)) * 0x27D4EB2Fu) | 1u;
+}
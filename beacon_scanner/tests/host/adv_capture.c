@@ -0,0 +1,282 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "adv_capture.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** pcap magic numbers, as read on a little endian host. */
+#define PCAP_MAGIC_US           (0xA1B2C3D4u)
+#define PCAP_MAGIC_NS           (0xA1B23C4Du)
+#define PCAP_MAGIC_US_SWAPPED   (0xD4C3B2A1u)
+#define PCAP_MAGIC_NS_SWAPPED   (0x4D3CB2A1u)
+
+#define PCAP_HEADER_SIZE        (24)
+#define PCAP_RECORD_HEADER_SIZE (16)
+
+/** BLE link layer packets, preceded by a pseudo-header with the RF channel and signal power. */
+#define LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR  (256)
+
+#define PHDR_SIZE               (10)
+#define PHDR_FLAG_DEWHITENED    (0x0001)
+#define PHDR_FLAG_SIGNAL_VALID  (0x0002)
+#define PHDR_FLAG_CRC_CHECKED   (0x0400)
+#define PHDR_FLAG_CRC_VALID     (0x0800)
+
+#define ADV_ACCESS_ADDRESS      (0x8E89BED6u)
+#define LL_HEADER_SIZE          (2)
+#define LL_CRC_SIZE             (3)
+#define LL_PACKET_SIZE_MAX      (4 + LL_HEADER_SIZE + ADV_CAPTURE_ADDR_LEN + ADV_CAPTURE_DATA_LEN_MAX + LL_CRC_SIZE)
+
+#define PDU_TYPE_ADV_IND         (0x0)
+#define PDU_TYPE_ADV_NONCONN_IND (0x2)
+#define PDU_TYPE_SCAN_RSP        (0x4)
+#define PDU_TYPE_ADV_SCAN_IND    (0x6)
+
+#define ADV_CHANNEL_37          (37)
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static uint32_t u32_get(const uint8_t * p_data, bool swapped)
+{
+    if (swapped)
+    {
+        return ((uint32_t) p_data[0] << 24) | ((uint32_t) p_data[1] << 16) | ((uint32_t) p_data[2] << 8) | p_data[3];
+    }
+    return ((uint32_t) p_data[3] << 24) | ((uint32_t) p_data[2] << 16) | ((uint32_t) p_data[1] << 8) | p_data[0];
+}
+
+static void u32_put(uint8_t * p_data, uint32_t value)
+{
+    p_data[0] = (uint8_t) value;
+    p_data[1] = (uint8_t) (value >> 8);
+    p_data[2] = (uint8_t) (value >> 16);
+    p_data[3] = (uint8_t) (value >> 24);
+}
+
+static void u16_put(uint8_t * p_data, uint16_t value)
+{
+    p_data[0] = (uint8_t) value;
+    p_data[1] = (uint8_t) (value >> 8);
+}
+
+static bool is_adv_with_data(uint8_t pdu_type)
+{
+    return (pdu_type == PDU_TYPE_ADV_IND || pdu_type == PDU_TYPE_ADV_NONCONN_IND ||
+            pdu_type == PDU_TYPE_SCAN_RSP || pdu_type == PDU_TYPE_ADV_SCAN_IND);
+}
+
+static adv_capture_record_t * record_add(adv_capture_t * p_capture)
+{
+    if (p_capture->count == p_capture->capacity)
+    {
+        uint32_t capacity = (p_capture->capacity == 0) ? 1024 : p_capture->capacity * 2;
+        adv_capture_record_t * p_records = realloc(p_capture->p_records, capacity * sizeof(p_records[0]));
+        if (p_records == NULL)
+        {
+            return NULL;
+        }
+        p_capture->p_records = p_records;
+        p_capture->capacity = capacity;
+    }
+    return &p_capture->p_records[p_capture->count++];
+}
+
+/* Converts one pcap packet, returns false if it is not an advertisement with data. */
+static bool packet_parse(const uint8_t * p_packet, uint32_t length, adv_capture_record_t * p_record)
+{
+    if (length < PHDR_SIZE + 4 + LL_HEADER_SIZE + ADV_CAPTURE_ADDR_LEN)
+    {
+        return false;
+    }
+
+    /* The pseudo-header is little endian whatever the byte order of the file. */
+    uint16_t flags = (uint16_t) (p_packet[8] | (p_packet[9] << 8));
+    if ((flags & PHDR_FLAG_CRC_CHECKED) && !(flags & PHDR_FLAG_CRC_VALID))
+    {
+        return false;
+    }
+
+    const uint8_t * p_ll = &p_packet[PHDR_SIZE];
+    uint8_t pdu_type = p_ll[4] & 0x0F;
+    uint8_t pdu_length = p_ll[5];
+    if (u32_get(p_ll, false) != ADV_ACCESS_ADDRESS || !is_adv_with_data(pdu_type) ||
+        pdu_length < ADV_CAPTURE_ADDR_LEN || pdu_length > ADV_CAPTURE_ADDR_LEN + ADV_CAPTURE_DATA_LEN_MAX ||
+        (uint32_t) (PHDR_SIZE + 4 + LL_HEADER_SIZE + pdu_length) > length)
+    {
+        return false;
+    }
+
+    p_record->rssi = (flags & PHDR_FLAG_SIGNAL_VALID) ? (int8_t) p_packet[1] : 0;
+    memcpy(p_record->addr, &p_ll[4 + LL_HEADER_SIZE], ADV_CAPTURE_ADDR_LEN);
+    p_record->length = (uint8_t) (pdu_length - ADV_CAPTURE_ADDR_LEN);
+    memcpy(p_record->data, &p_ll[4 + LL_HEADER_SIZE + ADV_CAPTURE_ADDR_LEN], p_record->length);
+    return true;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+bool adv_capture_load(const char * p_path, adv_capture_t * p_capture)
+{
+    FILE * p_file = fopen(p_path, "rb");
+    if (p_file == NULL)
+    {
+        return false;
+    }
+
+    uint8_t header[PCAP_HEADER_SIZE];
+    if (fread(header, sizeof(header), 1, p_file) != 1)
+    {
+        fclose(p_file);
+        return false;
+    }
+
+    uint32_t magic = u32_get(header, false);
+    bool swapped = (magic == PCAP_MAGIC_US_SWAPPED || magic == PCAP_MAGIC_NS_SWAPPED);
+    bool nanoseconds = (magic == PCAP_MAGIC_NS || magic == PCAP_MAGIC_NS_SWAPPED);
+    if ((!swapped && magic != PCAP_MAGIC_US && magic != PCAP_MAGIC_NS) ||
+        u32_get(&header[20], swapped) != LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR)
+    {
+        fclose(p_file);
+        return false;
+    }
+
+    uint32_t base_ms = (p_capture->count > 0) ? p_capture->p_records[p_capture->count - 1].timestamp : 0;
+    uint64_t first_ms = UINT64_MAX;
+    uint8_t record_header[PCAP_RECORD_HEADER_SIZE];
+    uint8_t packet[PHDR_SIZE + LL_PACKET_SIZE_MAX];
+    bool success = true;
+
+    while (fread(record_header, sizeof(record_header), 1, p_file) == 1)
+    {
+        uint32_t captured_length = u32_get(&record_header[8], swapped);
+        uint32_t length = (captured_length < sizeof(packet)) ? captured_length : sizeof(packet);
+        if (fread(packet, 1, length, p_file) != length ||
+            fseek(p_file, (long) (captured_length - length), SEEK_CUR) != 0)
+        {
+            /* Truncated capture, keep what was read. */
+            break;
+        }
+
+        adv_capture_record_t record;
+        if (!packet_parse(packet, length, &record))
+        {
+            continue;
+        }
+
+        uint64_t fraction = u32_get(&record_header[4], swapped);
+        uint64_t time_ms = (uint64_t) u32_get(&record_header[0], swapped) * 1000 +
+                           (nanoseconds ? fraction / 1000000 : fraction / 1000);
+        if (first_ms == UINT64_MAX)
+        {
+            first_ms = time_ms;
+        }
+        record.timestamp = base_ms + (uint32_t) (time_ms - first_ms);
+
+        adv_capture_record_t * p_record = record_add(p_capture);
+        if (p_record == NULL)
+        {
+            success = false;
+            break;
+        }
+        *p_record = record;
+    }
+
+    fclose(p_file);
+    return success;
+}
+
+void adv_capture_free(adv_capture_t * p_capture)
+{
+    free(p_capture->p_records);
+    memset(p_capture, 0, sizeof(*p_capture));
+}
+
+bool adv_capture_write(const char * p_path, const adv_capture_record_t * p_records, uint32_t count)
+{
+    FILE * p_file = fopen(p_path, "wb");
+    if (p_file == NULL)
+    {
+        return false;
+    }
+
+    uint8_t header[PCAP_HEADER_SIZE] = {0};
+    u32_put(&header[0], PCAP_MAGIC_US);
+    u16_put(&header[4], 2);
+    u16_put(&header[6], 4);
+    u32_put(&header[16], PHDR_SIZE + LL_PACKET_SIZE_MAX);
+    u32_put(&header[20], LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR);
+    bool success = (fwrite(header, sizeof(header), 1, p_file) == 1);
+
+    for (uint32_t i = 0; i < count && success; i++)
+    {
+        const adv_capture_record_t * p_record = &p_records[i];
+        uint8_t packet[PCAP_RECORD_HEADER_SIZE + PHDR_SIZE + LL_PACKET_SIZE_MAX] = {0};
+        uint32_t pdu_length = ADV_CAPTURE_ADDR_LEN + p_record->length;
+        uint32_t length = PHDR_SIZE + 4 + LL_HEADER_SIZE + pdu_length + LL_CRC_SIZE;
+
+        u32_put(&packet[0], p_record->timestamp / 1000);
+        u32_put(&packet[4], (p_record->timestamp % 1000) * 1000);
+        u32_put(&packet[8], length);
+        u32_put(&packet[12], length);
+
+        /* Dewhitened packet with a valid signal power, the CRC is not filled in. */
+        uint8_t * p_phdr = &packet[PCAP_RECORD_HEADER_SIZE];
+        p_phdr[0] = ADV_CHANNEL_37;
+        p_phdr[1] = (uint8_t) p_record->rssi;
+        u16_put(&p_phdr[8], PHDR_FLAG_DEWHITENED | PHDR_FLAG_SIGNAL_VALID);
+
+        uint8_t * p_ll = &p_phdr[PHDR_SIZE];
+        u32_put(&p_ll[0], ADV_ACCESS_ADDRESS);
+        p_ll[4] = PDU_TYPE_ADV_NONCONN_IND;
+        p_ll[5] = (uint8_t) pdu_length;
+        memcpy(&p_ll[4 + LL_HEADER_SIZE], p_record->addr, ADV_CAPTURE_ADDR_LEN);
+        memcpy(&p_ll[4 + LL_HEADER_SIZE + ADV_CAPTURE_ADDR_LEN], p_record->data, p_record->length);
+
+        success = (fwrite(packet, PCAP_RECORD_HEADER_SIZE + length, 1, p_file) == 1);
+    }
+
+    return (fclose(p_file) == 0) && success;
+}
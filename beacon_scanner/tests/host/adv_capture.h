@@ -0,0 +1,112 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ADV_CAPTURE_H__
+#define ADV_CAPTURE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @defgroup ADV_CAPTURE Advertisement captures
+ *
+ * Reads and writes advertisement captures for the host tests and benchmarks.
+ *
+ * Captures are pcap files with the link type @c LINKTYPE_BLUETOOTH_LE_LL_WITH_PHDR (256), as
+ * saved by Wireshark from most BLE sniffers. Only advertising channel PDUs that carry an
+ * advertiser address and advertising data (ADV_IND, ADV_NONCONN_IND, ADV_SCAN_IND and SCAN_RSP)
+ * are loaded, other packets are skipped.
+ * @{
+ */
+
+/** Longest advertising data of a legacy advertising PDU. */
+#define ADV_CAPTURE_DATA_LEN_MAX    (31)
+
+/** Length of an advertiser address. */
+#define ADV_CAPTURE_ADDR_LEN        (6)
+
+/** One received advertisement. */
+typedef struct
+{
+    uint32_t timestamp;                        /**< Time of reception, in milliseconds from the start of the capture. */
+    uint8_t  addr[ADV_CAPTURE_ADDR_LEN];       /**< Advertiser address, little endian. */
+    int8_t   rssi;                             /**< Received signal strength in dBm, 0 if the capture has none. */
+    uint8_t  length;                           /**< Length of the advertising data. */
+    uint8_t  data[ADV_CAPTURE_DATA_LEN_MAX];   /**< Advertising data. */
+} adv_capture_record_t;
+
+/** Advertisements loaded from one or more captures. */
+typedef struct
+{
+    adv_capture_record_t * p_records; /**< Records in order of reception, owned by the capture. */
+    uint32_t count;                   /**< Number of records. */
+    uint32_t capacity;                /**< Number of allocated records. */
+} adv_capture_t;
+
+/**
+ * Appends the advertisements of a capture file.
+ *
+ * The timestamps of an appended file continue after the last record already loaded.
+ *
+ * @param[in]     p_path    Path of the pcap file.
+ * @param[in,out] p_capture Capture to append to, zero-initialized before the first call.
+ *
+ * @returns @c true on success, @c false if the file cannot be read or has another link type.
+ */
+bool adv_capture_load(const char * p_path, adv_capture_t * p_capture);
+
+/**
+ * Frees the records of a capture.
+ *
+ * @param[in,out] p_capture Capture to free, left empty.
+ */
+void adv_capture_free(adv_capture_t * p_capture);
+
+/**
+ * Writes advertisements to a capture file, as ADV_NONCONN_IND PDUs on channel 37.
+ *
+ * @param[in] p_path    Path of the pcap file, overwritten.
+ * @param[in] p_records Records in order of reception.
+ * @param[in] count     Number of records.
+ *
+ * @returns @c true on success, @c false if the file cannot be written.
+ */
+bool adv_capture_write(const char * p_path, const adv_capture_record_t * p_records, uint32_t count);
+
+/** @} end of ADV_CAPTURE */
+
+#endif /* ADV_CAPTURE_H__ */
@@ -0,0 +1,334 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Writes a synthetic barn capture: eartags advertising about once per second while they are in
+ * range, interleaved with adverts from phones, other beacons and older eartags.
+ *
+ * Usage: adv_capture_gen -o <file.pcap> [-t tags] [-s seconds] [-j junk percent] [-r seed]
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "adv_capture.h"
+#include "eartag_config.h"
+
+#if EARTAG_ADV_PREFIX_LEN != 3
+#error "The generator writes a flags AD structure in front of the eartag data."
+#endif
+
+#define TAG_INTERVAL_MS         (1000)
+#define TAG_LOSS_PERCENT        (20)
+#define TAG_STAY_MEAN_MS        (600000)
+#define TAG_AWAY_MEAN_MS        (120000)
+#define JUNK_DEVICE_COUNT       (48)
+#define RSSI_MIN                (-100)
+
+typedef enum
+{
+    JUNK_APPLE_NEARBY,
+    JUNK_IBEACON_OTHER,
+    JUNK_EARTAG_OLD,
+    JUNK_MICROSOFT_CDP,
+    JUNK_EDDYSTONE_UID,
+    JUNK_RANDOM,
+    JUNK_TYPE_COUNT
+} junk_type_t;
+
+static const uint8_t m_eartag_uuid[EARTAG_UUID_LEN] = EARTAG_UUID;
+static uint32_t m_seed = 1;
+
+static uint32_t rand_u32(void)
+{
+    uint32_t x = m_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m_seed = x;
+    return x;
+}
+
+static uint32_t rand_range(uint32_t max)
+{
+    return (max == 0) ? 0 : rand_u32() % max;
+}
+
+static double rand_unit(void)
+{
+    return (rand_u32() + 0.5) / 4294967296.0;
+}
+
+static uint32_t rand_exponential(uint32_t mean)
+{
+    return (uint32_t) (-log(rand_unit()) * mean);
+}
+
+/* Roughly normal noise, in dB. */
+static int32_t rssi_noise(void)
+{
+    return (int32_t) rand_range(5) + (int32_t) rand_range(5) + (int32_t) rand_range(5) - 6;
+}
+
+static void addr_random_static(uint8_t * p_addr)
+{
+    for (uint32_t i = 0; i < ADV_CAPTURE_ADDR_LEN; i++)
+    {
+        p_addr[i] = (uint8_t) rand_u32();
+    }
+    p_addr[ADV_CAPTURE_ADDR_LEN - 1] |= 0xC0;
+}
+
+static uint8_t ibeacon_put(uint8_t * p_data, const uint8_t * p_uuid, uint16_t major, uint16_t minor, int8_t tx_power)
+{
+    static const uint8_t header[] =
+    {
+        0x02, 0x01, 0x06,
+        0x1A, 0xFF, EARTAG_COMPANY_ID & 0xFF, EARTAG_COMPANY_ID >> 8, EARTAG_BEACON_TYPE, EARTAG_BEACON_DATA_LENGTH
+    };
+    uint8_t length = 0;
+    memcpy(&p_data[length], header, sizeof(header));
+    length += sizeof(header);
+    memcpy(&p_data[length], p_uuid, EARTAG_UUID_LEN);
+    length += EARTAG_UUID_LEN;
+    p_data[length++] = (uint8_t) (major >> 8);
+    p_data[length++] = (uint8_t) major;
+    p_data[length++] = (uint8_t) (minor >> 8);
+    p_data[length++] = (uint8_t) minor;
+    p_data[length++] = (uint8_t) tx_power;
+    return length;
+}
+
+static uint8_t junk_put(uint8_t * p_data, junk_type_t type)
+{
+    uint8_t uuid[EARTAG_UUID_LEN];
+    uint8_t length = 0;
+
+    switch (type)
+    {
+        case JUNK_APPLE_NEARBY:
+        {
+            static const uint8_t nearby[] = {0x02, 0x01, 0x1A, 0x0B, 0xFF, 0x4C, 0x00, 0x10, 0x06};
+            memcpy(p_data, nearby, sizeof(nearby));
+            length = sizeof(nearby);
+            while (length < sizeof(nearby) + 6)
+            {
+                p_data[length++] = (uint8_t) rand_u32();
+            }
+            return length;
+        }
+
+        case JUNK_IBEACON_OTHER:
+            for (uint32_t i = 0; i < EARTAG_UUID_LEN; i++)
+            {
+                uuid[i] = (uint8_t) rand_u32();
+            }
+            return ibeacon_put(p_data, uuid, (uint16_t) rand_u32(), (uint16_t) rand_u32(), -59);
+
+        case JUNK_EARTAG_OLD:
+            /* Previous eartag generation, the UUID differs in the last byte only. */
+            memcpy(uuid, m_eartag_uuid, EARTAG_UUID_LEN);
+            uuid[EARTAG_UUID_LEN - 1] ^= 0x01;
+            return ibeacon_put(p_data, uuid, (uint16_t) rand_u32(), (uint16_t) rand_u32(), -62);
+
+        case JUNK_MICROSOFT_CDP:
+        {
+            static const uint8_t cdp[] = {0x1E, 0xFF, 0x06, 0x00, 0x01, 0x09, 0x20, 0x02};
+            memcpy(p_data, cdp, sizeof(cdp));
+            length = sizeof(cdp);
+            while (length < ADV_CAPTURE_DATA_LEN_MAX)
+            {
+                p_data[length++] = (uint8_t) rand_u32();
+            }
+            return length;
+        }
+
+        case JUNK_EDDYSTONE_UID:
+        {
+            static const uint8_t uid[] = {0x02, 0x01, 0x06, 0x03, 0x03, 0xAA, 0xFE, 0x17, 0x16, 0xAA, 0xFE, 0x00, 0xEE};
+            memcpy(p_data, uid, sizeof(uid));
+            length = sizeof(uid);
+            while (length < ADV_CAPTURE_DATA_LEN_MAX)
+            {
+                p_data[length++] = (uint8_t) rand_u32();
+            }
+            return length;
+        }
+
+        default:
+            length = (uint8_t) (3 + rand_range(ADV_CAPTURE_DATA_LEN_MAX - 2));
+            for (uint32_t i = 0; i < length; i++)
+            {
+                p_data[i] = (uint8_t) rand_u32();
+            }
+            return length;
+    }
+}
+
+static int record_compare(const void * p_a, const void * p_b)
+{
+    const adv_capture_record_t * p_ra = p_a;
+    const adv_capture_record_t * p_rb = p_b;
+    return (p_ra->timestamp > p_rb->timestamp) - (p_ra->timestamp < p_rb->timestamp);
+}
+
+static void usage(const char * p_name)
+{
+    fprintf(stderr, "Usage: %s -o <file.pcap> [-t tags] [-s seconds] [-j junk percent] [-r seed]\n", p_name);
+}
+
+int main(int argc, char ** argv)
+{
+    const char * p_path = NULL;
+    uint32_t tag_count = 500;
+    uint32_t seconds = 120;
+    uint32_t junk_percent = 60;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        uint32_t value = (uint32_t) strtoul(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "-o") == 0)
+        {
+            p_path = argv[i + 1];
+        }
+        else if (strcmp(argv[i], "-t") == 0)
+        {
+            tag_count = value;
+        }
+        else if (strcmp(argv[i], "-s") == 0)
+        {
+            seconds = value;
+        }
+        else if (strcmp(argv[i], "-j") == 0)
+        {
+            junk_percent = (value < 100) ? value : 99;
+        }
+        else if (strcmp(argv[i], "-r") == 0)
+        {
+            m_seed = (value != 0) ? value : 1;
+        }
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (p_path == NULL || (argc % 2) == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t duration_ms = seconds * 1000;
+    uint32_t tag_adv_max = tag_count * (duration_ms / (TAG_INTERVAL_MS * 9 / 10) + 1);
+    uint32_t junk_count = (uint32_t) ((uint64_t) tag_adv_max * junk_percent / (100 - junk_percent));
+    adv_capture_record_t * p_records = malloc((size_t) (tag_adv_max + junk_count) * sizeof(p_records[0]));
+    if (p_records == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    /* Eartags move in and out of range, and lose some adverts to collisions. */
+    uint32_t count = 0;
+    for (uint32_t tag = 0; tag < tag_count; tag++)
+    {
+        uint8_t addr[ADV_CAPTURE_ADDR_LEN];
+        addr_random_static(addr);
+        int32_t rssi_base = -95 + (int32_t) rand_range(45);
+        int8_t tx_power = (int8_t) (-60 - (int32_t) rand_range(8));
+        bool in_range = (rand_range(10) != 0);
+        uint32_t change_ms = rand_exponential(in_range ? TAG_STAY_MEAN_MS : TAG_AWAY_MEAN_MS);
+
+        for (uint32_t t = rand_range(TAG_INTERVAL_MS); t < duration_ms;
+             t += TAG_INTERVAL_MS * 9 / 10 + rand_range(TAG_INTERVAL_MS / 5))
+        {
+            while (t >= change_ms)
+            {
+                in_range = !in_range;
+                change_ms += rand_exponential(in_range ? TAG_STAY_MEAN_MS : TAG_AWAY_MEAN_MS);
+            }
+            int32_t rssi = rssi_base + rssi_noise();
+            if (!in_range || rand_range(100) < TAG_LOSS_PERCENT || rssi < RSSI_MIN)
+            {
+                continue;
+            }
+
+            adv_capture_record_t * p_record = &p_records[count++];
+            p_record->timestamp = t;
+            memcpy(p_record->addr, addr, ADV_CAPTURE_ADDR_LEN);
+            p_record->rssi = (int8_t) rssi;
+            p_record->length = ibeacon_put(p_record->data, m_eartag_uuid, (uint16_t) (tag >> 16), (uint16_t) tag, tx_power);
+        }
+    }
+    uint32_t tag_adv_count = count;
+
+    /* The other advertisers are a fixed set of devices of random types. */
+    uint8_t junk_addrs[JUNK_DEVICE_COUNT][ADV_CAPTURE_ADDR_LEN];
+    junk_type_t junk_types[JUNK_DEVICE_COUNT];
+    for (uint32_t i = 0; i < JUNK_DEVICE_COUNT; i++)
+    {
+        addr_random_static(junk_addrs[i]);
+        junk_types[i] = (junk_type_t) rand_range(JUNK_TYPE_COUNT);
+    }
+    junk_count = (uint32_t) ((uint64_t) tag_adv_count * junk_percent / (100 - junk_percent));
+    for (uint32_t i = 0; i < junk_count; i++)
+    {
+        uint32_t device = rand_range(JUNK_DEVICE_COUNT);
+        adv_capture_record_t * p_record = &p_records[count++];
+        p_record->timestamp = rand_range(duration_ms);
+        memcpy(p_record->addr, junk_addrs[device], ADV_CAPTURE_ADDR_LEN);
+        p_record->rssi = (int8_t) (-85 + (int32_t) rand_range(40));
+        p_record->length = junk_put(p_record->data, junk_types[device]);
+    }
+
+    qsort(p_records, count, sizeof(p_records[0]), record_compare);
+    bool success = adv_capture_write(p_path, p_records, count);
+    free(p_records);
+    if (!success)
+    {
+        fprintf(stderr, "Cannot write %s\n", p_path);
+        return EXIT_FAILURE;
+    }
+
+    printf("Wrote %u adverts (%u eartag, %u other) from %u eartags over %u s to %s\n",
+           count, tag_adv_count, count - tag_adv_count, tag_count, seconds, p_path);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,229 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Measures the report codec on the batches a scanner would send for a capture.
+ *
+ * Usage: codec_bench [-i interval_ms] [-b batch_size] <capture.pcap>...
+ *
+ * The capture goes through the parser and the sighting table, which is drained into batches of
+ * up to the batch size every report interval, sorted by address as the scanner does. Reports the
+ * encoded bytes per eartag, against the 16 bytes of a single-sighting Report message, and the
+ * encode and decode time per eartag.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "adv_capture.h"
+#include "eartag_adv.h"
+#include "sighting_table.h"
+#include "simple_beacon_codec.h"
+
+/* SIMPLE_BEACON_REPORT_BATCH_DATA_MAX with the 380 byte access messages of the mesh stack. */
+#define BATCH_DATA_MAX          (380 - 3 - 7)
+/* Size of the single-sighting Report message the batches replace. */
+#define REPORT_MESSAGE_SIZE     (16)
+#define BATCH_ENTRIES_MAX       (64)
+#define TIMING_REPEATS          (200)
+
+static sighting_table_t m_table;
+static uint32_t m_batch_size = BATCH_ENTRIES_MAX;
+
+static uint64_t m_entry_count;
+static uint64_t m_encoded_bytes;
+static uint64_t m_encode_ns;
+static uint64_t m_decode_ns;
+static uint32_t m_batch_count;
+static uint32_t m_mismatch_count;
+
+static int entry_addr_compare(const void * p_a, const void * p_b)
+{
+    const uint8_t * p_addr_a = ((const sighting_entry_t *) p_a)->addr;
+    const uint8_t * p_addr_b = ((const sighting_entry_t *) p_b)->addr;
+    for (uint32_t i = EARTAG_ADDR_LEN; i > 0; i--)
+    {
+        if (p_addr_a[i - 1] != p_addr_b[i - 1])
+        {
+            return (p_addr_a[i - 1] < p_addr_b[i - 1]) ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+/* As report_entry_fill() in main.c. */
+static void report_entry_fill(simple_beacon_report_entry_t * p_report, const sighting_entry_t * p_entry, uint32_t now)
+{
+    uint32_t age = (now - p_entry->last_timestamp) / 100;
+    memcpy(p_report->addr, p_entry->addr, EARTAG_ADDR_LEN);
+    p_report->count = p_entry->count;
+    p_report->rssi_avg = (int8_t) (p_entry->rssi_sum / (int32_t) p_entry->count);
+    p_report->rssi_max = p_entry->rssi_max;
+    p_report->age = (age > UINT16_MAX) ? UINT16_MAX : (uint16_t) age;
+}
+
+/* Sends the whole table, in as many batches as needed. */
+static void table_flush(uint32_t now)
+{
+    while (sighting_table_count(&m_table) > 0)
+    {
+        sighting_entry_t entries[BATCH_ENTRIES_MAX];
+        simple_beacon_report_entry_t reports[BATCH_ENTRIES_MAX];
+        simple_beacon_report_entry_t decoded[BATCH_ENTRIES_MAX];
+        uint8_t buffer[BATCH_DATA_MAX];
+
+        uint32_t count = sighting_table_drain(&m_table, entries, m_batch_size);
+        qsort(entries, count, sizeof(entries[0]), entry_addr_compare);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            report_entry_fill(&reports[i], &entries[i], now);
+        }
+
+        uint32_t length = 0;
+        uint32_t encoded = 0;
+        uint64_t start = test_time_ns();
+        for (uint32_t t = 0; t < TIMING_REPEATS; t++)
+        {
+            encoded = simple_beacon_codec_encode(reports, count, buffer, sizeof(buffer), &length);
+        }
+        m_encode_ns += test_time_ns() - start;
+
+        bool decoded_ok = false;
+        start = test_time_ns();
+        for (uint32_t t = 0; t < TIMING_REPEATS; t++)
+        {
+            decoded_ok = simple_beacon_codec_decode(buffer, length, decoded, encoded);
+        }
+        m_decode_ns += test_time_ns() - start;
+
+        for (uint32_t i = 0; i < encoded && decoded_ok; i++)
+        {
+            decoded_ok = (memcmp(decoded[i].addr, reports[i].addr, EARTAG_ADDR_LEN) == 0 &&
+                          decoded[i].count == reports[i].count && decoded[i].age == reports[i].age);
+        }
+        if (!decoded_ok)
+        {
+            m_mismatch_count++;
+        }
+
+        /* Entries that did not fit go in the next batch, as in the scanner. */
+        for (uint32_t i = encoded; i < count; i++)
+        {
+            (void) sighting_table_merge(&m_table, &entries[i], NULL);
+        }
+        m_entry_count += encoded;
+        m_encoded_bytes += length;
+        m_batch_count++;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    adv_capture_t capture;
+    memset(&capture, 0, sizeof(capture));
+    uint32_t interval_ms = 1000;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc)
+        {
+            interval_ms = (uint32_t) strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc)
+        {
+            m_batch_size = (uint32_t) strtoul(argv[++i], NULL, 0);
+        }
+        else if (!adv_capture_load(argv[i], &capture))
+        {
+            fprintf(stderr, "Cannot load %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (capture.count == 0 || interval_ms == 0 || m_batch_size == 0 || m_batch_size > BATCH_ENTRIES_MAX)
+    {
+        fprintf(stderr, "Usage: %s [-i interval_ms] [-b batch_size 1..%u] <capture.pcap>...\n", argv[0], BATCH_ENTRIES_MAX);
+        return EXIT_FAILURE;
+    }
+
+    sighting_table_init(&m_table);
+    uint32_t next_flush = capture.p_records[0].timestamp + interval_ms;
+    for (uint32_t r = 0; r < capture.count; r++)
+    {
+        const adv_capture_record_t * p_record = &capture.p_records[r];
+        if ((int32_t) (p_record->timestamp - next_flush) >= 0)
+        {
+            table_flush(next_flush);
+            while ((int32_t) (p_record->timestamp - next_flush) >= 0)
+            {
+                next_flush += interval_ms;
+            }
+        }
+
+        eartag_sighting_t sighting;
+        if (eartag_adv_parse(p_record->data, p_record->length, &sighting))
+        {
+            memcpy(sighting.addr, p_record->addr, EARTAG_ADDR_LEN);
+            sighting.rssi = p_record->rssi;
+            sighting.timestamp = p_record->timestamp;
+            (void) sighting_table_insert(&m_table, &sighting, NULL);
+        }
+    }
+    table_flush(next_flush);
+
+    if (m_entry_count == 0)
+    {
+        fprintf(stderr, "No eartag sightings in the capture\n");
+        return EXIT_FAILURE;
+    }
+    double bytes_per_tag = (double) m_encoded_bytes / m_entry_count;
+    printf("%u batches of up to %u entries every %u ms, %.1f entries per batch\n",
+           m_batch_count, m_batch_size, interval_ms, (double) m_entry_count / m_batch_count);
+    printf("Encoded: %.2f bytes/tag (%.1fx smaller than %u byte Report messages)\n",
+           bytes_per_tag, REPORT_MESSAGE_SIZE / bytes_per_tag, REPORT_MESSAGE_SIZE);
+    printf("Encode:  %.1f ns/tag\n", (double) m_encode_ns / TIMING_REPEATS / m_entry_count);
+    printf("Decode:  %.1f ns/tag\n", (double) m_decode_ns / TIMING_REPEATS / m_entry_count);
+    if (m_mismatch_count > 0)
+    {
+        printf("%u batches did not round trip\n", m_mismatch_count);
+    }
+
+    adv_capture_free(&capture);
+    return (m_mismatch_count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,241 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Round trip and robustness fuzz tests of the Simple Beacon report codec. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "simple_beacon_codec.h"
+
+#define ENTRIES_MAX     (128)
+#define BUFFER_SIZE_MAX (ENTRIES_MAX * SIMPLE_BEACON_CODEC_ENTRY_SIZE_MAX)
+#define FUZZ_ROUNDS     (20000)
+
+static uint32_t m_seed = 0x5EED;
+
+static uint32_t rand_u32(void)
+{
+    uint32_t x = m_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m_seed = x;
+    return x;
+}
+
+static uint32_t rand_range(uint32_t max)
+{
+    return (max == 0) ? 0 : rand_u32() % max;
+}
+
+/* RSSI as the decoder returns it, the middle of its bucket. */
+static int8_t rssi_quantized(int8_t rssi)
+{
+    int32_t bucket = ((int32_t) rssi - SIMPLE_BEACON_CODEC_RSSI_FLOOR) / SIMPLE_BEACON_CODEC_RSSI_STEP;
+    bucket = (bucket < 0) ? 0 : ((bucket > 15) ? 15 : bucket);
+    return (int8_t) (SIMPLE_BEACON_CODEC_RSSI_FLOOR + bucket * SIMPLE_BEACON_CODEC_RSSI_STEP +
+                     SIMPLE_BEACON_CODEC_RSSI_STEP / 2);
+}
+
+static void entry_random(simple_beacon_report_entry_t * p_entry, uint64_t addr)
+{
+    for (uint32_t i = 0; i < SIMPLE_BEACON_CODEC_ADDR_LEN; i++)
+    {
+        p_entry->addr[i] = (uint8_t) (addr >> (8 * i));
+    }
+    /* Mostly small values, as in real batches, with the extremes now and then. */
+    switch (rand_range(4))
+    {
+        case 0:
+            p_entry->count = (uint16_t) (1 + rand_range(UINT16_MAX));
+            p_entry->age = (uint16_t) rand_u32();
+            break;
+        default:
+            p_entry->count = (uint16_t) (1 + rand_range(20));
+            p_entry->age = (uint16_t) rand_range(100);
+            break;
+    }
+    p_entry->rssi_avg = (int8_t) rand_u32();
+    p_entry->rssi_max = (int8_t) rand_u32();
+}
+
+static uint64_t addr_random(void)
+{
+    return ((uint64_t) rand_u32() << 16 ^ rand_u32()) & 0xFFFFFFFFFFFFull;
+}
+
+static bool entry_matches(const simple_beacon_report_entry_t * p_decoded, const simple_beacon_report_entry_t * p_entry)
+{
+    return memcmp(p_decoded->addr, p_entry->addr, SIMPLE_BEACON_CODEC_ADDR_LEN) == 0 &&
+           p_decoded->count == p_entry->count &&
+           p_decoded->age == p_entry->age &&
+           p_decoded->rssi_avg == rssi_quantized(p_entry->rssi_avg) &&
+           p_decoded->rssi_max == rssi_quantized(p_entry->rssi_max);
+}
+
+static void test_extremes(void)
+{
+    simple_beacon_report_entry_t entries[3];
+    simple_beacon_report_entry_t decoded[3];
+    uint8_t buffer[3 * SIMPLE_BEACON_CODEC_ENTRY_SIZE_MAX];
+    uint32_t length;
+
+    /* Largest jumps up and down the address space, with the largest count and age. */
+    memset(entries, 0, sizeof(entries));
+    memset(entries[0].addr, 0xFF, SIMPLE_BEACON_CODEC_ADDR_LEN);
+    entries[0].count = UINT16_MAX;
+    entries[0].age = UINT16_MAX;
+    entries[0].rssi_avg = INT8_MIN;
+    entries[0].rssi_max = INT8_MAX;
+    entries[1] = entries[0];
+    memset(entries[1].addr, 0x00, SIMPLE_BEACON_CODEC_ADDR_LEN);
+    entries[2] = entries[0];
+
+    TEST_CHECK(simple_beacon_codec_encode(entries, 3, buffer, sizeof(buffer), &length) == 3);
+    TEST_CHECK(length == 3 * SIMPLE_BEACON_CODEC_ENTRY_SIZE_MAX);
+    TEST_CHECK(simple_beacon_codec_decode(buffer, length, decoded, 3));
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        TEST_CHECK(entry_matches(&decoded[i], &entries[i]));
+    }
+
+    /* Repeated address, single sighting, no age. */
+    memset(entries, 0, sizeof(entries));
+    entries[0].count = 1;
+    TEST_CHECK(simple_beacon_codec_encode(entries, 1, buffer, sizeof(buffer), &length) == 1);
+    TEST_CHECK(length == SIMPLE_BEACON_CODEC_ENTRY_SIZE_MIN);
+}
+
+static void test_round_trip(void)
+{
+    static simple_beacon_report_entry_t entries[ENTRIES_MAX];
+    static simple_beacon_report_entry_t decoded[ENTRIES_MAX];
+    static uint8_t buffer[BUFFER_SIZE_MAX];
+
+    for (uint32_t round = 0; round < FUZZ_ROUNDS; round++)
+    {
+        uint32_t count = 1 + rand_range(ENTRIES_MAX);
+        bool sorted = (rand_range(2) == 0);
+        uint64_t addr = addr_random();
+        for (uint32_t i = 0; i < count; i++)
+        {
+            /* Sorted batches of nearby addresses, or random addresses in any order. */
+            addr = sorted ? ((addr + 1 + rand_range(1000)) & 0xFFFFFFFFFFFFull) : addr_random();
+            entry_random(&entries[i], addr);
+        }
+
+        uint32_t size = rand_range(BUFFER_SIZE_MAX + 1);
+        uint32_t length = UINT32_MAX;
+        uint32_t encoded = simple_beacon_codec_encode(entries, count, buffer, size, &length);
+        TEST_CHECK(encoded <= count);
+        TEST_CHECK(length <= size);
+        /* Stops only at an entry that does not fit. */
+        TEST_CHECK(encoded == count || length + SIMPLE_BEACON_CODEC_ENTRY_SIZE_MAX > size);
+        TEST_CHECK(length >= encoded * SIMPLE_BEACON_CODEC_ENTRY_SIZE_MIN);
+        TEST_CHECK(length <= encoded * SIMPLE_BEACON_CODEC_ENTRY_SIZE_MAX);
+
+        TEST_CHECK(simple_beacon_codec_decode(buffer, length, decoded, encoded));
+        for (uint32_t i = 0; i < encoded; i++)
+        {
+            TEST_CHECK(entry_matches(&decoded[i], &entries[i]));
+        }
+
+        /* Truncated data or a wrong entry count never decodes. */
+        if (encoded > 0)
+        {
+            TEST_CHECK(!simple_beacon_codec_decode(buffer, length - 1 - rand_range(length), decoded, encoded));
+            TEST_CHECK(!simple_beacon_codec_decode(buffer, length, decoded, encoded - 1));
+            TEST_CHECK(!simple_beacon_codec_decode(buffer, length, decoded, encoded + 1));
+        }
+    }
+}
+
+static void test_garbage(void)
+{
+    /* Random and corrupted input must be rejected or decoded within bounds, never read past the
+     * end of the data. The sanitizers catch out of bounds reads. */
+    static simple_beacon_report_entry_t entries[ENTRIES_MAX];
+    static simple_beacon_report_entry_t decoded[ENTRIES_MAX];
+    static uint8_t buffer[BUFFER_SIZE_MAX];
+
+    for (uint32_t round = 0; round < FUZZ_ROUNDS; round++)
+    {
+        uint32_t count = 1 + rand_range(ENTRIES_MAX);
+        uint32_t length;
+        if (rand_range(2) == 0)
+        {
+            length = rand_range(BUFFER_SIZE_MAX);
+            for (uint32_t i = 0; i < length; i++)
+            {
+                buffer[i] = (uint8_t) rand_u32();
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                entry_random(&entries[i], addr_random());
+            }
+            count = simple_beacon_codec_encode(entries, count, buffer, sizeof(buffer), &length);
+            buffer[rand_range(length)] ^= (uint8_t) (1u << rand_range(8));
+        }
+
+        /* Decode from an exactly sized heap copy, so any overread is caught. */
+        uint8_t * p_data = malloc(length ? length : 1);
+        TEST_CHECK(p_data != NULL);
+        memcpy(p_data, buffer, length);
+        if (simple_beacon_codec_decode(p_data, length, decoded, count))
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                TEST_CHECK(decoded[i].count >= 1);
+            }
+        }
+        free(p_data);
+    }
+}
+
+int main(void)
+{
+    test_extremes();
+    test_round_trip();
+    test_garbage();
+    return test_exit();
+}
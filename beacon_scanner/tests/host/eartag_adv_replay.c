@@ -0,0 +1,114 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Replays advertisement captures through the eartag parser, and measures its throughput.
+ *
+ * Usage: eartag_adv_replay [-p passes] <capture.pcap>...
+ *
+ * Every advert goes through the same steps as in the scanner callback: parse, then fill in the
+ * address, RSSI and timestamp of the sighting.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "adv_capture.h"
+#include "eartag_adv.h"
+
+int main(int argc, char ** argv)
+{
+    adv_capture_t capture;
+    memset(&capture, 0, sizeof(capture));
+    uint32_t passes = 20;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+        {
+            passes = (uint32_t) strtoul(argv[++i], NULL, 0);
+        }
+        else if (!adv_capture_load(argv[i], &capture))
+        {
+            fprintf(stderr, "Cannot load %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (capture.count == 0 || passes == 0)
+    {
+        fprintf(stderr, "Usage: %s [-p passes] <capture.pcap>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    uint32_t sighting_count = 0;
+    uint32_t checksum = 0;
+    uint64_t start = test_time_ns();
+    for (uint32_t pass = 0; pass < passes; pass++)
+    {
+        for (uint32_t i = 0; i < capture.count; i++)
+        {
+            const adv_capture_record_t * p_record = &capture.p_records[i];
+            eartag_sighting_t sighting;
+            if (eartag_adv_parse(p_record->data, p_record->length, &sighting))
+            {
+                memcpy(sighting.addr, p_record->addr, EARTAG_ADDR_LEN);
+                sighting.rssi = p_record->rssi;
+                sighting.timestamp = p_record->timestamp;
+                sighting_count++;
+                checksum += sighting.minor + (uint32_t) sighting.addr[0];
+            }
+        }
+    }
+    uint64_t elapsed_ns = test_time_ns() - start;
+
+    uint64_t advert_count = (uint64_t) capture.count * passes;
+    uint32_t duration_ms = capture.p_records[capture.count - 1].timestamp - capture.p_records[0].timestamp;
+    double capture_rate = (duration_ms > 0) ? capture.count * 1000.0 / duration_ms : 0.0;
+    double host_rate = advert_count * 1e9 / (double) (elapsed_ns ? elapsed_ns : 1);
+
+    printf("Capture: %u adverts over %.1f s, %.0f adverts/s, %u eartag sightings (%.1f %%)\n",
+           capture.count, duration_ms / 1000.0, capture_rate, sighting_count / passes,
+           100.0 * (sighting_count / passes) / capture.count);
+    printf("Parser:  %.1f ns/advert, %.0f adverts/s over %u passes (checksum %08x)\n",
+           (double) elapsed_ns / advert_count, host_rate, passes, checksum);
+
+    adv_capture_free(&capture);
+    return (sighting_count > 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,144 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Unit tests of the eartag advertisement parser. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "eartag_adv.h"
+
+static const uint8_t m_eartag_uuid[EARTAG_UUID_LEN] = EARTAG_UUID;
+
+/* Flags, then the manufacturer specific data of an eartag. */
+static uint8_t packet_build(uint8_t * p_data)
+{
+    uint8_t length = 0;
+    p_data[length++] = 0x02;
+    p_data[length++] = 0x01;
+    p_data[length++] = 0x06;
+    p_data[length++] = EARTAG_ADV_AD_LENGTH;
+    p_data[length++] = 0xFF;
+    p_data[length++] = EARTAG_COMPANY_ID & 0xFF;
+    p_data[length++] = EARTAG_COMPANY_ID >> 8;
+    p_data[length++] = EARTAG_BEACON_TYPE;
+    p_data[length++] = EARTAG_BEACON_DATA_LENGTH;
+    memcpy(&p_data[length], m_eartag_uuid, EARTAG_UUID_LEN);
+    length += EARTAG_UUID_LEN;
+    p_data[length++] = 0x12;
+    p_data[length++] = 0x34;
+    p_data[length++] = 0xAB;
+    p_data[length++] = 0xCD;
+    p_data[length++] = 0xC5;
+    return length;
+}
+
+static void test_valid(void)
+{
+    uint8_t data[32];
+    uint8_t length = packet_build(data);
+    eartag_sighting_t sighting;
+    memset(&sighting, 0, sizeof(sighting));
+
+    TEST_CHECK(length == EARTAG_ADV_PACKET_LENGTH);
+    TEST_CHECK(eartag_adv_prefilter(data, length));
+    TEST_CHECK(eartag_adv_parse(data, length, &sighting));
+    TEST_CHECK(sighting.major == 0x1234);
+    TEST_CHECK(sighting.minor == 0xABCD);
+    TEST_CHECK(sighting.tx_power == -59);
+}
+
+static void test_length(void)
+{
+    uint8_t data[32];
+    uint8_t length = packet_build(data);
+    eartag_sighting_t sighting;
+
+    TEST_CHECK(!eartag_adv_parse(data, length - 1, &sighting));
+    TEST_CHECK(!eartag_adv_parse(data, length + 1, &sighting));
+    TEST_CHECK(!eartag_adv_parse(data, 0, &sighting));
+}
+
+static void test_header_fields(void)
+{
+    /* Every byte of the AD header and the UUID is checked, by the prefilter or the parser. */
+    for (uint32_t i = EARTAG_ADV_PREFIX_LEN; i < EARTAG_ADV_PREFIX_LEN + 6 + EARTAG_UUID_LEN; i++)
+    {
+        uint8_t data[32];
+        uint8_t length = packet_build(data);
+        eartag_sighting_t sighting;
+
+        data[i] ^= 0x01;
+        TEST_CHECK(!eartag_adv_parse(data, length, &sighting));
+    }
+}
+
+static void test_uuid_tail(void)
+{
+    /* The prefilter only covers the start of the UUID, the parser checks the rest. */
+    uint8_t data[32];
+    uint8_t length = packet_build(data);
+    eartag_sighting_t sighting;
+
+    data[EARTAG_ADV_PACKET_LENGTH - 6] ^= 0x80;
+    TEST_CHECK(eartag_adv_prefilter(data, length));
+    TEST_CHECK(!eartag_adv_parse(data, length, &sighting));
+}
+
+static void test_identifiers_ignored(void)
+{
+    /* Major, minor and TX power take any value. */
+    uint8_t data[32];
+    uint8_t length = packet_build(data);
+    eartag_sighting_t sighting;
+
+    memset(&data[EARTAG_ADV_PACKET_LENGTH - 5], 0xFF, 5);
+    TEST_CHECK(eartag_adv_parse(data, length, &sighting));
+    TEST_CHECK(sighting.major == 0xFFFF && sighting.minor == 0xFFFF && sighting.tx_power == -1);
+}
+
+int main(void)
+{
+    test_valid();
+    test_length();
+    test_header_fields();
+    test_uuid_tail();
+    test_identifiers_ignored();
+    return test_exit();
+}
@@ -0,0 +1,194 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Measures the advertisement prefilter on a mixed capture.
+ *
+ * Usage: prefilter_bench [-p passes] <capture.pcap>...
+ *
+ * Times the prefilter alone, the full parser (prefilter and UUID check), and a reference parser
+ * that walks the AD structures and compares the fields one by one, as the parser did before
+ * the prefilter. Also checks that the parser accepts every eartag advert the reference accepts.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "adv_capture.h"
+#include "eartag_adv.h"
+
+#define AD_TYPE_MANUFACTURER_SPECIFIC_DATA  (0xFF)
+#define OFFSET_UUID             (6)
+#define OFFSET_MINOR            (OFFSET_UUID + EARTAG_UUID_LEN + 2)
+
+static const uint8_t m_eartag_uuid[EARTAG_UUID_LEN] = EARTAG_UUID;
+
+/* Reference: any AD structure of the packet may be the eartag data. */
+static bool reference_parse(const uint8_t * p_data, uint8_t length, eartag_sighting_t * p_sighting)
+{
+    uint32_t i = 0;
+    while (i + 1 < length)
+    {
+        const uint8_t * p_ad = &p_data[i];
+        uint8_t ad_length = p_ad[0];
+        if (ad_length == 0 || i + 1 + ad_length > length)
+        {
+            return false;
+        }
+        if (ad_length == EARTAG_ADV_AD_LENGTH &&
+            p_ad[1] == AD_TYPE_MANUFACTURER_SPECIFIC_DATA &&
+            p_ad[2] == (uint8_t) (EARTAG_COMPANY_ID & 0xFF) &&
+            p_ad[3] == (uint8_t) (EARTAG_COMPANY_ID >> 8) &&
+            p_ad[4] == EARTAG_BEACON_TYPE &&
+            p_ad[5] == EARTAG_BEACON_DATA_LENGTH &&
+            memcmp(&p_ad[OFFSET_UUID], m_eartag_uuid, EARTAG_UUID_LEN) == 0)
+        {
+            p_sighting->minor = (uint16_t) ((p_ad[OFFSET_MINOR] << 8) | p_ad[OFFSET_MINOR + 1]);
+            return true;
+        }
+        i += ad_length + 1;
+    }
+    return false;
+}
+
+typedef uint32_t (*pass_fn_t)(const adv_capture_t * p_capture);
+
+static uint32_t prefilter_pass(const adv_capture_t * p_capture)
+{
+    uint32_t accepted = 0;
+    for (uint32_t i = 0; i < p_capture->count; i++)
+    {
+        accepted += eartag_adv_prefilter(p_capture->p_records[i].data, p_capture->p_records[i].length) ? 1 : 0;
+    }
+    return accepted;
+}
+
+static uint32_t parse_pass(const adv_capture_t * p_capture)
+{
+    uint32_t accepted = 0;
+    eartag_sighting_t sighting;
+    for (uint32_t i = 0; i < p_capture->count; i++)
+    {
+        accepted += eartag_adv_parse(p_capture->p_records[i].data, p_capture->p_records[i].length, &sighting) ? 1 : 0;
+    }
+    return accepted;
+}
+
+static uint32_t reference_pass(const adv_capture_t * p_capture)
+{
+    uint32_t accepted = 0;
+    eartag_sighting_t sighting;
+    for (uint32_t i = 0; i < p_capture->count; i++)
+    {
+        accepted += reference_parse(p_capture->p_records[i].data, p_capture->p_records[i].length, &sighting) ? 1 : 0;
+    }
+    return accepted;
+}
+
+static double pass_time_ns(pass_fn_t pass, const adv_capture_t * p_capture, uint32_t passes, uint32_t * p_accepted)
+{
+    uint64_t start = test_time_ns();
+    for (uint32_t p = 0; p < passes; p++)
+    {
+        *p_accepted = pass(p_capture);
+    }
+    return (double) (test_time_ns() - start) / ((uint64_t) passes * p_capture->count);
+}
+
+int main(int argc, char ** argv)
+{
+    adv_capture_t capture;
+    memset(&capture, 0, sizeof(capture));
+    uint32_t passes = 20;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+        {
+            passes = (uint32_t) strtoul(argv[++i], NULL, 0);
+        }
+        else if (!adv_capture_load(argv[i], &capture))
+        {
+            fprintf(stderr, "Cannot load %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (capture.count == 0 || passes == 0)
+    {
+        fprintf(stderr, "Usage: %s [-p passes] <capture.pcap>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    /* Every eartag advert the reference finds must get through the prefilter and the parser. */
+    uint32_t missed_count = 0;
+    for (uint32_t i = 0; i < capture.count; i++)
+    {
+        eartag_sighting_t reference;
+        eartag_sighting_t sighting;
+        const adv_capture_record_t * p_record = &capture.p_records[i];
+        bool expected = reference_parse(p_record->data, p_record->length, &reference);
+        bool accepted = eartag_adv_parse(p_record->data, p_record->length, &sighting);
+        if (expected && (!accepted || sighting.minor != reference.minor))
+        {
+            missed_count++;
+        }
+    }
+
+    uint32_t prefilter_accepted;
+    uint32_t parse_accepted;
+    uint32_t reference_accepted;
+    double prefilter_ns = pass_time_ns(prefilter_pass, &capture, passes, &prefilter_accepted);
+    double parse_ns = pass_time_ns(parse_pass, &capture, passes, &parse_accepted);
+    double reference_ns = pass_time_ns(reference_pass, &capture, passes, &reference_accepted);
+
+    printf("%u adverts, %.1f %% rejected by the prefilter, %.1f %% eartags\n", capture.count,
+           100.0 * (capture.count - prefilter_accepted) / capture.count, 100.0 * parse_accepted / capture.count);
+    printf("Prefilter:        %6.2f ns/advert\n", prefilter_ns);
+    printf("Parser:           %6.2f ns/advert\n", parse_ns);
+    printf("Reference parser: %6.2f ns/advert (%.1fx the parser)\n", reference_ns, reference_ns / parse_ns);
+    if (missed_count > 0 || parse_accepted != reference_accepted)
+    {
+        printf("The parser accepts %u adverts and misses %u of the %u the reference accepts\n",
+               parse_accepted, missed_count, reference_accepted);
+    }
+
+    adv_capture_free(&capture);
+    return (missed_count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,217 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Replays advertisement captures through the presence tracker.
+ *
+ * Usage: presence_replay [-e enter_ms] [-l leave_ms] <capture.pcap>...
+ *
+ * Every eartag sighting of the capture is fed to the tracker, which is ticked every 100 ms as in
+ * the scanner. Prints the number of presence events against the number of sightings they replace,
+ * and checks the event stream: a receiver that applies the events must see the same present set,
+ * count and fingerprint as the tracker, and every eartag must have left once the capture is over.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "adv_capture.h"
+#include "app_config.h"
+#include "eartag_adv.h"
+#include "presence.h"
+
+#define TICK_MS         (100)
+#define RECEIVER_MAX    (4096)
+
+/* Present set as seen by a receiver of the events. */
+static uint8_t m_present[RECEIVER_MAX][EARTAG_ADDR_LEN];
+static uint32_t m_present_count;
+static uint32_t m_fingerprint;
+
+static uint32_t m_enter_count;
+static uint32_t m_leave_count;
+static uint32_t m_error_count;
+
+static int32_t present_find(const uint8_t * p_addr)
+{
+    for (uint32_t i = 0; i < m_present_count; i++)
+    {
+        if (memcmp(m_present[i], p_addr, EARTAG_ADDR_LEN) == 0)
+        {
+            return (int32_t) i;
+        }
+    }
+    return -1;
+}
+
+static void event_cb(const presence_event_t * p_event)
+{
+    int32_t index = present_find(p_event->addr);
+    if (p_event->type == PRESENCE_EVENT_ENTER)
+    {
+        m_enter_count++;
+        if (index >= 0 || m_present_count == RECEIVER_MAX)
+        {
+            m_error_count++;
+            return;
+        }
+        memcpy(m_present[m_present_count++], p_event->addr, EARTAG_ADDR_LEN);
+    }
+    else
+    {
+        m_leave_count++;
+        if (index < 0)
+        {
+            m_error_count++;
+            return;
+        }
+        memcpy(m_present[index], m_present[--m_present_count], EARTAG_ADDR_LEN);
+    }
+    m_fingerprint ^= presence_addr_fingerprint(p_event->addr);
+}
+
+static void tick(presence_tracker_t * p_tracker, uint32_t now)
+{
+    presence_tick(p_tracker, now);
+    if (p_tracker->present_count != m_present_count || p_tracker->fingerprint != m_fingerprint)
+    {
+        m_error_count++;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    adv_capture_t capture;
+    memset(&capture, 0, sizeof(capture));
+    presence_config_t config =
+    {
+        .enter_rssi = APP_CONFIG_PRESENCE_ENTER_RSSI,
+        .leave_rssi = APP_CONFIG_PRESENCE_LEAVE_RSSI,
+        .enter_ms   = APP_CONFIG_PRESENCE_ENTER_MS,
+        .leave_ms   = APP_CONFIG_PRESENCE_LEAVE_MS,
+        .event_cb   = event_cb
+    };
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-e") == 0 && i + 1 < argc)
+        {
+            config.enter_ms = (uint32_t) strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc)
+        {
+            config.leave_ms = (uint32_t) strtoul(argv[++i], NULL, 0);
+        }
+        else if (!adv_capture_load(argv[i], &capture))
+        {
+            fprintf(stderr, "Cannot load %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (capture.count == 0)
+    {
+        fprintf(stderr, "Usage: %s [-e enter_ms] [-l leave_ms] <capture.pcap>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static presence_tracker_t tracker;
+    presence_init(&tracker, &config);
+
+    uint32_t sighting_count = 0;
+    uint32_t now = capture.p_records[0].timestamp;
+    uint64_t start = test_time_ns();
+    for (uint32_t i = 0; i < capture.count; i++)
+    {
+        const adv_capture_record_t * p_record = &capture.p_records[i];
+        while ((int32_t) (p_record->timestamp - now) >= TICK_MS)
+        {
+            now += TICK_MS;
+            tick(&tracker, now);
+        }
+
+        eartag_sighting_t sighting;
+        if (eartag_adv_parse(p_record->data, p_record->length, &sighting))
+        {
+            memcpy(sighting.addr, p_record->addr, EARTAG_ADDR_LEN);
+            sighting.rssi = p_record->rssi;
+            sighting.timestamp = p_record->timestamp;
+            presence_sighting_add(&tracker, &sighting);
+            sighting_count++;
+        }
+    }
+    uint32_t present_at_end = tracker.present_count;
+    uint64_t elapsed_ns = test_time_ns() - start;
+
+    /* Every eartag goes silent after the capture, and must have left within two leave times. */
+    uint32_t end = now + 2 * config.leave_ms + TICK_MS;
+    while ((int32_t) (end - now) > 0)
+    {
+        now += TICK_MS;
+        tick(&tracker, now);
+    }
+
+    uint32_t event_count = m_enter_count + m_leave_count;
+    printf("%u sightings, %u enter and %u leave events, %.1f sightings per event\n",
+           sighting_count, m_enter_count, m_leave_count,
+           (event_count > 0) ? (double) sighting_count / event_count : 0.0);
+    printf("%u eartags present at the end of the capture, %u sightings dropped for lack of room\n",
+           present_at_end, tracker.drop_count);
+    printf("Tracker: %.1f ns per sighting, ticks included\n", (double) elapsed_ns / sighting_count);
+
+    bool passed = true;
+    if (m_error_count > 0)
+    {
+        printf("%u events or ticks out of sync with the tracker\n", m_error_count);
+        passed = false;
+    }
+    if (tracker.present_count != 0 || m_enter_count != m_leave_count)
+    {
+        printf("%u eartags still present after the capture\n", tracker.present_count);
+        passed = false;
+    }
+    if (event_count == 0)
+    {
+        printf("No presence events\n");
+        passed = false;
+    }
+
+    adv_capture_free(&capture);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
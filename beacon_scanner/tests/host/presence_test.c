@@ -0,0 +1,324 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Unit tests of the presence tracker, on hand made traces. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "presence.h"
+
+#define ENTER_RSSI      (-85)
+#define LEAVE_RSSI      (-92)
+#define ENTER_MS        (3000)
+#define LEAVE_MS        (15000)
+#define TICK_MS         (100)
+#define SILENT          (INT8_MIN)
+
+#define EVENTS_MAX      (64)
+
+/* RSSI of an eartag at a time, or SILENT when it is not heard. */
+typedef int8_t (*trace_fn_t)(uint32_t t);
+
+static presence_event_t m_events[EVENTS_MAX];
+static uint32_t m_event_count;
+
+static void event_cb(const presence_event_t * p_event)
+{
+    if (m_event_count < EVENTS_MAX)
+    {
+        m_events[m_event_count] = *p_event;
+    }
+    m_event_count++;
+}
+
+static void tracker_init(presence_tracker_t * p_tracker)
+{
+    presence_config_t config =
+    {
+        .enter_rssi = ENTER_RSSI,
+        .leave_rssi = LEAVE_RSSI,
+        .enter_ms   = ENTER_MS,
+        .leave_ms   = LEAVE_MS,
+        .event_cb   = event_cb
+    };
+    presence_init(p_tracker, &config);
+    m_event_count = 0;
+}
+
+static void addr_set(uint8_t * p_addr, uint32_t id)
+{
+    memset(p_addr, 0, EARTAG_ADDR_LEN);
+    p_addr[0] = (uint8_t) id;
+    p_addr[1] = (uint8_t) (id >> 8);
+    p_addr[5] = 0xC0;
+}
+
+static void sighting_add(presence_tracker_t * p_tracker, uint32_t id, int8_t rssi, uint32_t t)
+{
+    eartag_sighting_t sighting;
+    memset(&sighting, 0, sizeof(sighting));
+    addr_set(sighting.addr, id);
+    sighting.rssi = rssi;
+    sighting.timestamp = t;
+    presence_sighting_add(p_tracker, &sighting);
+}
+
+/* Plays the trace of one eartag from start to end, heard once a second, ticking every TICK_MS. */
+static void trace_run(presence_tracker_t * p_tracker, uint32_t id, trace_fn_t trace, uint32_t start, uint32_t end)
+{
+    for (uint32_t t = start; t < end; t += TICK_MS)
+    {
+        if (t % 1000 == 0)
+        {
+            int8_t rssi = trace(t);
+            if (rssi != SILENT)
+            {
+                sighting_add(p_tracker, id, rssi, t);
+            }
+        }
+        presence_tick(p_tracker, t);
+    }
+}
+
+static int8_t trace_near(uint32_t t)
+{
+    (void) t;
+    return -70;
+}
+
+static int8_t trace_weak(uint32_t t)
+{
+    (void) t;
+    return -88;
+}
+
+static int8_t trace_silent(uint32_t t)
+{
+    (void) t;
+    return SILENT;
+}
+
+/* Raw RSSI crossing the enter threshold every second. */
+static int8_t trace_enter_edge(uint32_t t)
+{
+    return ((t / 1000) % 2 == 0) ? -82 : -90;
+}
+
+/* Raw RSSI crossing the leave threshold every second. */
+static int8_t trace_leave_edge(uint32_t t)
+{
+    return ((t / 1000) % 2 == 0) ? -86 : -98;
+}
+
+static int8_t trace_far(uint32_t t)
+{
+    (void) t;
+    return -97;
+}
+
+static void test_enter(void)
+{
+    presence_tracker_t tracker;
+    tracker_init(&tracker);
+
+    trace_run(&tracker, 1, trace_near, 0, ENTER_MS);
+    TEST_CHECK(m_event_count == 0);
+    trace_run(&tracker, 1, trace_near, ENTER_MS, ENTER_MS + 1000);
+    TEST_CHECK(m_event_count == 1);
+    TEST_CHECK(m_events[0].type == PRESENCE_EVENT_ENTER);
+    TEST_CHECK(m_events[0].timestamp == ENTER_MS);
+    TEST_CHECK(m_events[0].rssi == -70);
+    TEST_CHECK(tracker.present_count == 1);
+
+    /* Staying in range reports nothing more. */
+    trace_run(&tracker, 1, trace_near, ENTER_MS + 1000, 10 * LEAVE_MS);
+    TEST_CHECK(m_event_count == 1);
+}
+
+static void test_below_enter_rssi(void)
+{
+    presence_tracker_t tracker;
+    tracker_init(&tracker);
+
+    trace_run(&tracker, 1, trace_weak, 0, 10 * ENTER_MS);
+    TEST_CHECK(m_event_count == 0);
+    TEST_CHECK(tracker.present_count == 0);
+}
+
+static void test_entering_dropped(void)
+{
+    presence_tracker_t tracker;
+    tracker_init(&tracker);
+
+    trace_run(&tracker, 1, trace_near, 0, ENTER_MS - 1000);
+    trace_run(&tracker, 1, trace_silent, ENTER_MS - 1000, 3 * LEAVE_MS);
+    TEST_CHECK(m_event_count == 0);
+    TEST_CHECK(tracker.present_count == 0);
+    for (uint32_t i = 0; i < PRESENCE_TABLE_SIZE; i++)
+    {
+        TEST_CHECK(tracker.entries[i].state == PRESENCE_STATE_ABSENT);
+    }
+}
+
+static void test_leave(void)
+{
+    presence_tracker_t tracker;
+    tracker_init(&tracker);
+
+    trace_run(&tracker, 1, trace_near, 0, 20000);
+    TEST_CHECK(m_event_count == 1);
+
+    /* Last heard at 19000: leaving one leave time later, gone another leave time after that. */
+    trace_run(&tracker, 1, trace_silent, 20000, 19000 + 2 * LEAVE_MS);
+    TEST_CHECK(m_event_count == 1);
+    trace_run(&tracker, 1, trace_silent, 19000 + 2 * LEAVE_MS, 19000 + 2 * LEAVE_MS + 1000);
+    TEST_CHECK(m_event_count == 2);
+    TEST_CHECK(m_events[1].type == PRESENCE_EVENT_LEAVE);
+    TEST_CHECK(m_events[1].timestamp == 19000 + 2 * LEAVE_MS);
+    TEST_CHECK(tracker.present_count == 0);
+    TEST_CHECK(tracker.fingerprint == 0);
+}
+
+static void test_leave_out_of_range(void)
+{
+    presence_tracker_t tracker;
+    tracker_init(&tracker);
+
+    /* Heard, but below the leave RSSI, counts as silent once the filter has settled. */
+    trace_run(&tracker, 1, trace_near, 0, 20000);
+    trace_run(&tracker, 1, trace_far, 20000, 20000 + 3 * LEAVE_MS);
+    TEST_CHECK(m_event_count == 2);
+    TEST_CHECK(m_events[1].type == PRESENCE_EVENT_LEAVE);
+    TEST_CHECK(tracker.present_count == 0);
+}
+
+static void test_leaving_back_present(void)
+{
+    presence_tracker_t tracker;
+    tracker_init(&tracker);
+
+    trace_run(&tracker, 1, trace_near, 0, 20000);
+    trace_run(&tracker, 1, trace_silent, 20000, 20000 + LEAVE_MS + 5000);
+    TEST_CHECK(m_event_count == 1);
+
+    /* Heard again while leaving: present without any event. */
+    trace_run(&tracker, 1, trace_near, 20000 + LEAVE_MS + 5000, 20000 + 4 * LEAVE_MS);
+    TEST_CHECK(m_event_count == 1);
+    TEST_CHECK(tracker.present_count == 1);
+}
+
+static void test_edge_flapping(void)
+{
+    presence_tracker_t tracker;
+    tracker_init(&tracker);
+
+    /* At the edge of the enter threshold: entering at most once, never leaving. */
+    trace_run(&tracker, 1, trace_enter_edge, 0, 20 * LEAVE_MS);
+    TEST_CHECK(m_event_count <= 1);
+    for (uint32_t i = 0; i < m_event_count && i < EVENTS_MAX; i++)
+    {
+        TEST_CHECK(m_events[i].type == PRESENCE_EVENT_ENTER);
+    }
+
+    /* A present eartag at the edge of the leave threshold stays present. */
+    tracker_init(&tracker);
+    trace_run(&tracker, 2, trace_near, 0, 20000);
+    TEST_CHECK(m_event_count == 1);
+    trace_run(&tracker, 2, trace_leave_edge, 20000, 20 * LEAVE_MS);
+    TEST_CHECK(m_event_count == 1);
+    TEST_CHECK(tracker.present_count == 1);
+}
+
+static void test_digest(void)
+{
+    presence_tracker_t tracker;
+    tracker_init(&tracker);
+
+    /* Eartags 0 to 9 enter, then the even ones leave. */
+    for (uint32_t t = 0; t < 10000; t += 1000)
+    {
+        for (uint32_t id = 0; id < 10; id++)
+        {
+            sighting_add(&tracker, id, -60, t);
+        }
+        presence_tick(&tracker, t);
+    }
+    TEST_CHECK(tracker.present_count == 10);
+
+    uint32_t expected = 0;
+    uint8_t addr[EARTAG_ADDR_LEN];
+    for (uint32_t id = 0; id < 10; id++)
+    {
+        addr_set(addr, id);
+        expected ^= presence_addr_fingerprint(addr);
+    }
+    TEST_CHECK(tracker.fingerprint == expected);
+
+    for (uint32_t t = 10000; t < 10000 + 3 * LEAVE_MS; t += 1000)
+    {
+        for (uint32_t id = 1; id < 10; id += 2)
+        {
+            sighting_add(&tracker, id, -60, t);
+        }
+        presence_tick(&tracker, t);
+    }
+    TEST_CHECK(tracker.present_count == 5);
+    TEST_CHECK(m_event_count == 15);
+    expected = 0;
+    for (uint32_t id = 1; id < 10; id += 2)
+    {
+        addr_set(addr, id);
+        expected ^= presence_addr_fingerprint(addr);
+    }
+    TEST_CHECK(tracker.fingerprint == expected);
+}
+
+int main(void)
+{
+    test_enter();
+    test_below_enter_rssi();
+    test_entering_dropped();
+    test_leave();
+    test_leave_out_of_range();
+    test_leaving_back_present();
+    test_edge_flapping();
+    test_digest();
+    return test_exit();
+}
@@ -0,0 +1,188 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Simulates the report flushes of a fleet of scanners, and the share of reports that collide.
+ *
+ * Usage: report_phase_sim [-i interval_ms] [-a airtime_ms] [-c intervals] [-e elements] [-d drift_ppm]
+ *
+ * Every node flushes once per report interval, and a flush keeps the air busy for the airtime.
+ * A report collides if another node's report starts less than an airtime before or after it.
+ * Three ways of timing the flushes are compared:
+ * - synchronized: identically configured nodes, all started by the same group-addressed Set,
+ * - random:       every flush at an independent random time in the interval,
+ * - phased:       the report_phase offsets and jitter, timed as the report scheduler does, on
+ *                 interval ticks counted by a clock that drifts by up to @c drift_ppm.
+ * The nodes get consecutive unicast addresses, @c elements apart, as a provisioner hands them out,
+ * and derive their phase from the address divided by @c elements and from @c SERVER_NODE_COUNT,
+ * as the scanner does.
+ *
+ * Exits with a failure if the phased flushes collide more often than random ones.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "report_phase.h"
+#include "light_switch_example_common.h"
+
+#define FIRST_ADDRESS   (0x0002)
+
+static uint32_t m_seed = 7;
+
+static uint32_t rand_u32(void)
+{
+    uint32_t x = m_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m_seed = x;
+    return x;
+}
+
+static int time_compare(const void * p_a, const void * p_b)
+{
+    uint64_t a = *(const uint64_t *) p_a;
+    uint64_t b = *(const uint64_t *) p_b;
+    return (a > b) - (a < b);
+}
+
+/* Share of the flushes that start within an airtime of another one. */
+static double collision_rate(uint64_t * p_times, uint32_t count, uint32_t airtime_ms)
+{
+    qsort(p_times, count, sizeof(p_times[0]), time_compare);
+    uint32_t collisions = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bool before = (i > 0 && p_times[i] - p_times[i - 1] < airtime_ms);
+        bool after = (i + 1 < count && p_times[i + 1] - p_times[i] < airtime_ms);
+        collisions += (before || after) ? 1 : 0;
+    }
+    return (count > 0) ? (double) collisions / count : 0.0;
+}
+
+int main(int argc, char ** argv)
+{
+    static const uint32_t fleet_sizes[] = {2, 4, 8, 16, SERVER_NODE_COUNT};
+    uint32_t interval_ms = 10000;
+    uint32_t airtime_ms = 100;
+    uint32_t intervals = 360;
+    uint32_t elements = 2;
+    uint32_t drift_ppm = 20;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        uint32_t value = (uint32_t) strtoul(argv[i + 1], NULL, 0);
+        if (strcmp(argv[i], "-i") == 0)
+        {
+            interval_ms = value;
+        }
+        else if (strcmp(argv[i], "-a") == 0)
+        {
+            airtime_ms = value;
+        }
+        else if (strcmp(argv[i], "-c") == 0)
+        {
+            intervals = value;
+        }
+        else if (strcmp(argv[i], "-e") == 0)
+        {
+            elements = value;
+        }
+        else if (strcmp(argv[i], "-d") == 0)
+        {
+            drift_ppm = value;
+        }
+    }
+    if ((argc % 2) == 0 || interval_ms == 0 || intervals == 0 || elements == 0)
+    {
+        fprintf(stderr, "Usage: %s [-i interval_ms] [-a airtime_ms] [-c intervals] [-e elements] [-d drift_ppm]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    printf("Interval %u ms, airtime %u ms, %u intervals, nodes %u addresses apart, clock drift up to %u ppm\n",
+           interval_ms, airtime_ms, intervals, elements, drift_ppm);
+    printf("nodes  synchronized   random   phased\n");
+    bool phased_worse = false;
+    for (uint32_t f = 0; f < sizeof(fleet_sizes) / sizeof(fleet_sizes[0]); f++)
+    {
+        uint32_t node_count = fleet_sizes[f];
+        uint32_t count = node_count * intervals;
+        uint64_t * p_times = malloc(count * sizeof(uint64_t));
+        if (p_times == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            p_times[i] = (uint64_t) (i / node_count) * interval_ms;
+        }
+        double synchronized = collision_rate(p_times, count, airtime_ms);
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            p_times[i] = (uint64_t) (i / node_count) * interval_ms + rand_u32() % interval_ms;
+        }
+        double random = collision_rate(p_times, count, airtime_ms);
+
+        for (uint32_t n = 0; n < node_count; n++)
+        {
+            report_phase_t phase;
+            report_phase_init(&phase, (uint16_t) ((FIRST_ADDRESS + n * elements) / elements), interval_ms, SERVER_NODE_COUNT);
+
+            /* As the interval timer handler of the report scheduler, on the node's own clock. */
+            double rate = 1.0 + ((double) (rand_u32() % (2 * drift_ppm + 1)) - drift_ppm) * 1e-6;
+            for (uint32_t k = 0; k < intervals; k++)
+            {
+                uint32_t jitter_ms = report_phase_jitter_get(&phase);
+                uint64_t local = (uint64_t) k * interval_ms +
+                                 (phase.offset_ms + interval_ms - phase.jitter_ms / 2 + jitter_ms) % interval_ms;
+                p_times[n * intervals + k] = (uint64_t) (local * rate);
+            }
+        }
+        double phased = collision_rate(p_times, count, airtime_ms);
+        free(p_times);
+
+        printf("%5u  %11.1f %%  %5.1f %%  %5.1f %%\n", node_count, 100 * synchronized, 100 * random, 100 * phased);
+        phased_worse = phased_worse || (phased > random);
+    }
+    return phased_worse ? EXIT_FAILURE : EXIT_SUCCESS;
+}
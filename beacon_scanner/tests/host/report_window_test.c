@@ -0,0 +1,310 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Unit tests of the report send window, with the messages in blocks of the TX pool. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "host_test.h"
+#include "simple_beacon_report_window.h"
+#include "simple_beacon_tx_pool.h"
+
+#define OPCODE      (0xC5)
+#define LENGTH      (20)
+#define TIMEOUT     (100)
+
+static simple_beacon_tx_pool_t m_pool;
+static simple_beacon_report_window_t m_window;
+
+static void window_init(void)
+{
+    simple_beacon_tx_pool_init(&m_pool);
+    simple_beacon_report_window_init(&m_window, &m_pool);
+}
+
+/* Publishes a message the way the server does: built in a block, which the window keeps and the
+ * builder releases. */
+static void message_send(uint16_t seq, uint32_t now)
+{
+    uint8_t * p_data = simple_beacon_tx_pool_alloc(&m_pool);
+    TEST_CHECK(p_data != NULL);
+    if (p_data == NULL)
+    {
+        return;
+    }
+    p_data[0] = (uint8_t) seq;
+    simple_beacon_report_window_store(&m_window, seq, OPCODE, p_data, LENGTH, now);
+    simple_beacon_tx_pool_unref(&m_pool, p_data);
+}
+
+static simple_beacon_report_slot_t * slot_get(uint16_t seq)
+{
+    for (uint32_t i = 0; i < SIMPLE_BEACON_REPORT_WINDOW_SIZE; i++)
+    {
+        if (m_window.slots[i].state != SIMPLE_BEACON_REPORT_SLOT_FREE && m_window.slots[i].seq == seq)
+        {
+            return &m_window.slots[i];
+        }
+    }
+    return NULL;
+}
+
+/* Every block is either free or kept by the window. */
+static bool pool_conserved(void)
+{
+    return simple_beacon_tx_pool_free_count(&m_pool) + m_window.count == SIMPLE_BEACON_TX_POOL_SIZE;
+}
+
+static void test_cumulative_ack(void)
+{
+    window_init();
+    for (uint16_t seq = 0; seq < 4; seq++)
+    {
+        message_send(seq, 0);
+    }
+    TEST_CHECK(m_window.count == 4);
+    TEST_CHECK(pool_conserved());
+
+    TEST_CHECK(simple_beacon_report_window_ack(&m_window, 2, 0) == 2);
+    TEST_CHECK(m_window.count == 2);
+    TEST_CHECK(slot_get(0) == NULL && slot_get(1) == NULL);
+    TEST_CHECK(slot_get(2)->state == SIMPLE_BEACON_REPORT_SLOT_SENT);
+
+    /* A stale ack changes nothing. */
+    TEST_CHECK(simple_beacon_report_window_ack(&m_window, 1, 0) == 0);
+    TEST_CHECK(m_window.count == 2);
+
+    TEST_CHECK(simple_beacon_report_window_ack(&m_window, 4, 0) == 2);
+    TEST_CHECK(m_window.count == 0);
+    TEST_CHECK(m_window.acked_count == 4);
+    TEST_CHECK(simple_beacon_tx_pool_free_count(&m_pool) == SIMPLE_BEACON_TX_POOL_SIZE);
+}
+
+static void test_full(void)
+{
+    window_init();
+    for (uint16_t seq = 0; seq < SIMPLE_BEACON_REPORT_WINDOW_SIZE; seq++)
+    {
+        TEST_CHECK(!simple_beacon_report_window_is_full(&m_window));
+        message_send(seq, 0);
+    }
+    TEST_CHECK(simple_beacon_report_window_is_full(&m_window));
+    /* Full windows leave the headroom for the replies. */
+    TEST_CHECK(simple_beacon_tx_pool_free_count(&m_pool) == SIMPLE_BEACON_TX_POOL_SIZE - SIMPLE_BEACON_REPORT_WINDOW_SIZE);
+
+    TEST_CHECK(simple_beacon_report_window_ack(&m_window, 1, 0) == 1);
+    TEST_CHECK(!simple_beacon_report_window_is_full(&m_window));
+    TEST_CHECK(pool_conserved());
+}
+
+static void test_selective_ack(void)
+{
+    window_init();
+    for (uint16_t seq = 10; seq < 15; seq++)
+    {
+        message_send(seq, 0);
+    }
+
+    /* 12 and 13 received: 10 and 11 are missing, 14 may still be on its way. */
+    TEST_CHECK(simple_beacon_report_window_ack(&m_window, 10, 0x6) == 2);
+    TEST_CHECK(m_window.count == 3);
+    TEST_CHECK(slot_get(10)->state == SIMPLE_BEACON_REPORT_SLOT_LOST);
+    TEST_CHECK(slot_get(11)->state == SIMPLE_BEACON_REPORT_SLOT_LOST);
+    TEST_CHECK(slot_get(12) == NULL && slot_get(13) == NULL);
+    TEST_CHECK(slot_get(14)->state == SIMPLE_BEACON_REPORT_SLOT_SENT);
+    TEST_CHECK(pool_conserved());
+
+    /* Lost messages go at once, oldest first, before any timeout. */
+    simple_beacon_report_slot_t * p_slot = simple_beacon_report_window_retransmit_get(&m_window, 1, TIMEOUT);
+    TEST_CHECK(p_slot == slot_get(10));
+    TEST_CHECK(p_slot->p_data[0] == 10 && p_slot->length == LENGTH && p_slot->opcode == OPCODE);
+    simple_beacon_report_window_sent(&m_window, p_slot, 1);
+    TEST_CHECK(slot_get(10)->state == SIMPLE_BEACON_REPORT_SLOT_SENT);
+
+    p_slot = simple_beacon_report_window_retransmit_get(&m_window, 1, TIMEOUT);
+    TEST_CHECK(p_slot == slot_get(11));
+    simple_beacon_report_window_sent(&m_window, p_slot, 1);
+
+    TEST_CHECK(simple_beacon_report_window_retransmit_get(&m_window, 1, TIMEOUT) == NULL);
+    TEST_CHECK(m_window.retransmit_count == 2);
+
+    /* The timeout picks the oldest sent message. */
+    p_slot = simple_beacon_report_window_retransmit_get(&m_window, TIMEOUT, TIMEOUT);
+    TEST_CHECK(p_slot == slot_get(14));
+}
+
+static void test_backoff(void)
+{
+    window_init();
+    message_send(0, 0);
+    simple_beacon_report_slot_t * p_slot = slot_get(0);
+
+    uint32_t sent = 0;
+    for (uint32_t retry = 0; retry < SIMPLE_BEACON_REPORT_RETRIES_MAX; retry++)
+    {
+        uint32_t shift = (retry < SIMPLE_BEACON_REPORT_BACKOFF_SHIFT_MAX) ? retry : SIMPLE_BEACON_REPORT_BACKOFF_SHIFT_MAX;
+        uint32_t due = sent + (TIMEOUT << shift);
+        TEST_CHECK(simple_beacon_report_window_retransmit_get(&m_window, due - 1, TIMEOUT) == NULL);
+        TEST_CHECK(simple_beacon_report_window_retransmit_get(&m_window, due, TIMEOUT) == p_slot);
+        simple_beacon_report_window_sent(&m_window, p_slot, due);
+        sent = due;
+    }
+    TEST_CHECK(p_slot->retries == SIMPLE_BEACON_REPORT_RETRIES_MAX);
+
+    /* Out of retransmissions: given up once the last one times out. */
+    uint32_t due = sent + (TIMEOUT << SIMPLE_BEACON_REPORT_BACKOFF_SHIFT_MAX);
+    TEST_CHECK(simple_beacon_report_window_retransmit_get(&m_window, due, TIMEOUT) == NULL);
+    TEST_CHECK(simple_beacon_report_window_expired_get(&m_window, due - 1, TIMEOUT) == NULL);
+    TEST_CHECK(simple_beacon_report_window_expired_get(&m_window, due, TIMEOUT) == p_slot);
+    simple_beacon_report_window_expire(&m_window, p_slot);
+    TEST_CHECK(m_window.count == 0);
+    TEST_CHECK(m_window.expired_count == 1);
+    TEST_CHECK(m_window.acked_count == 0);
+    TEST_CHECK(simple_beacon_tx_pool_free_count(&m_pool) == SIMPLE_BEACON_TX_POOL_SIZE);
+}
+
+static void test_lost_expires(void)
+{
+    window_init();
+    message_send(0, 0);
+    message_send(1, 0);
+    simple_beacon_report_slot_t * p_slot = slot_get(0);
+    for (uint32_t retry = 0; retry < SIMPLE_BEACON_REPORT_RETRIES_MAX; retry++)
+    {
+        TEST_CHECK(simple_beacon_report_window_ack(&m_window, 0, 0x1) == ((retry == 0) ? 1 : 0));
+        TEST_CHECK(simple_beacon_report_window_retransmit_get(&m_window, retry, TIMEOUT) == p_slot);
+        simple_beacon_report_window_sent(&m_window, p_slot, retry);
+    }
+
+    /* Reported lost after its last retransmission: given up without waiting for the timeout. */
+    TEST_CHECK(simple_beacon_report_window_expired_get(&m_window, 10, TIMEOUT) == NULL);
+    simple_beacon_report_window_ack(&m_window, 0, 0x1);
+    TEST_CHECK(simple_beacon_report_window_retransmit_get(&m_window, 10, TIMEOUT) == NULL);
+    TEST_CHECK(simple_beacon_report_window_expired_get(&m_window, 10, TIMEOUT) == p_slot);
+    simple_beacon_report_window_expire(&m_window, p_slot);
+    TEST_CHECK(pool_conserved());
+}
+
+static void test_wraparound(void)
+{
+    window_init();
+    const uint16_t first = UINT16_MAX - 1;
+    for (uint16_t i = 0; i < 5; i++)
+    {
+        message_send((uint16_t) (first + i), 0);
+    }
+
+    /* 65535 and 0 missing, 1 received. */
+    TEST_CHECK(simple_beacon_report_window_ack(&m_window, UINT16_MAX, 0x2) == 2);
+    TEST_CHECK(slot_get(first) == NULL && slot_get(1) == NULL);
+    TEST_CHECK(slot_get(UINT16_MAX)->state == SIMPLE_BEACON_REPORT_SLOT_LOST);
+    TEST_CHECK(slot_get(0)->state == SIMPLE_BEACON_REPORT_SLOT_LOST);
+    TEST_CHECK(slot_get(2)->state == SIMPLE_BEACON_REPORT_SLOT_SENT);
+
+    /* Oldest across the wrap. */
+    TEST_CHECK(simple_beacon_report_window_retransmit_get(&m_window, 0, TIMEOUT) == slot_get(UINT16_MAX));
+
+    TEST_CHECK(simple_beacon_report_window_ack(&m_window, 3, 0) == 3);
+    TEST_CHECK(m_window.count == 0);
+    TEST_CHECK(simple_beacon_tx_pool_free_count(&m_pool) == SIMPLE_BEACON_TX_POOL_SIZE);
+}
+
+/* Random sends, acks, losses and timeouts: every message ends acked or given up, and every block
+ * returns to the pool. */
+static void test_conservation(void)
+{
+    window_init();
+    srand(7);
+
+    uint16_t next_seq = UINT16_MAX - 500;
+    uint16_t gateway_seq = next_seq;
+    uint32_t sent_count = 0;
+
+    for (uint32_t now = 0; now < 200000; now += 10)
+    {
+        if (!simple_beacon_report_window_is_full(&m_window) && rand() % 4 == 0)
+        {
+            message_send(next_seq++, now);
+            sent_count++;
+        }
+
+        if (rand() % 8 == 0)
+        {
+            /* The gateway received everything up to a random point, and some of the rest. */
+            uint16_t in_flight = (uint16_t) (next_seq - gateway_seq);
+            if (in_flight > 0)
+            {
+                gateway_seq = (uint16_t) (gateway_seq + rand() % (in_flight + 1));
+            }
+            uint32_t bitmap = (uint32_t) rand() & 0xFF;
+            simple_beacon_report_window_ack(&m_window, gateway_seq, bitmap);
+        }
+
+        simple_beacon_report_slot_t * p_slot = simple_beacon_report_window_expired_get(&m_window, now, TIMEOUT);
+        if (p_slot != NULL)
+        {
+            simple_beacon_report_window_expire(&m_window, p_slot);
+        }
+        p_slot = simple_beacon_report_window_retransmit_get(&m_window, now, TIMEOUT);
+        if (p_slot != NULL)
+        {
+            simple_beacon_report_window_sent(&m_window, p_slot, now);
+        }
+
+        TEST_CHECK(m_window.count <= SIMPLE_BEACON_REPORT_WINDOW_SIZE);
+        TEST_CHECK(pool_conserved());
+    }
+
+    simple_beacon_report_window_ack(&m_window, next_seq, 0);
+    TEST_CHECK(m_window.count == 0);
+    TEST_CHECK(m_window.acked_count + m_window.expired_count == sent_count);
+    TEST_CHECK(simple_beacon_tx_pool_free_count(&m_pool) == SIMPLE_BEACON_TX_POOL_SIZE);
+}
+
+int main(void)
+{
+    test_cumulative_ack();
+    test_full();
+    test_selective_ack();
+    test_backoff();
+    test_lost_expires();
+    test_wraparound();
+    test_conservation();
+    return test_exit();
+}
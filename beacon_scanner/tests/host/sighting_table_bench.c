@@ -0,0 +1,172 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Measures the insert throughput of the sighting table at 50, 90 and 99 % load factor.
+ *
+ * Usage: sighting_table_bench [-n inserts]
+ *
+ * For every load factor the table is filled with distinct eartags, then two kinds of inserts
+ * are timed: sightings of eartags already in the table (the common case), and sightings of new
+ * eartags, which take a free slot or evict one. New eartags are inserted into a copy of the
+ * filled table, so the load factor stays the same throughout.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "sighting_table.h"
+
+/* New eartags inserted into one copy of the filled table. */
+#define NEW_BATCH_SIZE  (16)
+
+static sighting_table_t m_table;
+static sighting_table_t m_filled;
+static uint32_t m_seed = 1;
+
+static uint32_t rand_u32(void)
+{
+    uint32_t x = m_seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    m_seed = x;
+    return x;
+}
+
+static void sighting_random(eartag_sighting_t * p_sighting, uint32_t timestamp)
+{
+    uint32_t low = rand_u32();
+    uint32_t high = rand_u32();
+    memcpy(&p_sighting->addr[0], &low, 4);
+    memcpy(&p_sighting->addr[4], &high, 2);
+    p_sighting->rssi = (int8_t) (-90 + (int32_t) (high >> 24) % 40);
+    p_sighting->timestamp = timestamp;
+}
+
+/* Fills the table with distinct eartags, returns the number of eartags in the table. */
+static uint32_t table_fill(uint32_t target, eartag_sighting_t * p_present)
+{
+    sighting_table_init(&m_filled);
+    for (uint32_t attempt = 0; attempt < 100 * SIGHTING_TABLE_SIZE && sighting_table_count(&m_filled) < target; attempt++)
+    {
+        eartag_sighting_t sighting;
+        sighting_random(&sighting, attempt);
+        (void) sighting_table_insert(&m_filled, &sighting, NULL);
+    }
+
+    /* Collect the eartags that stayed in, the probe limit may have evicted some on the way. */
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < SIGHTING_TABLE_SIZE; i++)
+    {
+        if (m_filled.entries[i].count > 0)
+        {
+            memcpy(p_present[count].addr, m_filled.entries[i].addr, EARTAG_ADDR_LEN);
+            p_present[count].rssi = -60;
+            count++;
+        }
+    }
+    return count;
+}
+
+int main(int argc, char ** argv)
+{
+    static const uint32_t load_percents[] = {50, 90, 99};
+    uint32_t insert_count = 10000000;
+    if (argc == 3 && strcmp(argv[1], "-n") == 0)
+    {
+        insert_count = (uint32_t) strtoul(argv[2], NULL, 0);
+    }
+
+    printf("Sighting table of %u slots, probe limit %u\n", SIGHTING_TABLE_SIZE, SIGHTING_TABLE_PROBE_MAX);
+    printf("load target  load reached  known eartag  new eartag  evictions of new\n");
+    for (uint32_t l = 0; l < sizeof(load_percents) / sizeof(load_percents[0]); l++)
+    {
+        static eartag_sighting_t present[SIGHTING_TABLE_SIZE];
+        uint32_t target = (SIGHTING_TABLE_SIZE * load_percents[l] + 99) / 100;
+        uint32_t present_count = table_fill(target, present);
+
+        /* Sightings of eartags in the table, in random order. */
+        uint32_t * p_order = malloc(insert_count * sizeof(uint32_t));
+        if (p_order == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+        for (uint32_t i = 0; i < insert_count; i++)
+        {
+            p_order[i] = rand_u32() % present_count;
+        }
+        m_table = m_filled;
+        uint64_t start = test_time_ns();
+        for (uint32_t i = 0; i < insert_count; i++)
+        {
+            present[p_order[i]].timestamp = i;
+            (void) sighting_table_insert(&m_table, &present[p_order[i]], NULL);
+        }
+        double known_ns = (double) (test_time_ns() - start) / insert_count;
+        free(p_order);
+
+        /* Sightings of new eartags, a batch at a time into a fresh copy of the filled table. */
+        uint32_t batch_count = insert_count / NEW_BATCH_SIZE / 8;
+        uint64_t new_elapsed_ns = 0;
+        uint32_t evict_count = 0;
+        for (uint32_t b = 0; b < batch_count; b++)
+        {
+            eartag_sighting_t batch[NEW_BATCH_SIZE];
+            for (uint32_t i = 0; i < NEW_BATCH_SIZE; i++)
+            {
+                sighting_random(&batch[i], insert_count + i);
+            }
+            m_table = m_filled;
+            start = test_time_ns();
+            for (uint32_t i = 0; i < NEW_BATCH_SIZE; i++)
+            {
+                evict_count += sighting_table_insert(&m_table, &batch[i], NULL) ? 1 : 0;
+            }
+            new_elapsed_ns += test_time_ns() - start;
+        }
+        uint32_t new_count = batch_count * NEW_BATCH_SIZE;
+
+        printf("%8u %%  %10.1f %%  %9.1f ns  %8.1f ns  %13.1f %%\n",
+               load_percents[l], 100.0 * present_count / SIGHTING_TABLE_SIZE, known_ns,
+               (double) new_elapsed_ns / (new_count ? new_count : 1), 100.0 * evict_count / (new_count ? new_count : 1));
+    }
+    return EXIT_SUCCESS;
+}
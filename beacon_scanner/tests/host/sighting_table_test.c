@@ -0,0 +1,246 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Unit tests of the sighting table. */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "host_test.h"
+#include "sighting_table.h"
+
+#define KEY_POOL_SIZE   (3 * SIGHTING_TABLE_SIZE)
+
+static sighting_table_t m_table;
+
+static void sighting_make(eartag_sighting_t * p_sighting, uint32_t key, int8_t rssi, uint32_t timestamp)
+{
+    memset(p_sighting, 0, sizeof(*p_sighting));
+    p_sighting->addr[0] = (uint8_t) key;
+    p_sighting->addr[1] = (uint8_t) (key >> 8);
+    p_sighting->addr[2] = (uint8_t) (key >> 16);
+    p_sighting->addr[5] = 0xC0;
+    p_sighting->rssi = rssi;
+    p_sighting->minor = (uint16_t) timestamp;
+    p_sighting->timestamp = timestamp;
+}
+
+static uint32_t key_get(const uint8_t * p_addr)
+{
+    return (uint32_t) p_addr[0] | ((uint32_t) p_addr[1] << 8) | ((uint32_t) p_addr[2] << 16);
+}
+
+static void test_aggregate(void)
+{
+    eartag_sighting_t sighting;
+    sighting_entry_t entry;
+    sighting_table_init(&m_table);
+
+    sighting_make(&sighting, 1, -70, 100);
+    TEST_CHECK(!sighting_table_insert(&m_table, &sighting, NULL));
+    sighting_make(&sighting, 1, -60, 200);
+    TEST_CHECK(!sighting_table_insert(&m_table, &sighting, NULL));
+    sighting_make(&sighting, 1, -80, 300);
+    TEST_CHECK(!sighting_table_insert(&m_table, &sighting, NULL));
+    TEST_CHECK(sighting_table_count(&m_table) == 1);
+
+    TEST_CHECK(sighting_table_drain(&m_table, &entry, 1) == 1);
+    TEST_CHECK(key_get(entry.addr) == 1);
+    TEST_CHECK(entry.count == 3);
+    TEST_CHECK(entry.rssi_min == -80 && entry.rssi_max == -60 && entry.rssi_sum == -210);
+    TEST_CHECK(entry.first_timestamp == 100 && entry.last_timestamp == 300);
+    TEST_CHECK(entry.minor == 300);
+    TEST_CHECK(sighting_table_count(&m_table) == 0);
+}
+
+static void test_count_saturates(void)
+{
+    eartag_sighting_t sighting;
+    sighting_entry_t entry;
+    sighting_table_init(&m_table);
+
+    for (uint32_t i = 0; i < UINT16_MAX + 10u; i++)
+    {
+        sighting_make(&sighting, 7, -50, i);
+        sighting_table_insert(&m_table, &sighting, NULL);
+    }
+    TEST_CHECK(sighting_table_drain(&m_table, &entry, 1) == 1);
+    TEST_CHECK(entry.count == UINT16_MAX);
+}
+
+static void test_drain_in_steps(void)
+{
+    eartag_sighting_t sighting;
+    sighting_entry_t entries[SIGHTING_TABLE_SIZE];
+    sighting_table_init(&m_table);
+
+    for (uint32_t key = 0; key < 50; key++)
+    {
+        sighting_make(&sighting, key, -60, key);
+        sighting_table_insert(&m_table, &sighting, NULL);
+    }
+    uint32_t drained = sighting_table_drain(&m_table, entries, 10);
+    TEST_CHECK(drained == 10);
+    TEST_CHECK(sighting_table_count(&m_table) == 50 - m_table.evict_count - 10);
+
+    /* A drained eartag heard again gets a fresh entry, behind the deleted slot. */
+    sighting_make(&sighting, key_get(entries[0].addr), -55, 1000);
+    sighting_table_insert(&m_table, &sighting, NULL);
+
+    uint32_t remaining = sighting_table_count(&m_table);
+    drained = sighting_table_drain(&m_table, entries, SIGHTING_TABLE_SIZE);
+    TEST_CHECK(drained == remaining);
+    TEST_CHECK(sighting_table_count(&m_table) == 0);
+
+    bool found = false;
+    for (uint32_t i = 0; i < drained; i++)
+    {
+        if (entries[i].last_timestamp == 1000)
+        {
+            found = true;
+            TEST_CHECK(entries[i].count == 1 && entries[i].rssi_sum == -55);
+        }
+    }
+    TEST_CHECK(found);
+}
+
+static void test_merge(void)
+{
+    eartag_sighting_t sighting;
+    sighting_entry_t entry;
+    sighting_table_init(&m_table);
+
+    sighting_make(&sighting, 3, -70, 100);
+    sighting_table_insert(&m_table, &sighting, NULL);
+    sighting_table_insert(&m_table, &sighting, NULL);
+    TEST_CHECK(sighting_table_drain(&m_table, &entry, 1) == 1);
+
+    /* Newer sightings arrived while the entry was out, the merge keeps both. */
+    sighting_make(&sighting, 3, -50, 500);
+    sighting_table_insert(&m_table, &sighting, NULL);
+    TEST_CHECK(!sighting_table_merge(&m_table, &entry, NULL));
+    TEST_CHECK(sighting_table_count(&m_table) == 1);
+
+    TEST_CHECK(sighting_table_drain(&m_table, &entry, 1) == 1);
+    TEST_CHECK(entry.count == 3 && entry.rssi_sum == -190);
+    TEST_CHECK(entry.rssi_min == -70 && entry.rssi_max == -50);
+    TEST_CHECK(entry.first_timestamp == 100 && entry.last_timestamp == 500 && entry.minor == 500);
+}
+
+static void test_eviction(void)
+{
+    eartag_sighting_t sighting;
+    sighting_entry_t evicted;
+    sighting_table_init(&m_table);
+
+    /* Every insert of a new eartag into a full probe window evicts the least recently seen. */
+    uint32_t evict_count = 0;
+    for (uint32_t key = 0; key < 4 * SIGHTING_TABLE_SIZE; key++)
+    {
+        sighting_make(&sighting, key, -60, key);
+        if (sighting_table_insert(&m_table, &sighting, &evicted))
+        {
+            evict_count++;
+            TEST_CHECK(evicted.count == 1);
+            TEST_CHECK(key_get(evicted.addr) != key);
+            TEST_CHECK(evicted.last_timestamp < key);
+        }
+        TEST_CHECK(sighting_table_count(&m_table) <= SIGHTING_TABLE_SIZE);
+    }
+    TEST_CHECK(evict_count == m_table.evict_count);
+    TEST_CHECK(evict_count + sighting_table_count(&m_table) == 4 * SIGHTING_TABLE_SIZE);
+}
+
+static void test_conservation(void)
+{
+    /* Random sightings, drains and evictions: no sighting is lost or counted twice. */
+    static uint32_t inserted[KEY_POOL_SIZE];
+    static uint32_t collected[KEY_POOL_SIZE];
+    sighting_entry_t entries[SIGHTING_TABLE_SIZE];
+    eartag_sighting_t sighting;
+    sighting_entry_t evicted;
+    uint32_t seed = 12345;
+
+    memset(inserted, 0, sizeof(inserted));
+    memset(collected, 0, sizeof(collected));
+    sighting_table_init(&m_table);
+
+    for (uint32_t step = 0; step < 200000; step++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+
+        if ((seed & 0xFF) == 0)
+        {
+            uint32_t count = sighting_table_drain(&m_table, entries, (seed >> 8) % SIGHTING_TABLE_SIZE);
+            for (uint32_t i = 0; i < count; i++)
+            {
+                collected[key_get(entries[i].addr)] += entries[i].count;
+            }
+            continue;
+        }
+
+        uint32_t key = (seed >> 8) % KEY_POOL_SIZE;
+        sighting_make(&sighting, key, -60, step);
+        inserted[key]++;
+        if (sighting_table_insert(&m_table, &sighting, &evicted))
+        {
+            collected[key_get(evicted.addr)] += evicted.count;
+        }
+    }
+
+    uint32_t count = sighting_table_drain(&m_table, entries, SIGHTING_TABLE_SIZE);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        collected[key_get(entries[i].addr)] += entries[i].count;
+    }
+    TEST_CHECK(sighting_table_count(&m_table) == 0);
+    TEST_CHECK(memcmp(inserted, collected, sizeof(inserted)) == 0);
+}
+
+int main(void)
+{
+    test_aggregate();
+    test_count_saturates();
+    test_drain_in_steps();
+    test_merge();
+    test_eviction();
+    test_conservation();
+    return test_exit();
+}
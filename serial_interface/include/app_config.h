@@ -41,4 +41,11 @@
 /* Override default sdk_config.h values. */
 #define APP_TIMER_ENABLED 1
 
+/** Interval between the streams of the whole DFU fleet table to the host, in milliseconds. */
+#define APP_CONFIG_DFU_FLEET_STREAM_INTERVAL_MS (15000)
+
+/** Interval between two parts of a DFU fleet table stream, in milliseconds. A part goes on until
+ * the serial TX queue is full. */
+#define APP_CONFIG_DFU_FLEET_STREAM_TICK_MS (50)
+
 #endif /* APP_CONFIG_H__ */
@@ -0,0 +1,199 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DFU_FLEET_H__
+#define DFU_FLEET_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "dfu_status_common.h"
+
+/**
+ * @defgroup DFU_FLEET DFU fleet table
+ *
+ * Collects the DFU Status messages of the scanners into a fleet-wide progress table, which the
+ * gateway streams to the host over the serial interface.
+ *
+ * Every node is a row, keyed by its unicast address. A node that is receiving or relaying and has
+ * not made progress for @ref DFU_FLEET_STALL_MS is flagged as stalled. The summary tells the host
+ * when no node is receiving anymore, so the source can stop retransmitting.
+ *
+ * The rows and the summary are sent as serial application events, in the packed record formats
+ * below, each starting with its @ref dfu_fleet_record_type_t.
+ *
+ * The host pushes a DFU policy with a serial application command starting with
+ * @ref DFU_FLEET_COMMAND_POLICY_SET, followed by a @ref dfu_status_msg_policy_set_t. The gateway
+ * publishes it, and forwards the Policy Status replies of the nodes as
+ * @ref DFU_FLEET_RECORD_POLICY_STATUS records.
+ *
+ * The table is not thread safe. All calls must be made from the same interrupt priority.
+ * The module has no SDK dependencies, and can be built for the host.
+ * @{
+ */
+
+/** Highest number of nodes in the table. */
+#ifndef DFU_FLEET_NODES_MAX
+#define DFU_FLEET_NODES_MAX     (64)
+#endif
+
+/** Time without progress after which a transferring node is stalled, in milliseconds. */
+#ifndef DFU_FLEET_STALL_MS
+#define DFU_FLEET_STALL_MS      (30000)
+#endif
+
+/** Record types of the serial events. */
+typedef enum
+{
+    DFU_FLEET_RECORD_NODE = 0x01,         /**< One row of the table, @ref dfu_fleet_node_record_t. */
+    DFU_FLEET_RECORD_SUMMARY = 0x02,      /**< Fleet summary, @ref dfu_fleet_summary_record_t. */
+    DFU_FLEET_RECORD_POLICY_STATUS = 0x03 /**< Policy of one node, @ref dfu_fleet_policy_record_t. */
+} dfu_fleet_record_type_t;
+
+/** Command types of the serial commands from the host. */
+typedef enum
+{
+    DFU_FLEET_COMMAND_POLICY_SET = 0x01 /**< Publish a policy, followed by @ref dfu_status_msg_policy_set_t. */
+} dfu_fleet_command_type_t;
+
+/*lint -align_max(push) -align_max(1) */
+
+/** Serial record of one node. */
+typedef struct __attribute((packed))
+{
+    uint8_t  record;         /**< @ref DFU_FLEET_RECORD_NODE. */
+    uint16_t addr;           /**< Unicast address of the node. */
+    uint8_t  state;          /**< Transfer state, @ref dfu_status_state_t. */
+    uint8_t  end_reason;     /**< End reason of the last transfer. */
+    uint32_t fw_version;     /**< Version of the transferred firmware. */
+    uint16_t segment_count;  /**< Number of segments in the image, 0 if not known yet. */
+    uint16_t received_count; /**< Number of segments received. */
+    uint16_t relay_count;    /**< Number of transfers relayed since boot. */
+    uint8_t  missing_count;  /**< Number of missing ranges reported. */
+    uint16_t first_missing;  /**< First missing segment, 0 if none. */
+    uint8_t  stalled;        /**< 1 if the node is stalled. */
+    uint16_t age_s;          /**< Time since the last status of the node, in seconds, saturating. */
+    uint16_t policy_id;      /**< Identifier of the DFU policy in use. */
+    uint8_t  in_cohort;      /**< 1 if the node is in the rollout cohort of the policy. */
+} dfu_fleet_node_record_t;
+
+/** Serial record of the fleet summary. */
+typedef struct __attribute((packed))
+{
+    uint8_t  record;          /**< @ref DFU_FLEET_RECORD_SUMMARY. */
+    uint16_t node_count;      /**< Number of nodes in the table. */
+    uint16_t receiving_count; /**< Number of nodes receiving the image. */
+    uint16_t complete_count;  /**< Number of nodes with the complete image. */
+    uint16_t failed_count;    /**< Number of nodes whose transfer failed. */
+    uint16_t stalled_count;   /**< Number of stalled nodes. */
+    uint16_t overflow_count;  /**< Number of statuses from nodes that did not fit in the table. */
+    uint8_t  all_complete;    /**< 1 if some nodes have the image and none is receiving it. */
+    uint16_t in_cohort_count; /**< Number of nodes in the rollout cohort of their policy. */
+} dfu_fleet_summary_record_t;
+
+/** Serial record of the Policy Status of one node. */
+typedef struct __attribute((packed))
+{
+    uint8_t  record;    /**< @ref DFU_FLEET_RECORD_POLICY_STATUS. */
+    uint16_t addr;      /**< Unicast address of the node. */
+    uint16_t policy_id; /**< Identifier of the policy in use. */
+    uint8_t  in_cohort; /**< 1 if the node is in the rollout cohort of the policy. */
+    uint8_t  cohort;    /**< Cohort of the node, 0 to 99. */
+} dfu_fleet_policy_record_t;
+
+/*lint -align_max(pop) */
+
+/** One node in the table. */
+typedef struct
+{
+    uint16_t addr;                   /**< Unicast address of the node. */
+    dfu_status_msg_status_t status;  /**< Last status of the node. */
+    uint32_t update_timestamp;       /**< Time of the last status. */
+    uint32_t progress_timestamp;     /**< Time the node last changed state or received segments. */
+} dfu_fleet_node_t;
+
+/** Fleet table. */
+typedef struct
+{
+    dfu_fleet_node_t nodes[DFU_FLEET_NODES_MAX]; /**< Nodes, in order of first status. */
+    uint32_t count;                              /**< Number of nodes. */
+    uint32_t overflow_count;                     /**< Number of statuses dropped for a full table. */
+} dfu_fleet_t;
+
+/**
+ * Initializes an empty table.
+ *
+ * @param[out] p_fleet Table to initialize.
+ */
+void dfu_fleet_init(dfu_fleet_t * p_fleet);
+
+/**
+ * Records the status of a node.
+ *
+ * @param[in,out] p_fleet  Table.
+ * @param[in]     addr     Unicast address of the node.
+ * @param[in]     p_status Status of the node.
+ * @param[in]     now      Current time, in milliseconds.
+ *
+ * @returns The row of the node, or NULL if the table is full.
+ */
+const dfu_fleet_node_t * dfu_fleet_update(dfu_fleet_t * p_fleet,
+                                          uint16_t addr,
+                                          const dfu_status_msg_status_t * p_status,
+                                          uint32_t now);
+
+/**
+ * Gets the serial record of a node.
+ *
+ * @param[in]  p_node   Row of the node.
+ * @param[in]  now      Current time, in milliseconds.
+ * @param[out] p_record Record to fill in.
+ */
+void dfu_fleet_node_record_get(const dfu_fleet_node_t * p_node, uint32_t now, dfu_fleet_node_record_t * p_record);
+
+/**
+ * Gets the serial record of the fleet summary.
+ *
+ * @param[in]  p_fleet  Table.
+ * @param[in]  now      Current time, in milliseconds.
+ * @param[out] p_record Record to fill in.
+ */
+void dfu_fleet_summary_get(const dfu_fleet_t * p_fleet, uint32_t now, dfu_fleet_summary_record_t * p_record);
+
+/** @} end of DFU_FLEET */
+
+#endif /* DFU_FLEET_H__ */
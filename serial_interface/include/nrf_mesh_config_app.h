@@ -81,8 +81,10 @@
  *
  * @note This value has to be at least two to fit the configuration and health models plus the number of
  * models needed by the application.
+ *
+ * The gateway adds the DFU Status client, which collects the transfer progress of the scanners.
  */
-#define ACCESS_MODEL_COUNT (2)
+#define ACCESS_MODEL_COUNT (3)
 
 /**
  * The number of elements in the application.
@@ -0,0 +1,163 @@
+/* Copyright (c) 2010 - 2018, Nordic Semiconductor ASA
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form, except as embedded into a Nordic
+ *    Semiconductor ASA integrated circuit in a product or a software update for
+ *    such product, must reproduce the above copyright notice, this list of
+ *    conditions and the following disclaimer in the documentation and/or other
+ *    materials provided with the distribution.
+ *
+ * 3. Neither the name of Nordic Semiconductor ASA nor the names of its
+ *    contributors may be used to endorse or promote products derived from this
+ *    software without specific prior written permission.
+ *
+ * 4. This software, with or without modification, must only be used with a
+ *    Nordic Semiconductor ASA integrated circuit.
+ *
+ * 5. Any software provided in binary form under this license must not be reverse
+ *    engineered, decompiled, modified and/or disassembled.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NORDIC SEMICONDUCTOR ASA "AS IS" AND ANY EXPRESS
+ * OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY, NONINFRINGEMENT, AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NORDIC SEMICONDUCTOR ASA OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+ * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "dfu_fleet.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/*****************************************************************************
+ * Static functions
+ *****************************************************************************/
+
+static bool node_is_transferring(const dfu_fleet_node_t * p_node)
+{
+    return (p_node->status.state == DFU_STATUS_STATE_TARGET || p_node->status.state == DFU_STATUS_STATE_RELAY);
+}
+
+static bool node_is_stalled(const dfu_fleet_node_t * p_node, uint32_t now)
+{
+    return node_is_transferring(p_node) && now - p_node->progress_timestamp >= DFU_FLEET_STALL_MS;
+}
+
+static dfu_fleet_node_t * node_find(dfu_fleet_t * p_fleet, uint16_t addr)
+{
+    for (uint32_t i = 0; i < p_fleet->count; i++)
+    {
+        if (p_fleet->nodes[i].addr == addr)
+        {
+            return &p_fleet->nodes[i];
+        }
+    }
+    return NULL;
+}
+
+/*****************************************************************************
+ * Public API
+ *****************************************************************************/
+
+void dfu_fleet_init(dfu_fleet_t * p_fleet)
+{
+    p_fleet->count = 0;
+    p_fleet->overflow_count = 0;
+}
+
+const dfu_fleet_node_t * dfu_fleet_update(dfu_fleet_t * p_fleet,
+                                          uint16_t addr,
+                                          const dfu_status_msg_status_t * p_status,
+                                          uint32_t now)
+{
+    dfu_fleet_node_t * p_node = node_find(p_fleet, addr);
+    if (p_node == NULL)
+    {
+        if (p_fleet->count == DFU_FLEET_NODES_MAX)
+        {
+            p_fleet->overflow_count++;
+            return NULL;
+        }
+        p_node = &p_fleet->nodes[p_fleet->count++];
+        p_node->addr = addr;
+        p_node->progress_timestamp = now;
+    }
+    else if (p_node->status.state != p_status->state ||
+             p_node->status.received_count != p_status->received_count)
+    {
+        p_node->progress_timestamp = now;
+    }
+
+    p_node->status = *p_status;
+    p_node->update_timestamp = now;
+    return p_node;
+}
+
+void dfu_fleet_node_record_get(const dfu_fleet_node_t * p_node, uint32_t now, dfu_fleet_node_record_t * p_record)
+{
+    uint32_t age_s = (now - p_node->update_timestamp) / 1000;
+
+    p_record->record = DFU_FLEET_RECORD_NODE;
+    p_record->addr = p_node->addr;
+    p_record->state = p_node->status.state;
+    p_record->end_reason = p_node->status.end_reason;
+    p_record->fw_version = p_node->status.fw_version;
+    p_record->segment_count = p_node->status.segment_count;
+    p_record->received_count = p_node->status.received_count;
+    p_record->relay_count = p_node->status.relay_count;
+    p_record->missing_count = p_node->status.missing_count;
+    p_record->first_missing = (p_node->status.missing_count > 0) ? p_node->status.missing[0].first : 0;
+    p_record->stalled = node_is_stalled(p_node, now) ? 1 : 0;
+    p_record->age_s = (age_s > UINT16_MAX) ? UINT16_MAX : (uint16_t) age_s;
+    p_record->policy_id = p_node->status.policy_id;
+    p_record->in_cohort = p_node->status.in_cohort;
+}
+
+void dfu_fleet_summary_get(const dfu_fleet_t * p_fleet, uint32_t now, dfu_fleet_summary_record_t * p_record)
+{
+    memset(p_record, 0, sizeof(*p_record));
+    p_record->record = DFU_FLEET_RECORD_SUMMARY;
+    p_record->node_count = (uint16_t) p_fleet->count;
+    p_record->overflow_count = (p_fleet->overflow_count > UINT16_MAX) ? UINT16_MAX : (uint16_t) p_fleet->overflow_count;
+
+    for (uint32_t i = 0; i < p_fleet->count; i++)
+    {
+        const dfu_fleet_node_t * p_node = &p_fleet->nodes[i];
+        switch (p_node->status.state)
+        {
+            case DFU_STATUS_STATE_TARGET:
+                p_record->receiving_count++;
+                break;
+            case DFU_STATUS_STATE_BANKED:
+            case DFU_STATUS_STATE_COMPLETE:
+                p_record->complete_count++;
+                break;
+            case DFU_STATUS_STATE_FAILED:
+                p_record->failed_count++;
+                break;
+            default:
+                break;
+        }
+        if (node_is_stalled(p_node, now))
+        {
+            p_record->stalled_count++;
+        }
+        if (p_node->status.in_cohort)
+        {
+            p_record->in_cohort_count++;
+        }
+    }
+    p_record->all_complete = (p_record->complete_count > 0 && p_record->receiving_count == 0) ? 1 : 0;
+}
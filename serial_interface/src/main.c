@@ -35,6 +35,9 @@
  * OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdint.h>
+#include <string.h>
+
 #include "nrf_delay.h"
 #include "nrf_mesh_dfu.h"
 #include "nrf_mesh_events.h"
@@ -49,6 +52,12 @@
 #include "nrf_mesh_config_examples.h"
 #include "mesh_opt_prov.h"
 #include "app_timer.h"
+#include "access_config.h"
+#include "timer.h"
+
+#include "app_config.h"
+#include "dfu_status_client.h"
+#include "dfu_fleet.h"
 
 #define LED_BLINK_INTERVAL_SHORT_MS (100)
 #define LED_BLINK_INTERVAL_MS       (200)
@@ -57,6 +66,18 @@
 #define STATIC_AUTH_DATA {0x6E, 0x6F, 0x72, 0x64, 0x69, 0x63, 0x5F, 0x65, 0x78, 0x61, 0x6D, 0x70, 0x6C, 0x65, 0x5F, 0x31}
 
 static bool m_device_provisioned;
+static dfu_status_client_t m_dfu_status_client;
+static dfu_fleet_t m_dfu_fleet;
+static uint32_t m_clock_ms;
+static timestamp_t m_clock_last_us;
+APP_TIMER_DEF(m_dfu_fleet_timer);
+/* The table is streamed a few rows per tick, as far as the serial TX queue takes them. */
+static bool m_dfu_fleet_streaming;
+/* Next row to stream, the summary follows the last row. */
+static uint32_t m_dfu_fleet_stream_cursor;
+static uint32_t m_dfu_fleet_stream_timestamp;
+/* Number of serial records that could not be sent. */
+static uint32_t m_serial_drop_count;
 
 
 #if defined(NRF51)
@@ -153,12 +174,174 @@ static void mesh_evt_handler(const nrf_mesh_evt_t* p_evt)
     }
 }
 
+/*************************************************************************************************/
+/* DFU fleet table */
+
+static uint32_t time_ms_get(void)
+{
+    timestamp_t now_us = timer_now();
+    uint32_t elapsed_ms = (now_us - m_clock_last_us) / 1000;
+    m_clock_ms += elapsed_ms;
+    m_clock_last_us += elapsed_ms * 1000;
+    return m_clock_ms;
+}
+
+static void serial_record_dropped(uint8_t record, uint32_t status)
+{
+    m_serial_drop_count++;
+    __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "Serial record 0x%02x dropped (%u), %u dropped since boot\n",
+          record, status, m_serial_drop_count);
+}
+
+static uint32_t dfu_fleet_summary_send(uint32_t now)
+{
+    dfu_fleet_summary_record_t summary;
+    dfu_fleet_summary_get(&m_dfu_fleet, now, &summary);
+    return nrf_mesh_serial_tx((uint8_t *) &summary, sizeof(summary));
+}
+
+static uint32_t dfu_fleet_node_send(const dfu_fleet_node_t * p_node, uint32_t now)
+{
+    dfu_fleet_node_record_t record;
+    dfu_fleet_node_record_get(p_node, now, &record);
+    return nrf_mesh_serial_tx((uint8_t *) &record, sizeof(record));
+}
+
+static void dfu_status_cb(const dfu_status_client_t * p_self, uint16_t src, const dfu_status_msg_status_t * p_status)
+{
+    uint32_t now = time_ms_get();
+    const dfu_fleet_node_t * p_node = dfu_fleet_update(&m_dfu_fleet, src, p_status, now);
+
+    /* A row or summary that does not make it out goes with the next stream of the table. */
+    uint32_t status;
+    if (p_node == NULL)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "DFU fleet table full, dropped status from 0x%04x\n", src);
+    }
+    else
+    {
+        status = dfu_fleet_node_send(p_node, now);
+        if (status != NRF_SUCCESS)
+        {
+            serial_record_dropped(DFU_FLEET_RECORD_NODE, status);
+        }
+    }
+    status = dfu_fleet_summary_send(now);
+    if (status != NRF_SUCCESS)
+    {
+        serial_record_dropped(DFU_FLEET_RECORD_SUMMARY, status);
+    }
+}
+
+/* Sends the rest of the table stream, until the serial TX queue is full. */
+static void dfu_fleet_stream_continue(uint32_t now)
+{
+    uint32_t status;
+    while (m_dfu_fleet_stream_cursor < m_dfu_fleet.count)
+    {
+        status = dfu_fleet_node_send(&m_dfu_fleet.nodes[m_dfu_fleet_stream_cursor], now);
+        if (status == NRF_ERROR_NO_MEM)
+        {
+            return;
+        }
+        if (status != NRF_SUCCESS)
+        {
+            serial_record_dropped(DFU_FLEET_RECORD_NODE, status);
+        }
+        m_dfu_fleet_stream_cursor++;
+    }
+
+    status = dfu_fleet_summary_send(now);
+    if (status == NRF_ERROR_NO_MEM)
+    {
+        return;
+    }
+    if (status != NRF_SUCCESS)
+    {
+        serial_record_dropped(DFU_FLEET_RECORD_SUMMARY, status);
+    }
+    m_dfu_fleet_streaming = false;
+}
+
+static void dfu_fleet_timer_handler(void * p_context)
+{
+    /* Re-stream the whole table, so the host can see stalled nodes and resync after a restart. */
+    uint32_t now = time_ms_get();
+    if (!m_dfu_fleet_streaming && m_dfu_fleet.count > 0 &&
+        now - m_dfu_fleet_stream_timestamp >= APP_CONFIG_DFU_FLEET_STREAM_INTERVAL_MS)
+    {
+        m_dfu_fleet_streaming = true;
+        m_dfu_fleet_stream_cursor = 0;
+        m_dfu_fleet_stream_timestamp = now;
+    }
+
+    if (m_dfu_fleet_streaming)
+    {
+        dfu_fleet_stream_continue(now);
+    }
+}
+
+static void dfu_policy_status_cb(const dfu_status_client_t * p_self,
+                                 uint16_t src,
+                                 const dfu_status_msg_policy_status_t * p_status)
+{
+    dfu_fleet_policy_record_t record =
+    {
+        .record = DFU_FLEET_RECORD_POLICY_STATUS,
+        .addr = src,
+        .policy_id = p_status->policy_id,
+        .in_cohort = p_status->in_cohort,
+        .cohort = p_status->cohort
+    };
+    uint32_t status = nrf_mesh_serial_tx((uint8_t *) &record, sizeof(record));
+    if (status != NRF_SUCCESS)
+    {
+        serial_record_dropped(DFU_FLEET_RECORD_POLICY_STATUS, status);
+    }
+}
+
+static void serial_app_rx_cb(const uint8_t * p_data, uint32_t length)
+{
+    if (length < 1 + DFU_STATUS_MSG_POLICY_SET_LENGTH_MIN || p_data[0] != DFU_FLEET_COMMAND_POLICY_SET)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "Unknown serial application command of length %u\n", length);
+        return;
+    }
+
+    dfu_status_msg_policy_set_t policy;
+    uint32_t policy_length = (length - 1 > sizeof(policy)) ? sizeof(policy) : length - 1;
+    memset(&policy, 0, sizeof(policy));
+    memcpy(&policy, &p_data[1], policy_length);
+    if (policy_length < DFU_STATUS_MSG_POLICY_SET_LENGTH_MIN + policy.blocked_count * sizeof(policy.blocked[0]))
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "DFU policy %u truncated\n", policy.policy_id);
+        return;
+    }
+
+    uint32_t status = dfu_status_client_policy_set(&m_dfu_status_client, &policy);
+    if (status != NRF_SUCCESS)
+    {
+        __LOG(LOG_SRC_APP, LOG_LEVEL_WARN, "DFU policy %u publish failed: %u\n", policy.policy_id, status);
+    }
+}
+
+static void models_init_cb(void)
+{
+    m_dfu_status_client.status_cb = dfu_status_cb;
+    m_dfu_status_client.policy_status_cb = dfu_policy_status_cb;
+    ERROR_CHECK(dfu_status_client_init(&m_dfu_status_client, 0));
+    access_model_subscription_list_alloc(m_dfu_status_client.model_handle);
+}
+
+/*************************************************************************************************/
+
 static void mesh_init(void)
 {
     mesh_stack_init_params_t init_params =
     {
-        .core.irq_priority = NRF_MESH_IRQ_PRIORITY_LOWEST,
-        .core.lfclksrc     = DEV_BOARD_LF_CLK_CFG
+        .core.irq_priority     = NRF_MESH_IRQ_PRIORITY_LOWEST,
+        .core.lfclksrc         = DEV_BOARD_LF_CLK_CFG,
+        .models.models_init_cb = models_init_cb
     };
     ERROR_CHECK(mesh_stack_init(&init_params, &m_device_provisioned));
 
@@ -166,7 +349,7 @@ static void mesh_init(void)
     ERROR_CHECK(mesh_opt_prov_ecdh_offloading_set(true));
 
     __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Initializing serial interface...\n");
-    ERROR_CHECK(nrf_mesh_serial_init(NULL));
+    ERROR_CHECK(nrf_mesh_serial_init(serial_app_rx_cb));
 
     m_evt_handler.evt_cb = mesh_evt_handler;
     nrf_mesh_evt_handler_add(&m_evt_handler);
@@ -184,6 +367,9 @@ static void initialize(void)
     ERROR_CHECK(app_timer_init());
     hal_leds_init();
 
+    dfu_fleet_init(&m_dfu_fleet);
+    ERROR_CHECK(app_timer_create(&m_dfu_fleet_timer, APP_TIMER_MODE_REPEATED, dfu_fleet_timer_handler));
+
     nrf_clock_lf_cfg_t lfc_cfg = DEV_BOARD_LF_CLK_CFG;
     ERROR_CHECK(mesh_softdevice_init(lfc_cfg));
     mesh_init();
@@ -207,6 +393,8 @@ static void start(void)
         ERROR_CHECK(mesh_provisionee_prov_start(&prov_start_params));
     }
     ERROR_CHECK(nrf_mesh_serial_enable());
+    m_clock_last_us = timer_now();
+    ERROR_CHECK(app_timer_start(m_dfu_fleet_timer, APP_TIMER_TICKS(APP_CONFIG_DFU_FLEET_STREAM_TICK_MS), NULL));
 
     __LOG(LOG_SRC_APP, LOG_LEVEL_INFO, "Bluetooth Mesh Serial Interface Application started!\n");
 }